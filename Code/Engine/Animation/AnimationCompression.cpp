@@ -0,0 +1,480 @@
+#include "Engine/Animation/AnimationCompression.hpp"
+#include "Engine/Animation/AnimationSequence.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// only the largest component of a unit quaternion can be above 1/sqrt(2), so the other three fit this range
+constexpr float k_smallestThreeRange = 0.70710678f;
+constexpr float k_smallestThreeSteps = 32767.f;
+constexpr float k_rangeQuantizedSteps = 65535.f;
+constexpr int k_maxCompressedFrameCount = 65536;
+
+float AnimationCompressionStats::GetCompressionRatio() const
+{
+	return m_compressedBytes > 0 ? (float)m_uncompressedBytes / (float)m_compressedBytes : 0.f;
+}
+
+std::string AnimationCompressionStats::ToString() const
+{
+	return Stringf( "%s: %d tracks, %d frames, kept %d of %d keys, %d constant and %d animated channels, %d -> %d bytes (%.1fx), max error translation %.5f rotation %.4f deg scale %.5f model space %.5f",
+		m_name.c_str(), m_trackCount, m_frameCount, m_keptKeyCount, m_sourceKeyCount, m_constantChannelCount, m_animatedChannelCount,
+		(int)m_uncompressedBytes, (int)m_compressedBytes, GetCompressionRatio(),
+		m_maxTranslationError, m_maxRotationErrorDegrees, m_maxScaleError, m_maxModelSpaceError );
+}
+
+void EncodeSmallestThreeQuat( Quat const& rotation, uint16_t* out_values )
+{
+	Quat normalized = rotation.GetNormalized();
+	float components[4] = { normalized.x, normalized.y, normalized.z, normalized.w };
+	int largest = 0;
+	for (int i = 1; i < 4; i++)
+	{
+		if (fabsf( components[i] ) > fabsf( components[largest] ))
+		{
+			largest = i;
+		}
+	}
+
+	// q and -q are the same rotation, flip so the dropped component is positive and can be rebuilt from the others
+	float sign = components[largest] < 0.f ? -1.f : 1.f;
+	int outIndex = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		if (i == largest)
+			continue;
+
+		float zeroToOne = ClampZeroToOne( components[i] * sign / k_smallestThreeRange * 0.5f + 0.5f );
+		out_values[outIndex++] = (uint16_t)(zeroToOne * k_smallestThreeSteps + 0.5f);
+	}
+
+	// the two spare top bits say which component was dropped
+	out_values[0] |= (uint16_t)((largest & 1) << 15);
+	out_values[1] |= (uint16_t)((largest >> 1) << 15);
+}
+
+Quat DecodeSmallestThreeQuat( uint16_t const* values )
+{
+	int largest = (values[0] >> 15) | ((values[1] >> 15) << 1);
+	float components[4] = {};
+	float sumOfSquares = 0.f;
+	int inIndex = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		if (i == largest)
+			continue;
+
+		float component = ((float)(values[inIndex++] & 0x7fff) / k_smallestThreeSteps * 2.f - 1.f) * k_smallestThreeRange;
+		components[i] = component;
+		sumOfSquares += component * component;
+	}
+	components[largest] = sqrtf( sumOfSquares < 1.f ? 1.f - sumOfSquares : 0.f );
+	return Quat( components[0], components[1], components[2], components[3] );
+}
+
+static uint16_t QuantizeToRange( float value, float rangeMin, float rangeExtent )
+{
+	if (rangeExtent <= 0.f)
+		return 0;
+
+	return (uint16_t)(ClampZeroToOne( (value - rangeMin) / rangeExtent ) * k_rangeQuantizedSteps + 0.5f);
+}
+
+static Vec3 DequantizeVec3( uint16_t const* values, CompressedChannel const& channel )
+{
+	return Vec3(
+		channel.m_rangeMin.x + (float)values[0] * (channel.m_rangeExtent.x / k_rangeQuantizedSteps),
+		channel.m_rangeMin.y + (float)values[1] * (channel.m_rangeExtent.y / k_rangeQuantizedSteps),
+		channel.m_rangeMin.z + (float)values[2] * (channel.m_rangeExtent.z / k_rangeQuantizedSteps) );
+}
+
+static Vec3 GetVec3Key( CompressedChannel const& channel, uint16_t const* keyValues, float const* fullPrecisionKeyValues, int key )
+{
+	if (channel.m_format == CompressedChannelFormat::FULL_PRECISION)
+	{
+		float const* values = fullPrecisionKeyValues + channel.m_firstValue + key * 3;
+		return Vec3( values[0], values[1], values[2] );
+	}
+	return DequantizeVec3( keyValues + channel.m_firstValue + key * 3, channel );
+}
+
+// From the chord between the two quaternions, acos of their dot product loses small angles to float precision
+static float GetRotationErrorDegrees( Quat const& rotationA, Quat const& rotationB )
+{
+	Quat chord = rotationA.DotProduct( rotationB ) < 0.f ? rotationA + rotationB : rotationA - rotationB;
+	float halfChord = chord.GetLength() * 0.5f;
+	return 4.f * ASinDegrees( halfChord < 1.f ? halfChord : 1.f );
+}
+
+static float GetTranslationError( Vec3 const& translationA, Vec3 const& translationB )
+{
+	return (translationA - translationB).GetLength();
+}
+
+static float GetScaleError( Vec3 const& scaleA, Vec3 const& scaleB )
+{
+	Vec3 difference = scaleA - scaleB;
+	float largest = fabsf( difference.x ) > fabsf( difference.y ) ? fabsf( difference.x ) : fabsf( difference.y );
+	return largest > fabsf( difference.z ) ? largest : fabsf( difference.z );
+}
+
+// Weights of the four keys around a span for a cubic Hermite curve through the middle two,
+// tangents are Catmull-Rom ones scaled for unevenly spaced keys so the curve stays smooth across reduced spans
+static void GetCurveWeights( float frame0, float frame1, float frame2, float frame3, float factor, float* out_weights )
+{
+	float tangentScale1 = (frame2 - frame1) / (frame2 - frame0);
+	float tangentScale2 = (frame2 - frame1) / (frame3 - frame1);
+	float factorSquared = factor * factor;
+	float factorCubed = factorSquared * factor;
+	float startWeight = 2.f * factorCubed - 3.f * factorSquared + 1.f;
+	float startTangentWeight = factorCubed - 2.f * factorSquared + factor;
+	float endWeight = -2.f * factorCubed + 3.f * factorSquared;
+	float endTangentWeight = factorCubed - factorSquared;
+	out_weights[0] = -startTangentWeight * tangentScale1;
+	out_weights[1] = startWeight - endTangentWeight * tangentScale2;
+	out_weights[2] = endWeight + startTangentWeight * tangentScale1;
+	out_weights[3] = endTangentWeight * tangentScale2;
+}
+
+// The four keys around span, the end keys repeat at either end of the channel
+template <typename Frame>
+static void GetCurveSpan( Frame const* keyFrames, int keyCount, int span, float frame, int* out_keys, float* out_weights )
+{
+	out_keys[0] = span > 0 ? span - 1 : span;
+	out_keys[1] = span;
+	out_keys[2] = span + 1;
+	out_keys[3] = span + 2 < keyCount ? span + 2 : span + 1;
+	float frame1 = (float)keyFrames[out_keys[1]];
+	float frame2 = (float)keyFrames[out_keys[2]];
+	GetCurveWeights( (float)keyFrames[out_keys[0]], frame1, frame2, (float)keyFrames[out_keys[3]], (frame - frame1) / (frame2 - frame1), out_weights );
+}
+
+static Vec3 EvaluateCurve( Vec3 const* values, float const* weights )
+{
+	return values[0] * weights[0] + values[1] * weights[1] + values[2] * weights[2] + values[3] * weights[3];
+}
+
+static Quat EvaluateCurve( Quat const* values, float const* weights )
+{
+	// every key on the same side as the one before it, or the blend takes the long way round
+	Quat aligned[4] = { values[0], values[1], values[2], values[3] };
+	if (aligned[0].DotProduct( aligned[1] ) < 0.f)
+		aligned[0] *= -1.f;
+	if (aligned[2].DotProduct( aligned[1] ) < 0.f)
+		aligned[2] *= -1.f;
+	if (aligned[3].DotProduct( aligned[2] ) < 0.f)
+		aligned[3] *= -1.f;
+	Quat result = aligned[0] * weights[0] + aligned[1] * weights[1] + aligned[2] * weights[2] + aligned[3] * weights[3];
+	return result.GetNormalized();
+}
+
+// Error at frameIndex of the curve through the kept dequantized keys around it
+template <typename Value, typename ErrorFunction>
+static float GetCurveError( std::vector<int> const& keptFrames, int span, int frameIndex, std::vector<Value> const& source, std::vector<Value> const& dequantized, ErrorFunction const& getError )
+{
+	int keys[4];
+	float weights[4];
+	GetCurveSpan( keptFrames.data(), (int)keptFrames.size(), span, (float)frameIndex, keys, weights );
+	Value values[4] = { dequantized[keptFrames[keys[0]]], dequantized[keptFrames[keys[1]]], dequantized[keptFrames[keys[2]]], dequantized[keptFrames[keys[3]]] };
+	return getError( EvaluateCurve( values, weights ), source[frameIndex] );
+}
+
+struct SpanError
+{
+	int m_worstFrame = -1;
+	float m_worstError = 0.f;
+};
+
+template <typename Value, typename ErrorFunction>
+static SpanError GetSpanError( std::vector<int> const& keptFrames, int span, std::vector<Value> const& source, std::vector<Value> const& dequantized, ErrorFunction const& getError )
+{
+	SpanError spanError;
+	for (int frameIndex = keptFrames[span] + 1; frameIndex < keptFrames[span + 1]; frameIndex++)
+	{
+		float error = GetCurveError( keptFrames, span, frameIndex, source, dequantized, getError );
+		if (error > spanError.m_worstError)
+		{
+			spanError.m_worstError = error;
+			spanError.m_worstFrame = frameIndex;
+		}
+	}
+	return spanError;
+}
+
+// Starts from the end frames and keeps adding the worst frame of the whole channel until every frame fits,
+// a new key only moves the curve of the two spans either side of it so only those are measured again
+template <typename Value, typename ErrorFunction>
+static std::vector<int> ReduceKeys( std::vector<Value> const& source, std::vector<Value> const& dequantized, float tolerance, ErrorFunction const& getError )
+{
+	int frameCount = (int)source.size();
+	std::vector<int> keptFrames;
+	keptFrames.push_back( 0 );
+	if (frameCount == 1)
+		return keptFrames;
+
+	keptFrames.push_back( frameCount - 1 );
+	std::vector<SpanError> spanErrors;
+	spanErrors.push_back( GetSpanError( keptFrames, 0, source, dequantized, getError ) );
+	for (;;)
+	{
+		int worstSpan = -1;
+		float worstError = tolerance;
+		for (int span = 0; span < (int)spanErrors.size(); span++)
+		{
+			if (spanErrors[span].m_worstError > worstError)
+			{
+				worstError = spanErrors[span].m_worstError;
+				worstSpan = span;
+			}
+		}
+		if (worstSpan < 0)
+			break;
+
+		keptFrames.insert( keptFrames.begin() + worstSpan + 1, spanErrors[worstSpan].m_worstFrame );
+		spanErrors.insert( spanErrors.begin() + worstSpan + 1, SpanError() );
+		int firstChanged = worstSpan > 0 ? worstSpan - 1 : 0;
+		int lastChanged = worstSpan + 2 < (int)spanErrors.size() ? worstSpan + 2 : (int)spanErrors.size() - 1;
+		for (int span = firstChanged; span <= lastChanged; span++)
+		{
+			spanErrors[span] = GetSpanError( keptFrames, span, source, dequantized, getError );
+		}
+	}
+	return keptFrames;
+}
+
+static void CompressVec3Channel( std::vector<Vec3> const& source, float tolerance, float (*getError)(Vec3 const&, Vec3 const&), CompressedChannel& out_channel, CompressedTrackSet& trackSet, AnimationCompressionStats& stats )
+{
+	int frameCount = (int)source.size();
+	out_channel.m_firstKey = (int)trackSet.m_keyFrames.size();
+
+	Vec3 rangeMin = source[0];
+	Vec3 rangeMax = source[0];
+	for (Vec3 const& value : source)
+	{
+		rangeMin = Vec3( value.x < rangeMin.x ? value.x : rangeMin.x, value.y < rangeMin.y ? value.y : rangeMin.y, value.z < rangeMin.z ? value.z : rangeMin.z );
+		rangeMax = Vec3( value.x > rangeMax.x ? value.x : rangeMax.x, value.y > rangeMax.y ? value.y : rangeMax.y, value.z > rangeMax.z ? value.z : rangeMax.z );
+	}
+
+	// the middle of the range is never further than half the extent from any frame
+	Vec3 middle = (rangeMin + rangeMax) * 0.5f;
+	if (getError( middle, rangeMax ) <= tolerance && getError( middle, rangeMin ) <= tolerance)
+	{
+		out_channel.m_keyCount = 1;
+		out_channel.m_firstValue = (int)trackSet.m_keyValues.size();
+		out_channel.m_rangeMin = middle;
+		out_channel.m_rangeExtent = Vec3( 0.f, 0.f, 0.f );
+		trackSet.m_keyFrames.push_back( 0 );
+		trackSet.m_keyValues.insert( trackSet.m_keyValues.end(), 3, (uint16_t)0 );
+		stats.m_constantChannelCount++;
+		stats.m_keptKeyCount++;
+		return;
+	}
+
+	out_channel.m_rangeMin = rangeMin;
+	out_channel.m_rangeExtent = rangeMax - rangeMin;
+	std::vector<uint16_t> quantized( frameCount * 3 );
+	std::vector<Vec3> dequantized( frameCount );
+	for (int frameIndex = 0; frameIndex < frameCount; frameIndex++)
+	{
+		uint16_t* values = &quantized[frameIndex * 3];
+		values[0] = QuantizeToRange( source[frameIndex].x, rangeMin.x, out_channel.m_rangeExtent.x );
+		values[1] = QuantizeToRange( source[frameIndex].y, rangeMin.y, out_channel.m_rangeExtent.y );
+		values[2] = QuantizeToRange( source[frameIndex].z, rangeMin.z, out_channel.m_rangeExtent.z );
+		dequantized[frameIndex] = DequantizeVec3( values, out_channel );
+	}
+
+	// ReduceKeys only measures the frames between kept keys, a kept key is off by its own rounding,
+	// up to half a step of extent / 65535 on each axis, which a wide range pushes past the tolerance
+	bool isQuantizable = true;
+	for (int frameIndex = 0; frameIndex < frameCount && isQuantizable; frameIndex++)
+	{
+		isQuantizable = getError( dequantized[frameIndex], source[frameIndex] ) <= tolerance;
+	}
+
+	if (!isQuantizable)
+	{
+		out_channel.m_format = CompressedChannelFormat::FULL_PRECISION;
+		out_channel.m_rangeMin = Vec3( 0.f, 0.f, 0.f );
+		out_channel.m_rangeExtent = Vec3( 0.f, 0.f, 0.f );
+		out_channel.m_firstValue = (int)trackSet.m_fullPrecisionKeyValues.size();
+		std::vector<int> keptFrames = ReduceKeys( source, source, tolerance, getError );
+		out_channel.m_keyCount = (int)keptFrames.size();
+		for (int frameIndex : keptFrames)
+		{
+			Vec3 const& value = source[frameIndex];
+			trackSet.m_keyFrames.push_back( (uint16_t)frameIndex );
+			trackSet.m_fullPrecisionKeyValues.insert( trackSet.m_fullPrecisionKeyValues.end(), { value.x, value.y, value.z } );
+		}
+		stats.m_animatedChannelCount++;
+		stats.m_keptKeyCount += out_channel.m_keyCount;
+		return;
+	}
+
+	std::vector<int> keptFrames = ReduceKeys( source, dequantized, tolerance, getError );
+
+	out_channel.m_keyCount = (int)keptFrames.size();
+	out_channel.m_firstValue = (int)trackSet.m_keyValues.size();
+	for (int frameIndex : keptFrames)
+	{
+		trackSet.m_keyFrames.push_back( (uint16_t)frameIndex );
+		trackSet.m_keyValues.insert( trackSet.m_keyValues.end(), &quantized[frameIndex * 3], &quantized[frameIndex * 3] + 3 );
+	}
+	stats.m_animatedChannelCount++;
+	stats.m_keptKeyCount += out_channel.m_keyCount;
+}
+
+static void CompressRotationChannel( std::vector<Quat> const& source, float toleranceDegrees, CompressedChannel& out_channel, CompressedTrackSet& trackSet, AnimationCompressionStats& stats )
+{
+	int frameCount = (int)source.size();
+	out_channel.m_firstKey = (int)trackSet.m_keyFrames.size();
+
+	std::vector<uint16_t> quantized( frameCount * 3 );
+	std::vector<Quat> dequantized( frameCount );
+	for (int frameIndex = 0; frameIndex < frameCount; frameIndex++)
+	{
+		EncodeSmallestThreeQuat( source[frameIndex], &quantized[frameIndex * 3] );
+		dequantized[frameIndex] = DecodeSmallestThreeQuat( &quantized[frameIndex * 3] );
+	}
+
+	bool isConstant = true;
+	for (int frameIndex = 1; frameIndex < frameCount && isConstant; frameIndex++)
+	{
+		isConstant = GetRotationErrorDegrees( dequantized[0], source[frameIndex] ) <= toleranceDegrees;
+	}
+
+	std::vector<int> keptFrames;
+	if (isConstant)
+	{
+		keptFrames.push_back( 0 );
+		stats.m_constantChannelCount++;
+	}
+	else
+	{
+		keptFrames = ReduceKeys( source, dequantized, toleranceDegrees, GetRotationErrorDegrees );
+		stats.m_animatedChannelCount++;
+	}
+
+	out_channel.m_keyCount = (int)keptFrames.size();
+	out_channel.m_firstValue = (int)trackSet.m_keyValues.size();
+	for (int frameIndex : keptFrames)
+	{
+		trackSet.m_keyFrames.push_back( (uint16_t)frameIndex );
+		trackSet.m_keyValues.insert( trackSet.m_keyValues.end(), &quantized[frameIndex * 3], &quantized[frameIndex * 3] + 3 );
+	}
+	stats.m_keptKeyCount += out_channel.m_keyCount;
+}
+
+void CompressedTrackSet::Compress( std::vector<JointTrack> const& tracks, AnimationCompressionConfig const& config, AnimationCompressionStats& out_stats )
+{
+	m_tracks.clear();
+	m_keyFrames.clear();
+	m_keyValues.clear();
+	m_fullPrecisionKeyValues.clear();
+	m_tracks.resize( tracks.size() );
+
+	out_stats.m_trackCount = (int)tracks.size();
+	for (int trackIndex = 0; trackIndex < (int)tracks.size(); trackIndex++)
+	{
+		JointTrack const& track = tracks[trackIndex];
+		CompressedJointTrack& compressedTrack = m_tracks[trackIndex];
+		int frameCount = track.GetFrameCount();
+		GUARANTEE_OR_DIE( frameCount <= k_maxCompressedFrameCount, Stringf( "Track %s has too many frames to compress", track.m_jointName.c_str() ) );
+
+		compressedTrack.m_frameCount = frameCount;
+		out_stats.m_frameCount = frameCount > out_stats.m_frameCount ? frameCount : out_stats.m_frameCount;
+		out_stats.m_sourceKeyCount += frameCount * 3;
+		out_stats.m_uncompressedBytes += (size_t)frameCount * (sizeof( Vec3 ) * 2 + sizeof( Quat ));
+		if (frameCount == 0)
+			continue;
+
+		CompressVec3Channel( track.m_translations, config.m_translationTolerance, GetTranslationError, compressedTrack.m_translation, *this, out_stats );
+		CompressRotationChannel( track.m_rotations, config.m_rotationToleranceDegrees, compressedTrack.m_rotation, *this, out_stats );
+		CompressVec3Channel( track.m_scales, config.m_scaleTolerance, GetScaleError, compressedTrack.m_scale, *this, out_stats );
+
+		for (int frameIndex = 0; frameIndex < frameCount; frameIndex++)
+		{
+			JointPose sourcePose = track.GetKey( frameIndex );
+			JointPose compressedPose = Sample( trackIndex, (float)frameIndex );
+			out_stats.m_maxTranslationError = fmaxf( out_stats.m_maxTranslationError, GetTranslationError( sourcePose.m_translation, compressedPose.m_translation ) );
+			out_stats.m_maxRotationErrorDegrees = fmaxf( out_stats.m_maxRotationErrorDegrees, GetRotationErrorDegrees( sourcePose.m_rotation, compressedPose.m_rotation ) );
+			out_stats.m_maxScaleError = fmaxf( out_stats.m_maxScaleError, GetScaleError( sourcePose.m_scale, compressedPose.m_scale ) );
+		}
+	}
+
+	m_keyFrames.shrink_to_fit();
+	m_keyValues.shrink_to_fit();
+	m_fullPrecisionKeyValues.shrink_to_fit();
+	out_stats.m_compressedBytes = GetByteSize();
+}
+
+// False when frame is on or outside the end keys, out_keys[1] is then the key to hold
+static bool GetChannelCurve( uint16_t const* keyFrames, int keyCount, float frame, int* out_keys, float* out_weights )
+{
+	if (keyCount == 1 || frame <= (float)keyFrames[0])
+	{
+		out_keys[1] = 0;
+		return false;
+	}
+
+	int nextKey = int( std::upper_bound( keyFrames, keyFrames + keyCount, frame ) - keyFrames );
+	if (nextKey >= keyCount)
+	{
+		out_keys[1] = keyCount - 1;
+		return false;
+	}
+
+	GetCurveSpan( keyFrames, keyCount, nextKey - 1, frame, out_keys, out_weights );
+	return true;
+}
+
+static Vec3 SampleVec3Channel( CompressedChannel const& channel, uint16_t const* keyFrames, uint16_t const* keyValues, float const* fullPrecisionKeyValues, float frame )
+{
+	int keys[4];
+	float weights[4];
+	if (!GetChannelCurve( keyFrames + channel.m_firstKey, channel.m_keyCount, frame, keys, weights ))
+		return GetVec3Key( channel, keyValues, fullPrecisionKeyValues, keys[1] );
+
+	Vec3 values[4];
+	for (int i = 0; i < 4; i++)
+	{
+		values[i] = GetVec3Key( channel, keyValues, fullPrecisionKeyValues, keys[i] );
+	}
+	return EvaluateCurve( values, weights );
+}
+
+static Quat SampleRotationChannel( CompressedChannel const& channel, uint16_t const* keyFrames, uint16_t const* keyValues, float frame )
+{
+	int keys[4];
+	float weights[4];
+	if (!GetChannelCurve( keyFrames + channel.m_firstKey, channel.m_keyCount, frame, keys, weights ))
+		return DecodeSmallestThreeQuat( keyValues + channel.m_firstValue + keys[1] * 3 );
+
+	Quat values[4];
+	for (int i = 0; i < 4; i++)
+	{
+		values[i] = DecodeSmallestThreeQuat( keyValues + channel.m_firstValue + keys[i] * 3 );
+	}
+	return EvaluateCurve( values, weights );
+}
+
+JointPose CompressedTrackSet::Sample( int trackIndex, float frame ) const
+{
+	CompressedJointTrack const& track = m_tracks[trackIndex];
+	JointPose pose;
+	if (track.m_frameCount == 0)
+		return pose;
+
+	pose.m_translation = SampleVec3Channel( track.m_translation, m_keyFrames.data(), m_keyValues.data(), m_fullPrecisionKeyValues.data(), frame );
+	pose.m_rotation = SampleRotationChannel( track.m_rotation, m_keyFrames.data(), m_keyValues.data(), frame );
+	pose.m_scale = SampleVec3Channel( track.m_scale, m_keyFrames.data(), m_keyValues.data(), m_fullPrecisionKeyValues.data(), frame );
+	return pose;
+}
+
+size_t CompressedTrackSet::GetByteSize() const
+{
+	return m_tracks.size() * sizeof( CompressedJointTrack ) + (m_keyFrames.size() + m_keyValues.size()) * sizeof( uint16_t )
+		+ m_fullPrecisionKeyValues.size() * sizeof( float );
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Engine/Math/Vec3.hpp"
+#include "Engine/Math/Quat.hpp"
+
+struct JointPose;
+struct JointTrack;
+
+// Largest error a dropped key may leave behind, measured in the joint's local space
+struct AnimationCompressionConfig
+{
+	float m_translationTolerance = 0.001f;
+	float m_rotationToleranceDegrees = 0.1f;
+	float m_scaleTolerance = 0.001f;
+};
+
+// What compressing one clip did, the errors are the worst over every joint and frame against the source keys
+struct AnimationCompressionStats
+{
+	std::string m_name;
+	int m_trackCount = 0;
+	int m_frameCount = 0;
+	int m_constantChannelCount = 0;
+	int m_animatedChannelCount = 0;
+	int m_sourceKeyCount = 0;
+	int m_keptKeyCount = 0;
+	size_t m_uncompressedBytes = 0;
+	size_t m_compressedBytes = 0;
+	float m_maxTranslationError = 0.f;
+	float m_maxRotationErrorDegrees = 0.f;
+	float m_maxScaleError = 0.f;
+	// joint positions after composing the whole skeleton, where local errors add up along each chain
+	float m_maxModelSpaceError = 0.f;
+
+	float GetCompressionRatio() const;
+	std::string ToString() const;
+};
+
+// A translation or scale range too wide for 16 bit steps to stay inside the tolerance keeps its keys as floats
+enum class CompressedChannelFormat : int
+{
+	QUANTIZED,
+	FULL_PRECISION
+};
+
+// One translation, rotation or scale curve, a constant channel keeps a single key
+// Between keys the value follows a cubic through the two keys either side, so smooth motion needs few of them
+// Translation and scale keys are quantized to 16 bits per component over the range of the channel,
+// rotations use the smallest three components at 15 bits each
+struct CompressedChannel
+{
+	int m_firstKey = 0;
+	int m_keyCount = 0;
+	int m_firstValue = 0;		// in m_keyValues, or m_fullPrecisionKeyValues for a full precision channel
+	CompressedChannelFormat m_format = CompressedChannelFormat::QUANTIZED;
+	Vec3 m_rangeMin = Vec3( 0.f, 0.f, 0.f );
+	Vec3 m_rangeExtent = Vec3( 0.f, 0.f, 0.f );
+};
+
+struct CompressedJointTrack
+{
+	int m_frameCount = 0;
+	CompressedChannel m_translation;
+	CompressedChannel m_rotation;
+	CompressedChannel m_scale;
+};
+
+// Every track of a sequence after compression, the keys of all channels share two arrays
+// Sampling reads these directly, nothing is expanded back to dense frames
+struct CompressedTrackSet
+{
+	std::vector<CompressedJointTrack> m_tracks;
+	std::vector<uint16_t> m_keyFrames;		// one per key
+	std::vector<uint16_t> m_keyValues;		// three per quantized key
+	std::vector<float> m_fullPrecisionKeyValues;		// three per full precision key
+
+	void Compress( std::vector<JointTrack> const& tracks, AnimationCompressionConfig const& config, AnimationCompressionStats& out_stats );
+	// frame is fractional, before the first key and after the last one the end keys are held
+	JointPose Sample( int trackIndex, float frame ) const;
+	int GetFrameCount( int trackIndex ) const { return m_tracks[trackIndex].m_frameCount; }
+	size_t GetByteSize() const;
+};
+
+void EncodeSmallestThreeQuat( Quat const& rotation, uint16_t* out_values );
+Quat DecodeSmallestThreeQuat( uint16_t const* values );
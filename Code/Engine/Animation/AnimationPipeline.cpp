@@ -0,0 +1,183 @@
+#include "Engine/Animation/AnimationPipeline.hpp"
+#include "Engine/Animation/AnimationSequence.hpp"
+#include "Engine/General/Character.hpp"
+#include "Engine/General/SkeletalMesh.hpp"
+#include "Engine/Core/ParallelFor.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+#include <cstring>
+
+void EvaluatePoseRequest( PoseRequest const& request, SkeletalPoseScratch& scratch )
+{
+	if (request.m_stateMachine)
+	{
+		request.m_skeletalMesh->EvaluatePose( *request.m_globalTransforms, scratch, request.m_stateMachine, request.m_baseLayerOnly );
+	}
+	else
+	{
+		request.m_skeletalMesh->EvaluatePose( *request.m_globalTransforms, scratch, request.m_currentTime, request.m_currentAnimation,
+			request.m_previousTime, request.m_previousAnimation, request.m_crossfadeAlpha );
+	}
+}
+
+AnimationPipeline::AnimationPipeline( AnimationPipelineConfig const& config )
+	: m_config( config )
+{
+}
+
+AnimationPipeline::~AnimationPipeline()
+{
+}
+
+void AnimationPipeline::UpdateCharacters( std::vector<Character*> const& characters, float deltaSeconds )
+{
+	for (Character* character : characters)
+	{
+		character->UpdateBeforePose( deltaSeconds );
+	}
+
+	m_requests.clear();
+	for (Character* character : characters)
+	{
+		PoseRequest request;
+		if (character->GetPoseRequest( request ))
+		{
+			m_requests.push_back( request );
+		}
+	}
+	EvaluatePoses( m_requests );
+
+	for (Character* character : characters)
+	{
+		character->UpdateAfterPose( deltaSeconds );
+	}
+}
+
+void AnimationPipeline::EvaluatePoses( std::vector<PoseRequest> const& requests )
+{
+	if (m_scratch.size() < requests.size())
+	{
+		m_scratch.resize( requests.size() );
+	}
+
+	// every request writes its own transforms with its own scratch, the meshes and clips are only read
+	ParallelFor( 0, (int)requests.size(), m_config.m_grainSize, [&]( int requestIndex )
+		{
+			EvaluatePoseRequest( requests[requestIndex], m_scratch[requestIndex] );
+		} );
+}
+
+void RunPoseEvaluationBenchmark( int characterCount, int jointCount )
+{
+	// a branching skeleton with every joint keyed, crossfading between two clips as characters mid-transition do
+	Skeleton skeleton;
+	skeleton.m_joints.resize( jointCount );
+	for (int jointIndex = 0; jointIndex < jointCount; jointIndex++)
+	{
+		Joint& joint = skeleton.m_joints[jointIndex];
+		joint.m_name = Stringf( "joint%d", jointIndex );
+		joint.m_parentIndex = jointIndex > 0 ? (jointIndex - 1) / 3 : -1;
+		if (joint.m_parentIndex >= 0)
+		{
+			skeleton.m_joints[joint.m_parentIndex].m_childrenIndexes.push_back( jointIndex );
+		}
+	}
+
+	int const frameCount = 60;
+	AnimationSequence clipA( "BenchmarkA", 30.f, 2.f );
+	AnimationSequence clipB( "BenchmarkB", 30.f, 2.f );
+	for (int jointIndex = 0; jointIndex < jointCount; jointIndex++)
+	{
+		JointTrack& trackA = clipA.AddTrack( skeleton.m_joints[jointIndex].m_name, frameCount );
+		JointTrack& trackB = clipB.AddTrack( skeleton.m_joints[jointIndex].m_name, frameCount );
+		for (int frameIndex = 0; frameIndex < frameCount; frameIndex++)
+		{
+			JointPose pose;
+			pose.m_translation = Vec3( 0.1f, 0.f, 0.f );
+			pose.m_rotation = Quat( Vec3( 0.f, 0.f, 1.f ), 30.f * SinDegrees( 6.f * (float)(frameIndex + jointIndex) ) );
+			trackA.SetKey( frameIndex, pose );
+			pose.m_rotation = Quat( Vec3( 0.f, 1.f, 0.f ), 20.f * CosDegrees( 6.f * (float)(frameIndex + jointIndex) ) );
+			trackB.SetKey( frameIndex, pose );
+		}
+	}
+
+	std::vector<MeshT*> meshes;
+	SkeletalMesh skeletalMesh( meshes, skeleton );
+	std::vector<std::vector<Mat44>> globalTransforms( characterCount );
+	std::vector<PoseRequest> requests( characterCount );
+	for (int characterIndex = 0; characterIndex < characterCount; characterIndex++)
+	{
+		PoseRequest& request = requests[characterIndex];
+		request.m_skeletalMesh = &skeletalMesh;
+		request.m_globalTransforms = &globalTransforms[characterIndex];
+		request.m_currentAnimation = &clipA;
+		request.m_currentTime = 0.013f * (float)characterIndex;
+		request.m_previousAnimation = &clipB;
+		request.m_previousTime = 0.029f * (float)characterIndex;
+		request.m_crossfadeAlpha = 0.5f;
+	}
+
+	// both runs start from warm buffers and bound clips, so only evaluation is timed
+	std::vector<SkeletalPoseScratch> serialScratch( characterCount );
+	for (int characterIndex = 0; characterIndex < characterCount; characterIndex++)
+	{
+		EvaluatePoseRequest( requests[characterIndex], serialScratch[characterIndex] );
+	}
+	AnimationPipeline pipeline;
+	pipeline.EvaluatePoses( requests );
+
+	double startTime = GetCurrentTimeSeconds();
+	for (int characterIndex = 0; characterIndex < characterCount; characterIndex++)
+	{
+		EvaluatePoseRequest( requests[characterIndex], serialScratch[characterIndex] );
+	}
+	double serialSeconds = GetCurrentTimeSeconds() - startTime;
+	// the parallel run has to write every pose again for the comparison below to mean anything
+	std::vector<std::vector<Mat44>> serialTransforms = globalTransforms;
+	float const zeroValues[16] = {};
+	for (std::vector<Mat44>& pose : globalTransforms)
+	{
+		pose.assign( pose.size(), Mat44( zeroValues ) );
+	}
+
+	startTime = GetCurrentTimeSeconds();
+	pipeline.EvaluatePoses( requests );
+	double parallelSeconds = GetCurrentTimeSeconds() - startTime;
+
+	// every character runs the same code on either side, so the poses must be identical to the bit
+	bool isMatching = true;
+	for (int characterIndex = 0; characterIndex < characterCount; characterIndex++)
+	{
+		std::vector<Mat44> const& serialPose = serialTransforms[characterIndex];
+		std::vector<Mat44> const& parallelPose = globalTransforms[characterIndex];
+		if (serialPose.size() != parallelPose.size() || memcmp( serialPose.data(), parallelPose.data(), serialPose.size() * sizeof( Mat44 ) ) != 0)
+		{
+			isMatching = false;
+			break;
+		}
+	}
+	ASSERT_RECOVERABLE( isMatching, "Parallel pose evaluation does not match the serial poses" );
+
+	int workerCount = g_jobSystem ? g_jobSystem->GetWorkerCount() : 0;
+	PrintBenchmarkLine( Stringf( "Pose evaluation benchmark: %d characters, %d joints, %d workers", characterCount, jointCount, workerCount ) );
+	PrintBenchmarkLine( Stringf( "serial %8.3fms  parallel %8.3fms  x%.2f  %s",
+		serialSeconds * 1000.0, parallelSeconds * 1000.0, parallelSeconds > 0.0 ? serialSeconds / parallelSeconds : 0.0,
+		isMatching ? "match" : "MISMATCH" ) );
+}
+
+bool Command_PoseEvaluationBenchmark()
+{
+	RunPoseEvaluationBenchmark( 200, 65 );
+	return false;
+}
+
+void AnimationPipelineStartup()
+{
+	if (g_eventSystem != nullptr)
+	{
+		g_eventSystem->SubscribeEventCallBackFunc( "PoseEvaluationBenchmark", &Command_PoseEvaluationBenchmark );
+	}
+}
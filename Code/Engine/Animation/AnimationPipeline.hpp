@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+
+#include "Engine/Math/Mat44.hpp"
+
+class Character;
+class SkeletalMesh;
+class AnimationSequence;
+class AnimationStateMachine;
+struct SkeletalPoseScratch;
+
+// One skeleton to pose, gathered from a character once its gameplay update has moved the animation clocks
+// Without a state machine the crossfade described by the request itself is sampled
+struct PoseRequest
+{
+	SkeletalMesh* m_skeletalMesh = nullptr;
+	std::vector<Mat44>* m_globalTransforms = nullptr;
+	AnimationStateMachine* m_stateMachine = nullptr;
+	// characters without a controller only play the base layer's crossfade
+	bool m_baseLayerOnly = false;
+
+	AnimationSequence* m_currentAnimation = nullptr;
+	float m_currentTime = 0.f;
+	AnimationSequence* m_previousAnimation = nullptr;
+	float m_previousTime = 0.f;
+	float m_crossfadeAlpha = 0.f;
+};
+
+void EvaluatePoseRequest( PoseRequest const& request, SkeletalPoseScratch& scratch );
+
+struct AnimationPipelineConfig
+{
+	// characters per job, one character is a few hundred joints of sampling and composing
+	int m_grainSize = 2;
+};
+
+// Updates a crowd of characters in three stages instead of one character at a time:
+// controllers, animation state and root motion on the calling thread, then every pose on JobSystem workers,
+// then foot IK, collision and physics on the calling thread against the finished poses
+// Characters are driven through their stages rather than Update, subclasses that add to Update are not run here
+class AnimationPipeline
+{
+public:
+	explicit AnimationPipeline( AnimationPipelineConfig const& config = AnimationPipelineConfig() );
+	~AnimationPipeline();
+
+	void UpdateCharacters( std::vector<Character*> const& characters, float deltaSeconds );
+	// The parallel stage on its own, for callers that gather their requests themselves
+	void EvaluatePoses( std::vector<PoseRequest> const& requests );
+
+private:
+	AnimationPipelineConfig m_config;
+	std::vector<PoseRequest> m_requests;
+	// one per request slot and only ever grown, so a steady crowd stops allocating after its first frame
+	std::vector<SkeletalPoseScratch> m_scratch;
+};
+
+// Times serial against parallel pose evaluation for a crowd sharing one synthetic skeleton and clip
+void RunPoseEvaluationBenchmark( int characterCount, int jointCount );
+bool Command_PoseEvaluationBenchmark();
+// Registers the benchmark command, call from app startup once the event system exists
+void AnimationPipelineStartup();
@@ -1,16 +1,260 @@
 #include "Engine/Animation/AnimationSequence.hpp"
+#include "Engine/Animation/AnimationCompression.hpp"
 #include "Engine/Core/XmlUtils.hpp"
+#include "Engine/Core/FileUtil.hpp"
+#include "Engine/Binary/BinaryUtil.hpp"
 #include "Engine/Model/ModelUtility.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 
-KeyFrame* AnimationSequence::GetKeyFrameHeadOfJoint( const std::string& jointName )
+constexpr unsigned int k_animationSequenceMagic = 0x4D4E4145; // "EANM"
+constexpr unsigned int k_animationSequenceVersion = 1;
+constexpr size_t k_animationArrayAlignment = 16;
+
+// the arrays are copied byte for byte, these layouts are part of the file format
+static_assert(sizeof( Vec3 ) == 12, "Vec3 keys are stored as three packed floats");
+static_assert(sizeof( Quat ) == 16, "Quat keys are stored as four packed floats");
+static_assert(sizeof( CompressedJointTrack ) == 124, "compressed track headers are stored packed");
+
+JointPose::JointPose( Mat44 const& transform )
+{
+	m_translation = transform.GetTranslation3D();
+	m_scale = transform.GetScale3D();
+	Mat44 rotationOnly;
+	rotationOnly.SetIJKT3D(
+		m_scale.x > 0.f ? transform.GetIBasis3D() / m_scale.x : Vec3( 1.f, 0.f, 0.f ),
+		m_scale.y > 0.f ? transform.GetJBasis3D() / m_scale.y : Vec3( 0.f, 1.f, 0.f ),
+		m_scale.z > 0.f ? transform.GetKBasis3D() / m_scale.z : Vec3( 0.f, 0.f, 1.f ),
+		Vec3( 0.f, 0.f, 0.f ) );
+	m_rotation = Quat( rotationOnly ).GetNormalized();
+}
+
+Mat44 JointPose::ToMatrix() const
+{
+	return Mat44( m_translation, m_rotation, m_scale );
+}
+
+JointPose JointPose::Interpolate( JointPose const& poseA, JointPose const& poseB, float factor )
+{
+	JointPose result;
+	result.m_translation = poseA.m_translation * (1.f - factor) + poseB.m_translation * factor;
+	result.m_rotation = Quat::SLERP( poseA.m_rotation, poseB.m_rotation, factor );
+	result.m_scale = poseA.m_scale * (1.f - factor) + poseB.m_scale * factor;
+	return result;
+}
+
+void JointTrack::Resize( int frameCount )
+{
+	m_translations.resize( frameCount, Vec3( 0.f, 0.f, 0.f ) );
+	m_rotations.resize( frameCount, Quat::IDENTITY );
+	m_scales.resize( frameCount, Vec3( 1.f, 1.f, 1.f ) );
+}
+
+void JointTrack::SetKey( int frameIndex, JointPose const& pose )
+{
+	m_translations[frameIndex] = pose.m_translation;
+	m_rotations[frameIndex] = pose.m_rotation;
+	m_scales[frameIndex] = pose.m_scale;
+}
+
+JointPose JointTrack::GetKey( int frameIndex ) const
+{
+	JointPose pose;
+	pose.m_translation = m_translations[frameIndex];
+	pose.m_rotation = m_rotations[frameIndex];
+	pose.m_scale = m_scales[frameIndex];
+	return pose;
+}
+
+AnimationSequence::AnimationSequence( std::string name, float frameRate, float duration, float playBackSpeed, bool looping )
+	: m_name( name )
+	, m_frameRate( frameRate )
+	, m_duration( duration )
+	, m_playbackSpeed( playBackSpeed )
+	, m_looping( looping )
+{
+}
+
+AnimationSequence::~AnimationSequence()
+{
+}
+
+JointTrack& AnimationSequence::AddTrack( std::string const& jointName, int frameCount )
+{
+	auto found = m_trackIndexByJointName.find( jointName );
+	if (found != m_trackIndexByJointName.end())
+	{
+		m_tracks[found->second].Resize( frameCount );
+		return m_tracks[found->second];
+	}
+
+	m_trackIndexByJointName[jointName] = (int)m_tracks.size();
+	m_tracks.emplace_back();
+	m_tracks.back().m_jointName = jointName;
+	m_tracks.back().Resize( frameCount );
+	return m_tracks.back();
+}
+
+int AnimationSequence::GetTrackIndex( std::string const& jointName ) const
+{
+	auto found = m_trackIndexByJointName.find( jointName );
+	return found != m_trackIndexByJointName.end() ? found->second : -1;
+}
+
+std::vector<int> const& AnimationSequence::GetJointTrackIndices( Skeleton const& skeleton )
+{
+	for (SkeletonBinding const* binding = m_firstSkeletonBinding.load( std::memory_order_acquire ); binding; binding = binding->m_next)
+	{
+		if (binding->m_skeleton == &skeleton && binding->m_jointCount == skeleton.m_joints.size())
+			return binding->m_trackIndices;
+	}
+
+	std::lock_guard<std::mutex> lock( m_skeletonBindingMutex );
+	// another thread may have bound the skeleton since the walk above
+	for (SkeletonBinding const* binding = m_firstSkeletonBinding.load( std::memory_order_relaxed ); binding; binding = binding->m_next)
+	{
+		if (binding->m_skeleton == &skeleton && binding->m_jointCount == skeleton.m_joints.size())
+			return binding->m_trackIndices;
+	}
+
+	std::unique_ptr<SkeletonBinding> binding = std::make_unique<SkeletonBinding>();
+	binding->m_skeleton = &skeleton;
+	binding->m_jointCount = skeleton.m_joints.size();
+	binding->m_trackIndices.reserve( skeleton.m_joints.size() );
+	for (Joint const& joint : skeleton.m_joints)
+	{
+		binding->m_trackIndices.push_back( GetTrackIndex( joint.m_name ) );
+	}
+	// nothing has sampled the tracks before the first binding is handed out, so they can still be rewritten here
+	if (m_trackSpace == JointTrackSpace::MODEL)
+	{
+		ConvertTracksToLocalSpace( skeleton, binding->m_trackIndices );
+	}
+	// published only once its tracks are converted, the release pairs with the acquire of the lock free walk
+	binding->m_next = m_firstSkeletonBinding.load( std::memory_order_relaxed );
+	m_firstSkeletonBinding.store( binding.get(), std::memory_order_release );
+	m_skeletonBindings.push_back( std::move( binding ) );
+	return m_skeletonBindings.back()->m_trackIndices;
+}
+
+void AnimationSequence::ConvertTracksToLocalSpace( Skeleton const& skeleton, std::vector<int> const& trackIndices )
 {
-	auto iter = m_keyFrames.find( jointName );
-	if (iter != m_keyFrames.end())
+	std::vector<Joint> const& joints = skeleton.m_joints;
+	int frameCount = 0;
+	for (JointTrack const& track : m_tracks)
 	{
-		return iter->second;
+		frameCount = track.GetFrameCount() > frameCount ? track.GetFrameCount() : frameCount;
+	}
+
+	// a joint without a track gets an identity local pose when sampled, so it sits on its parent here as well
+	std::vector<Mat44> modelTransforms( joints.size() );
+	for (int frameIndex = 0; frameIndex < frameCount; frameIndex++)
+	{
+		for (int jointIndex = 0; jointIndex < (int)joints.size(); jointIndex++)
+		{
+			int trackIndex = trackIndices[jointIndex];
+			int parentIndex = joints[jointIndex].m_parentIndex;
+			if (trackIndex < 0)
+			{
+				modelTransforms[jointIndex] = parentIndex >= 0 ? modelTransforms[parentIndex] : Mat44();
+				continue;
+			}
+			JointTrack const& track = m_tracks[trackIndex];
+			int keyIndex = frameIndex < track.GetFrameCount() ? frameIndex : track.GetFrameCount() - 1;
+			modelTransforms[jointIndex] = track.GetKey( keyIndex ).ToMatrix();
+		}
+
+		for (int jointIndex = 0; jointIndex < (int)joints.size(); jointIndex++)
+		{
+			int trackIndex = trackIndices[jointIndex];
+			int parentIndex = joints[jointIndex].m_parentIndex;
+			if (trackIndex < 0 || parentIndex < 0 || frameIndex >= m_tracks[trackIndex].GetFrameCount())
+				continue;
+
+			m_tracks[trackIndex].SetKey( frameIndex, JointPose( modelTransforms[parentIndex].GetInverse() * modelTransforms[jointIndex] ) );
+		}
 	}
-	return nullptr;
+	m_trackSpace = JointTrackSpace::LOCAL;
+}
+
+JointPose AnimationSequence::SampleTrack( int trackIndex, float time ) const
+{
+	if (m_compressedTracks)
+		return m_compressedTracks->Sample( trackIndex, time * m_frameRate );
+
+	JointTrack const& track = m_tracks[trackIndex];
+	int frameCount = track.GetFrameCount();
+	if (frameCount == 0)
+		return JointPose();
+
+	float frame = time * m_frameRate;
+	if (frame <= 0.f)
+		return track.GetKey( 0 );
+	int frameIndex = (int)frame;
+	if (frameIndex >= frameCount - 1)
+		return track.GetKey( frameCount - 1 );
+
+	// neighbouring keys are close together, nlerp is as good as slerp there and much cheaper
+	float factor = frame - (float)frameIndex;
+	JointPose pose;
+	pose.m_translation = track.m_translations[frameIndex] * (1.f - factor) + track.m_translations[frameIndex + 1] * factor;
+	pose.m_rotation = Quat::NLERP( track.m_rotations[frameIndex], track.m_rotations[frameIndex + 1], factor );
+	pose.m_scale = track.m_scales[frameIndex] * (1.f - factor) + track.m_scales[frameIndex + 1] * factor;
+	return pose;
+}
+
+int AnimationSequence::GetTrackFrameCount( int trackIndex ) const
+{
+	return m_compressedTracks ? m_compressedTracks->GetFrameCount( trackIndex ) : m_tracks[trackIndex].GetFrameCount();
+}
+
+AnimationCompressionStats AnimationSequence::Compress( Skeleton const& skeleton, AnimationCompressionConfig const& config )
+{
+	AnimationCompressionStats stats;
+	stats.m_name = m_name;
+	if (m_compressedTracks)
+	{
+		ERROR_RECOVERABLE( Stringf( "Animation sequence %s is already compressed", m_name.c_str() ) );
+		return stats;
+	}
+
+	std::vector<int> const& trackIndices = GetJointTrackIndices( skeleton );
+	std::unique_ptr<CompressedTrackSet> compressedTracks = std::make_unique<CompressedTrackSet>();
+	compressedTracks->Compress( m_tracks, config, stats );
+
+	// joints without a track sit on their parent, as they do when the mesh composes its pose
+	std::vector<Joint> const& joints = skeleton.m_joints;
+	std::vector<Mat44> sourceTransforms( joints.size() );
+	std::vector<Mat44> compressedTransforms( joints.size() );
+	for (int frameIndex = 0; frameIndex < stats.m_frameCount; frameIndex++)
+	{
+		for (int jointIndex = 0; jointIndex < (int)joints.size(); jointIndex++)
+		{
+			int trackIndex = trackIndices[jointIndex];
+			Mat44 sourceLocal;
+			Mat44 compressedLocal;
+			if (trackIndex >= 0 && m_tracks[trackIndex].GetFrameCount() > 0)
+			{
+				int keyIndex = frameIndex < m_tracks[trackIndex].GetFrameCount() ? frameIndex : m_tracks[trackIndex].GetFrameCount() - 1;
+				sourceLocal = m_tracks[trackIndex].GetKey( keyIndex ).ToMatrix();
+				compressedLocal = compressedTracks->Sample( trackIndex, (float)frameIndex ).ToMatrix();
+			}
+
+			int parentIndex = joints[jointIndex].m_parentIndex;
+			sourceTransforms[jointIndex] = parentIndex >= 0 ? sourceTransforms[parentIndex] * sourceLocal : sourceLocal;
+			compressedTransforms[jointIndex] = parentIndex >= 0 ? compressedTransforms[parentIndex] * compressedLocal : compressedLocal;
+			float error = (sourceTransforms[jointIndex].GetTranslation3D() - compressedTransforms[jointIndex].GetTranslation3D()).GetLength();
+			stats.m_maxModelSpaceError = error > stats.m_maxModelSpaceError ? error : stats.m_maxModelSpaceError;
+		}
+	}
+
+	for (JointTrack& track : m_tracks)
+	{
+		std::vector<Vec3>().swap( track.m_translations );
+		std::vector<Quat>().swap( track.m_rotations );
+		std::vector<Vec3>().swap( track.m_scales );
+	}
+	m_compressedTracks = std::move( compressedTracks );
+	return stats;
 }
 
 Vec3 AnimationSequence::GetRootTranslationAtTime( float currentTime, float deltaSeconds )
@@ -87,24 +331,27 @@ void AnimationSequence::ExportToXML( const std::string& filePath ) const
 	root->SetAttribute( "Duration", m_duration );
 	root->SetAttribute( "PlaybackSpeed", m_playbackSpeed );
 	root->SetAttribute( "Looping", m_looping );
+	if (m_trackSpace == JointTrackSpace::LOCAL)
+	{
+		root->SetAttribute( "Space", "Local" );
+	}
 	doc.InsertFirstChild( root );
 
-	for (const auto& [jointName, keyFrame] : m_keyFrames)
+	for (int trackIndex = 0; trackIndex < (int)m_tracks.size(); trackIndex++)
 	{
+		JointTrack const& track = m_tracks[trackIndex];
 		XmlElement* jointElement = doc.NewElement( "Joint" );
-		jointElement->SetAttribute( "Name", jointName.c_str() );
+		jointElement->SetAttribute( "Name", track.m_jointName.c_str() );
 		root->InsertEndChild( jointElement );
 
-		KeyFrame* currentFrame = keyFrame;
-		while (currentFrame) 
+		for (int frameIndex = 0; frameIndex < GetTrackFrameCount( trackIndex ); frameIndex++)
 		{
 			XmlElement* keyFrameElement = doc.NewElement( "KeyFrame" );
-			keyFrameElement->SetAttribute( "FrameNumber", currentFrame->m_frameNum );
+			keyFrameElement->SetAttribute( "FrameNumber", frameIndex );
 
-			keyFrameElement->SetAttribute( "Transform", currentFrame->m_globalTransform.ToString().c_str() );
+			JointPose key = m_compressedTracks ? m_compressedTracks->Sample( trackIndex, (float)frameIndex ) : track.GetKey( frameIndex );
+			keyFrameElement->SetAttribute( "Transform", key.ToMatrix().ToString().c_str() );
 			jointElement->InsertEndChild( keyFrameElement );
-
-			currentFrame = currentFrame->m_next;
 		}
 	}
 
@@ -151,6 +398,9 @@ AnimationSequence* AnimationSequence::ImportFromXML( const std::string& filePath
 	bool looping = root->BoolAttribute( "Looping" );
 
 	AnimationSequence* sequence = new AnimationSequence( name, frameRate, duration, playbackSpeed, looping );
+	// files written before tracks were kept in local space have no Space attribute and hold model space keys
+	bool isLocalSpace = ParseXmlAttribute( *root, "Space", std::string( "Model" ) ) == "Local";
+	sequence->SetTrackSpace( isLocalSpace ? JointTrackSpace::LOCAL : JointTrackSpace::MODEL );
 
 	if (root->FirstChildElement( "Joint" ))
 	{
@@ -158,37 +408,53 @@ AnimationSequence* AnimationSequence::ImportFromXML( const std::string& filePath
 		{
 			std::string jointName = jointElement->Attribute( "Name" );
 
-			KeyFrame* head = nullptr;
-			KeyFrame* prev = nullptr;
-
+			std::vector<int> frameNumbers;
+			std::vector<JointPose> keys;
 			for (XmlElement* keyFrameElement = jointElement->FirstChildElement( "KeyFrame" ); keyFrameElement != nullptr; keyFrameElement = keyFrameElement->NextSiblingElement( "KeyFrame" ))
 			{
-				int64_t frameNum = keyFrameElement->Int64Attribute( "FrameNumber" );
+				int frameNum = (int)keyFrameElement->Int64Attribute( "FrameNumber" );
 
-				Mat44 globalTransform;
-				globalTransform.FromString( keyFrameElement->Attribute( "Transform" ) );
+				Mat44 transform;
+				transform.FromString( keyFrameElement->Attribute( "Transform" ) );
 
-				KeyFrame* newFrame = new KeyFrame();
-				newFrame->m_frameNum = frameNum;
-				static const Mat44 XRotation90 = Mat44::CreateXRotationDegrees( 90.f );
-				static const Mat44 ZRotation90 = Mat44::CreateZRotationDegrees( 90.f );
-				globalTransform = XRotation90 * globalTransform;
-				globalTransform = ZRotation90 * globalTransform;
-				newFrame->m_globalTransform = globalTransform;
-				
+				if (!isLocalSpace)
+				{
+					static const Mat44 XRotation90 = Mat44::CreateXRotationDegrees( 90.f );
+					static const Mat44 ZRotation90 = Mat44::CreateZRotationDegrees( 90.f );
+					transform = XRotation90 * transform;
+					transform = ZRotation90 * transform;
+				}
 
-				if (prev)
+				frameNumbers.push_back( frameNum );
+				keys.push_back( JointPose( transform ) );
+			}
+			if (keys.empty())
+				continue;
+
+			// files may skip frames, every frame up to the last key gets the pose between its neighbouring keys
+			JointTrack& track = sequence->AddTrack( jointName, (frameNumbers.back() > 0 ? frameNumbers.back() : 0) + 1 );
+			int nextKey = 0;
+			for (int frameIndex = 0; frameIndex < track.GetFrameCount(); frameIndex++)
+			{
+				while (nextKey < (int)keys.size() && frameNumbers[nextKey] <= frameIndex)
+				{
+					nextKey++;
+				}
+				if (nextKey == 0)
+				{
+					track.SetKey( frameIndex, keys.front() );
+				}
+				else if (nextKey == (int)keys.size())
 				{
-					prev->m_next = newFrame;
+					track.SetKey( frameIndex, keys.back() );
 				}
 				else
 				{
-					head = newFrame;
+					int previousKey = nextKey - 1;
+					float factor = float( frameIndex - frameNumbers[previousKey] ) / float( frameNumbers[nextKey] - frameNumbers[previousKey] );
+					track.SetKey( frameIndex, JointPose::Interpolate( keys[previousKey], keys[nextKey], factor ) );
 				}
-
-				prev = newFrame;
 			}
-			sequence->m_keyFrames[jointName] = head;
 		}
 	}
 
@@ -236,3 +502,258 @@ AnimationSequence* AnimationSequence::ImportFromXML( const std::string& filePath
 
 	return sequence;
 }
+
+bool AnimationSequence::ExportToBinary( std::string const& filePath ) const
+{
+	std::vector<unsigned char> buffer;
+	WriteToBuffer( buffer );
+	return FileWriteToBuffer_S( buffer, filePath );
+}
+
+void AnimationSequence::WriteToBuffer( std::vector<unsigned char>& out_buffer ) const
+{
+	BufferWriter writer;
+	writer.SetEndianMode( Endianness::LITTLE );
+	writer.AppendUInt( k_animationSequenceMagic );
+	writer.AppendUInt( k_animationSequenceVersion );
+	writer.AppendStringAfter32BitLength( m_name );
+	writer.AppendFloat( m_frameRate );
+	writer.AppendFloat( m_duration );
+	writer.AppendFloat( m_playbackSpeed );
+	writer.AppendBool( m_looping );
+	writer.AppendByte( (unsigned char)m_trackSpace );
+	writer.AppendBool( m_compressedTracks != nullptr );
+
+	writer.AppendUInt( (unsigned int)m_tracks.size() );
+	for (int trackIndex = 0; trackIndex < (int)m_tracks.size(); trackIndex++)
+	{
+		writer.AppendStringAfter32BitLength( m_tracks[trackIndex].m_jointName );
+		writer.AppendUInt( (unsigned int)GetTrackFrameCount( trackIndex ) );
+	}
+	if (m_compressedTracks)
+	{
+		writer.AppendUInt( (unsigned int)m_compressedTracks->m_keyFrames.size() );
+		writer.AppendUInt( (unsigned int)m_compressedTracks->m_keyValues.size() );
+		writer.AppendUInt( (unsigned int)m_compressedTracks->m_fullPrecisionKeyValues.size() );
+	}
+	writer.AppendUInt( (unsigned int)m_rootTranslation.size() );
+	writer.AppendUInt( (unsigned int)m_rootRotation.size() );
+
+	writer.AppendUInt( (unsigned int)m_events.size() );
+	for (AnimationEvent const& animEvent : m_events)
+	{
+		writer.AppendStringAfter32BitLength( animEvent.name );
+		writer.AppendFloat( animEvent.time );
+		writer.AppendInt( animEvent.collisionIndex );
+		writer.AppendBool( animEvent.flag );
+		writer.AppendBool( animEvent.persisting );
+		writer.AppendUInt( (unsigned int)animEvent.damageTypeIndex.size() );
+		for (size_t damageIndex = 0; damageIndex < animEvent.damageTypeIndex.size(); damageIndex++)
+		{
+			writer.AppendInt( animEvent.damageTypeIndex[damageIndex] );
+			writer.AppendFloat( damageIndex < animEvent.damageValue.size() ? animEvent.damageValue[damageIndex] : 0.f );
+		}
+	}
+
+	// every array starts on an aligned offset, a track's keys follow the previous track's with no gap
+	if (m_compressedTracks)
+	{
+		writer.AppendPaddingToAlignment( k_animationArrayAlignment );
+		writer.AppendBytes( m_compressedTracks->m_tracks.data(), sizeof( CompressedJointTrack ) * m_compressedTracks->m_tracks.size() );
+		writer.AppendPaddingToAlignment( k_animationArrayAlignment );
+		writer.AppendBytes( m_compressedTracks->m_keyFrames.data(), sizeof( uint16_t ) * m_compressedTracks->m_keyFrames.size() );
+		writer.AppendPaddingToAlignment( k_animationArrayAlignment );
+		writer.AppendBytes( m_compressedTracks->m_keyValues.data(), sizeof( uint16_t ) * m_compressedTracks->m_keyValues.size() );
+		writer.AppendPaddingToAlignment( k_animationArrayAlignment );
+		writer.AppendBytes( m_compressedTracks->m_fullPrecisionKeyValues.data(), sizeof( float ) * m_compressedTracks->m_fullPrecisionKeyValues.size() );
+	}
+	else
+	{
+		writer.AppendPaddingToAlignment( k_animationArrayAlignment );
+		for (JointTrack const& track : m_tracks)
+		{
+			writer.AppendBytes( track.m_translations.data(), sizeof( Vec3 ) * track.m_translations.size() );
+		}
+		writer.AppendPaddingToAlignment( k_animationArrayAlignment );
+		for (JointTrack const& track : m_tracks)
+		{
+			writer.AppendBytes( track.m_rotations.data(), sizeof( Quat ) * track.m_rotations.size() );
+		}
+		writer.AppendPaddingToAlignment( k_animationArrayAlignment );
+		for (JointTrack const& track : m_tracks)
+		{
+			writer.AppendBytes( track.m_scales.data(), sizeof( Vec3 ) * track.m_scales.size() );
+		}
+	}
+	writer.AppendPaddingToAlignment( k_animationArrayAlignment );
+	writer.AppendBytes( m_rootTranslation.data(), sizeof( Vec3 ) * m_rootTranslation.size() );
+	writer.AppendPaddingToAlignment( k_animationArrayAlignment );
+	writer.AppendBytes( m_rootRotation.data(), sizeof( Vec3 ) * m_rootRotation.size() );
+
+	out_buffer.swap( writer.m_buffer );
+}
+
+AnimationSequence* AnimationSequence::ImportFromBinary( std::string const& filePath )
+{
+	std::vector<unsigned char> buffer;
+	if (!FileReadToBuffer( buffer, filePath ))
+		return nullptr;
+	return CreateFromBuffer( buffer );
+}
+
+AnimationSequence* AnimationSequence::CreateFromBuffer( std::vector<unsigned char>& buffer )
+{
+	BufferParser parser( buffer );
+	parser.SetEndianMode( Endianness::LITTLE );
+	if (parser.GetRemainingByteCount() < 12 || parser.ParseUInt() != k_animationSequenceMagic || parser.ParseUInt() != k_animationSequenceVersion)
+		return nullptr;
+
+	std::string name = parser.ParseStringAfter32BitLength();
+	if (parser.GetRemainingByteCount() < 19)
+		return nullptr;
+	float frameRate = parser.ParseFloat();
+	float duration = parser.ParseFloat();
+	float playbackSpeed = parser.ParseFloat();
+	bool looping = parser.ParseByte() != 0;
+	unsigned char trackSpace = parser.ParseByte();
+	bool isCompressed = parser.ParseByte() != 0;
+	size_t trackCount = parser.ParseUInt();
+	// each track needs at least its name length and frame count, which bounds the count before anything is allocated
+	if (trackSpace > (unsigned char)JointTrackSpace::MODEL || trackCount > parser.GetRemainingByteCount() / 8)
+		return nullptr;
+
+	std::unique_ptr<AnimationSequence> sequence = std::make_unique<AnimationSequence>( name, frameRate, duration, playbackSpeed, looping );
+	sequence->m_trackSpace = (JointTrackSpace)trackSpace;
+	std::vector<int> frameCounts( trackCount );
+	size_t denseKeyCount = 0;
+	for (size_t trackIndex = 0; trackIndex < trackCount; trackIndex++)
+	{
+		std::string jointName = parser.ParseStringAfter32BitLength();
+		if (parser.GetRemainingByteCount() < 4)
+			return nullptr;
+		frameCounts[trackIndex] = (int)parser.ParseUInt();
+		if (frameCounts[trackIndex] < 0)
+			return nullptr;
+		denseKeyCount += frameCounts[trackIndex];
+		sequence->AddTrack( jointName, 0 );
+	}
+	// a repeated joint name would fold two tracks into one
+	if (sequence->m_tracks.size() != trackCount || parser.GetRemainingByteCount() < (isCompressed ? 24 : 12))
+		return nullptr;
+
+	size_t compressedKeyCount = isCompressed ? parser.ParseUInt() : 0;
+	size_t quantizedValueCount = isCompressed ? parser.ParseUInt() : 0;
+	size_t fullPrecisionValueCount = isCompressed ? parser.ParseUInt() : 0;
+	size_t rootTranslationCount = parser.ParseUInt();
+	size_t rootRotationCount = parser.ParseUInt();
+	size_t eventCount = parser.ParseUInt();
+	if (rootTranslationCount > parser.GetRemainingByteCount() / sizeof( Vec3 ) || rootRotationCount > parser.GetRemainingByteCount() / sizeof( Vec3 )
+		|| eventCount > parser.GetRemainingByteCount() / 18)
+		return nullptr;
+
+	sequence->m_events.resize( eventCount );
+	for (AnimationEvent& animEvent : sequence->m_events)
+	{
+		animEvent.name = parser.ParseStringAfter32BitLength();
+		if (parser.GetRemainingByteCount() < 14)
+			return nullptr;
+		animEvent.time = parser.ParseFloat();
+		animEvent.collisionIndex = parser.ParseInt();
+		animEvent.flag = parser.ParseByte() != 0;
+		animEvent.persisting = parser.ParseByte() != 0;
+		size_t damageCount = parser.ParseUInt();
+		if (damageCount > parser.GetRemainingByteCount() / 8)
+			return nullptr;
+		animEvent.damageTypeIndex.resize( damageCount );
+		animEvent.damageValue.resize( damageCount );
+		for (size_t damageIndex = 0; damageIndex < damageCount; damageIndex++)
+		{
+			animEvent.damageTypeIndex[damageIndex] = parser.ParseInt();
+			animEvent.damageValue[damageIndex] = parser.ParseFloat();
+		}
+	}
+
+	if (isCompressed)
+	{
+		std::unique_ptr<CompressedTrackSet> compressedTracks = std::make_unique<CompressedTrackSet>();
+		compressedTracks->m_tracks.resize( trackCount );
+		if (!parser.SkipToAlignedArray( k_animationArrayAlignment, sizeof( CompressedJointTrack ) * trackCount ))
+			return nullptr;
+		parser.ParseBytes( compressedTracks->m_tracks.data(), sizeof( CompressedJointTrack ) * trackCount );
+		if (compressedKeyCount > parser.GetRemainingByteCount() / sizeof( uint16_t ) || quantizedValueCount > parser.GetRemainingByteCount() / sizeof( uint16_t )
+			|| fullPrecisionValueCount > parser.GetRemainingByteCount() / sizeof( float ))
+			return nullptr;
+		compressedTracks->m_keyFrames.resize( compressedKeyCount );
+		compressedTracks->m_keyValues.resize( quantizedValueCount );
+		compressedTracks->m_fullPrecisionKeyValues.resize( fullPrecisionValueCount );
+		if (!parser.SkipToAlignedArray( k_animationArrayAlignment, sizeof( uint16_t ) * compressedKeyCount ))
+			return nullptr;
+		parser.ParseBytes( compressedTracks->m_keyFrames.data(), sizeof( uint16_t ) * compressedKeyCount );
+		if (!parser.SkipToAlignedArray( k_animationArrayAlignment, sizeof( uint16_t ) * quantizedValueCount ))
+			return nullptr;
+		parser.ParseBytes( compressedTracks->m_keyValues.data(), sizeof( uint16_t ) * quantizedValueCount );
+		if (!parser.SkipToAlignedArray( k_animationArrayAlignment, sizeof( float ) * fullPrecisionValueCount ))
+			return nullptr;
+		parser.ParseBytes( compressedTracks->m_fullPrecisionKeyValues.data(), sizeof( float ) * fullPrecisionValueCount );
+
+		// sampling trusts the channel headers, so each one has to stay inside the shared key arrays
+		for (size_t trackIndex = 0; trackIndex < trackCount; trackIndex++)
+		{
+			CompressedJointTrack const& track = compressedTracks->m_tracks[trackIndex];
+			if (track.m_frameCount != frameCounts[trackIndex])
+				return nullptr;
+			if (track.m_frameCount == 0)
+				continue;
+			for (CompressedChannel const* channel : { &track.m_translation, &track.m_rotation, &track.m_scale })
+			{
+				if (channel->m_firstKey < 0 || channel->m_keyCount <= 0 || (size_t)channel->m_firstKey + (size_t)channel->m_keyCount > compressedKeyCount)
+					return nullptr;
+				// only translation and scale have a float fallback, rotations are always quantized
+				bool isFullPrecision = channel->m_format == CompressedChannelFormat::FULL_PRECISION;
+				if ((channel->m_format != CompressedChannelFormat::QUANTIZED && !isFullPrecision) || (isFullPrecision && channel == &track.m_rotation))
+					return nullptr;
+				size_t valueCount = isFullPrecision ? fullPrecisionValueCount : quantizedValueCount;
+				if (channel->m_firstValue < 0 || (size_t)channel->m_firstValue + 3 * (size_t)channel->m_keyCount > valueCount)
+					return nullptr;
+			}
+		}
+		sequence->m_compressedTracks = std::move( compressedTracks );
+	}
+	else
+	{
+		if (denseKeyCount > parser.GetRemainingByteCount() / (2 * sizeof( Vec3 ) + sizeof( Quat )))
+			return nullptr;
+		for (size_t trackIndex = 0; trackIndex < trackCount; trackIndex++)
+		{
+			sequence->m_tracks[trackIndex].Resize( frameCounts[trackIndex] );
+		}
+		if (!parser.SkipToAlignedArray( k_animationArrayAlignment, sizeof( Vec3 ) * denseKeyCount ))
+			return nullptr;
+		for (JointTrack& track : sequence->m_tracks)
+		{
+			parser.ParseBytes( track.m_translations.data(), sizeof( Vec3 ) * track.m_translations.size() );
+		}
+		if (!parser.SkipToAlignedArray( k_animationArrayAlignment, sizeof( Quat ) * denseKeyCount ))
+			return nullptr;
+		for (JointTrack& track : sequence->m_tracks)
+		{
+			parser.ParseBytes( track.m_rotations.data(), sizeof( Quat ) * track.m_rotations.size() );
+		}
+		if (!parser.SkipToAlignedArray( k_animationArrayAlignment, sizeof( Vec3 ) * denseKeyCount ))
+			return nullptr;
+		for (JointTrack& track : sequence->m_tracks)
+		{
+			parser.ParseBytes( track.m_scales.data(), sizeof( Vec3 ) * track.m_scales.size() );
+		}
+	}
+
+	sequence->m_rootTranslation.resize( rootTranslationCount );
+	sequence->m_rootRotation.resize( rootRotationCount );
+	if (!parser.SkipToAlignedArray( k_animationArrayAlignment, sizeof( Vec3 ) * rootTranslationCount ))
+		return nullptr;
+	parser.ParseBytes( sequence->m_rootTranslation.data(), sizeof( Vec3 ) * rootTranslationCount );
+	if (!parser.SkipToAlignedArray( k_animationArrayAlignment, sizeof( Vec3 ) * rootRotationCount ))
+		return nullptr;
+	parser.ParseBytes( sequence->m_rootRotation.data(), sizeof( Vec3 ) * rootRotationCount );
+	return sequence.release();
+}
@@ -2,13 +2,58 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
 #include <unordered_map>
 
 #include "Engine/Math/Vec3.hpp"
 #include "Engine/Math/EulerAngles.hpp"
 #include "Engine/Math/Quat.hpp"
 
-struct KeyFrame;
+struct Skeleton;
+struct CompressedTrackSet;
+struct AnimationCompressionConfig;
+struct AnimationCompressionStats;
+
+// One joint's transform split into the parts that interpolate independently
+struct JointPose
+{
+	Vec3 m_translation = Vec3( 0.f, 0.f, 0.f );
+	Quat m_rotation = Quat::IDENTITY;
+	Vec3 m_scale = Vec3( 1.f, 1.f, 1.f );
+
+	JointPose() = default;
+	explicit JointPose( Mat44 const& transform );
+	Mat44 ToMatrix() const;
+	// Slerps rotation, for blends between clips where the two rotations can be far apart
+	static JointPose Interpolate( JointPose const& poseA, JointPose const& poseB, float factor );
+};
+
+// Tracks are sampled and blended in LOCAL space, relative to the parent joint
+// Importers that can only evaluate whole-skeleton transforms store MODEL space keys,
+// those are moved to LOCAL space against the first skeleton the sequence is bound to
+enum class JointTrackSpace
+{
+	LOCAL,
+	MODEL
+};
+
+// One joint's keys as parallel arrays with an entry for every frame from frame 0,
+// so sampling goes straight from a time to its two frames whatever the clip length
+struct JointTrack
+{
+	std::string m_jointName;
+	std::vector<Vec3> m_translations;
+	std::vector<Quat> m_rotations;
+	std::vector<Vec3> m_scales;
+
+	int GetFrameCount() const { return (int)m_translations.size(); }
+	void Resize( int frameCount );
+	void SetKey( int frameIndex, JointPose const& pose );
+	JointPose GetKey( int frameIndex ) const;
+};
 
 struct AnimationEvent
 {
@@ -24,17 +69,32 @@ struct AnimationEvent
 class AnimationSequence
 {
 public:
-	AnimationSequence( std::string name, float frameRate, float duration, float playBackSpeed = true, bool looping = true )
-		: m_name( name )
-		, m_frameRate( frameRate )
-		, m_duration( duration )
-		, m_playbackSpeed( playBackSpeed )
-		, m_looping( looping )
-	{}
+	AnimationSequence( std::string name, float frameRate, float duration, float playBackSpeed = true, bool looping = true );
+	~AnimationSequence();
+
+	// Returns the existing track when the joint already has one, resized to frameCount
+	// Tracks are added while loading, a sequence that has been sampled keeps its bindings as they were
+	JointTrack& AddTrack( std::string const& jointName, int frameCount );
+	// -1 when the sequence has no keys for the joint
+	int GetTrackIndex( std::string const& jointName ) const;
+	int GetTrackCount() const { return (int)m_tracks.size(); }
+	JointTrack const& GetTrack( int trackIndex ) const { return m_tracks[trackIndex]; }
+	JointTrack& GetTrack( int trackIndex ) { return m_tracks[trackIndex]; }
+	void SetTrackSpace( JointTrackSpace space ) { m_trackSpace = space; }
+	JointTrackSpace GetTrackSpace() const { return m_trackSpace; }
+	// Track index for every joint of the skeleton, -1 where the sequence has no keys
+	// Resolved by name once per skeleton, safe to call from several threads and lock free once bound
+	// The skeleton must list parents before their children
+	std::vector<int> const& GetJointTrackIndices( Skeleton const& skeleton );
+	// Local pose of the track's joint, dense tracks nlerp neighbouring frames and compressed ones follow their curves
+	JointPose SampleTrack( int trackIndex, float time ) const;
+	int GetTrackFrameCount( int trackIndex ) const;
 
-	~AnimationSequence() = default;
+	// Offline step, run before the sequence is shared with anything that samples it
+	// Binds to the skeleton to get local space keys, then replaces the dense tracks with reduced, quantized ones
+	AnimationCompressionStats Compress( Skeleton const& skeleton, AnimationCompressionConfig const& config );
+	bool IsCompressed() const { return m_compressedTracks != nullptr; }
 
-	KeyFrame* GetKeyFrameHeadOfJoint( const std::string& jointName );
 	Vec3 GetRootTranslationAtTime( float currentTime, float deltaSeconds );
 	Quat GetRootRotationAtTime( float currentTime, float deltaSeconds );
 	std::vector<AnimationEvent> const& GetEvents() const;
@@ -42,6 +102,13 @@ public:
 
 	void ExportToXML( const std::string& filePath ) const;
 	static AnimationSequence* ImportFromXML( const std::string& filePath );
+	// Versioned binary form for shipping, compressed sequences stay compressed
+	// Key and root motion arrays are stored in their in-memory layout on aligned offsets and copied in whole
+	bool ExportToBinary( std::string const& filePath ) const;
+	void WriteToBuffer( std::vector<unsigned char>& out_buffer ) const;
+	// nullptr when the data is from another version, truncated or inconsistent
+	static AnimationSequence* ImportFromBinary( std::string const& filePath );
+	static AnimationSequence* CreateFromBuffer( std::vector<unsigned char>& buffer );
 
 public:
 	std::string m_name;
@@ -49,8 +116,29 @@ public:
 	float m_duration = 0.f;
 	float m_playbackSpeed = 1.f;
 	bool m_looping = true;
-	std::unordered_map<std::string, KeyFrame*> m_keyFrames;
 	std::vector<Vec3> m_rootTranslation;
 	std::vector<Vec3> m_rootRotation;
 	std::vector<AnimationEvent> m_events;
+
+private:
+	struct SkeletonBinding
+	{
+		Skeleton const* m_skeleton = nullptr;
+		size_t m_jointCount = 0;
+		std::vector<int> m_trackIndices;
+		SkeletonBinding const* m_next = nullptr;
+	};
+
+	void ConvertTracksToLocalSpace( Skeleton const& skeleton, std::vector<int> const& trackIndices );
+
+	std::vector<JointTrack> m_tracks;
+	// once compressed the tracks above only keep their joint names
+	std::unique_ptr<CompressedTrackSet> m_compressedTracks;
+	JointTrackSpace m_trackSpace = JointTrackSpace::LOCAL;
+	std::unordered_map<std::string, int> m_trackIndexByJointName;
+	// bindings are never moved once made, so the index vectors handed out stay valid
+	std::vector<std::unique_ptr<SkeletonBinding>> m_skeletonBindings;
+	// the same bindings as a list that is only ever pushed to, readers walk it without the mutex
+	std::atomic<SkeletonBinding const*> m_firstSkeletonBinding = nullptr;
+	std::mutex m_skeletonBindingMutex;
 };
@@ -129,7 +129,7 @@ void BufferWriter::AppendStringZeroTerminated( std::string const& value )
 
 void BufferWriter::AppendStringAfter32BitLength( std::string const& value )
 {
-	AppendUInt32( (unsigned long int)value.length() );
+	AppendUInt( (unsigned int)value.length() );
 	for (int i = 0; i < value.length(); i++)
 		AppendChar( value[i] );
 }
@@ -177,6 +177,21 @@ void BufferWriter::AppendVertexPCU( Vertex_PCU const& value )
 	AppendVec2( value.m_uvTexCoords );
 }
 
+void BufferWriter::AppendBytes( void const* data, size_t byteCount )
+{
+	unsigned char const* bytes = static_cast<unsigned char const*>(data);
+	m_buffer.insert( m_buffer.end(), bytes, bytes + byteCount );
+}
+
+void BufferWriter::AppendPaddingToAlignment( size_t alignment )
+{
+	size_t remainder = m_buffer.size() % alignment;
+	if (remainder != 0)
+	{
+		m_buffer.insert( m_buffer.end(), alignment - remainder, (unsigned char)0 );
+	}
+}
+
 void BufferWriter::SetEndianMode( Endianness mode )
 {
 	m_endianness = mode;
@@ -193,6 +208,7 @@ void BufferWriter::ReverseByte( unsigned char* startPos, unsigned long int lengt
 BufferParser::BufferParser( std::vector<unsigned char>& buffer )
 {
 	m_bufferStart = buffer.data();
+	m_bufferSize = buffer.size();
 	m_currentPos = 0;
 }
 
@@ -359,13 +375,15 @@ std::string BufferParser::ParseStringZeroTerminated()
 
 std::string BufferParser::ParseStringAfter32BitLength()
 {
-	unsigned long int length = ParseUInt32();
-	if (m_endianness != m_nativeEndianness)
+	// a length running past the end gives an empty string and leaves nothing to parse, so the caller's size checks fail
+	size_t length = GetRemainingByteCount() >= 4 ? ParseUInt() : ~(size_t)0;
+	if (length > GetRemainingByteCount())
 	{
-		ReverseByte( m_bufferStart + m_currentPos, length );
+		m_currentPos = (unsigned long int)m_bufferSize;
+		return std::string();
 	}
-	const char* value;
-	std::memcpy( &value, m_bufferStart + m_currentPos, length );
+	std::string value( reinterpret_cast<char const*>(m_bufferStart + m_currentPos), length );
+	m_currentPos += (unsigned long int)length;
 	return value;
 }
 
@@ -417,6 +435,32 @@ Vertex_PCU BufferParser::ParseVertexPCU()
 	return Vertex_PCU( Vec3( a, b, c ), rgba, vec2 );
 }
 
+bool BufferParser::ParseBytes( void* out_data, size_t byteCount )
+{
+	if (byteCount == 0)
+		return true;
+	if (byteCount > GetRemainingByteCount())
+		return false;
+	std::memcpy( out_data, m_bufferStart + m_currentPos, byteCount );
+	m_currentPos += (unsigned long int)byteCount;
+	return true;
+}
+
+void BufferParser::SkipPaddingToAlignment( size_t alignment )
+{
+	size_t remainder = m_currentPos % alignment;
+	if (remainder != 0)
+	{
+		m_currentPos += (unsigned long int)(alignment - remainder);
+	}
+}
+
+bool BufferParser::SkipToAlignedArray( size_t alignment, size_t byteCount )
+{
+	SkipPaddingToAlignment( alignment );
+	return GetRemainingByteCount() >= byteCount;
+}
+
 void BufferParser::SetEndianMode( Endianness mode )
 {
 	m_endianness = mode;
@@ -42,6 +42,10 @@ public:
 	void AppendVec2( Vec2 const& value );
 	void AppendAABB2( AABB2 const& value );
 	void AppendVertexPCU( Vertex_PCU const& value );
+	// Copied as they are in memory, for arrays of plain structs the file stores in native little endian layout
+	void AppendBytes( void const* data, size_t byteCount );
+	// Zero bytes up to the next multiple of alignment from the start of the buffer
+	void AppendPaddingToAlignment( size_t alignment );
 
 	void SetEndianMode( Endianness mode );
 	void ReverseByte( unsigned char* startPos, unsigned long int length );
@@ -77,6 +81,14 @@ public:
 	Vec2 ParseVec2();
 	AABB2 ParseAABB2();
 	Vertex_PCU ParseVertexPCU();
+	// false and nothing read when fewer than byteCount bytes are left
+	bool ParseBytes( void* out_data, size_t byteCount );
+	void SkipPaddingToAlignment( size_t alignment );
+	// Skips the padding before an aligned array, false when the byteCount bytes of the array are not all there
+	bool SkipToAlignedArray( size_t alignment, size_t byteCount );
+	// Where the next parse reads, so callers can check a whole array fits before reading it
+	size_t GetCurrentPosition() const { return m_currentPos; }
+	size_t GetRemainingByteCount() const { return m_currentPos < m_bufferSize ? m_bufferSize - m_currentPos : 0; }
 
 	void SetEndianMode( Endianness mode );
 	void ReverseByte( unsigned char* startPos, unsigned long int length );
@@ -88,6 +100,7 @@ private:
 	Endianness m_endianness = Endianness::NONE;
 	Endianness const m_nativeEndianness = Endianness::LITTLE;
 	unsigned char* m_bufferStart = nullptr;
+	size_t m_bufferSize = 0;
 	unsigned long int m_currentPos = 0;
 };
 bool LoadBinaryFileToExistingBuffer( std::string const& filePath, std::vector<unsigned char>& buffer );
@@ -0,0 +1,379 @@
+#include "Engine/Core/BlockCompression.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+constexpr int k_texelsPerBlock = 16;
+
+int GetBlockCompressionBlockSize( BlockCompressionFormat format )
+{
+	switch (format)
+	{
+	case BlockCompressionFormat::BC1:
+		return 8;
+	case BlockCompressionFormat::BC3:
+	case BlockCompressionFormat::BC5:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+size_t GetBlockCompressedRowPitch( int width, BlockCompressionFormat format )
+{
+	size_t blocksWide = width > 0 ? ((size_t)width + 3) / 4 : 0;
+	return blocksWide * GetBlockCompressionBlockSize( format );
+}
+
+size_t GetBlockCompressedSize( IntVec2 const& dimensions, BlockCompressionFormat format )
+{
+	size_t blocksHigh = dimensions.y > 0 ? ((size_t)dimensions.y + 3) / 4 : 0;
+	return GetBlockCompressedRowPitch( dimensions.x, format ) * blocksHigh;
+}
+
+static unsigned short PackColor565( float const* rgb )
+{
+	int red = ClampInt( (int)(rgb[0] * (31.f / 255.f) + 0.5f), 0, 31 );
+	int green = ClampInt( (int)(rgb[1] * (63.f / 255.f) + 0.5f), 0, 63 );
+	int blue = ClampInt( (int)(rgb[2] * (31.f / 255.f) + 0.5f), 0, 31 );
+	return (unsigned short)((red << 11) | (green << 5) | blue);
+}
+
+static void UnpackColor565( unsigned short color, int* outRgb )
+{
+	int red = (color >> 11) & 31;
+	int green = (color >> 5) & 63;
+	int blue = color & 31;
+	outRgb[0] = (red << 3) | (red >> 2);
+	outRgb[1] = (green << 2) | (green >> 4);
+	outRgb[2] = (blue << 3) | (blue >> 2);
+}
+
+// Nearest of the four colours the endpoints decode to for every texel, returns the summed squared error
+static int SelectColorIndices( Rgba8 const* texels, unsigned short color0, unsigned short color1, unsigned char* outIndices )
+{
+	int palette[4][3];
+	UnpackColor565( color0, palette[0] );
+	UnpackColor565( color1, palette[1] );
+	for (int channel = 0; channel < 3; channel++)
+	{
+		palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+		palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+	}
+
+	int totalError = 0;
+	for (int i = 0; i < k_texelsPerBlock; i++)
+	{
+		int bestError = 0x7fffffff;
+		for (int paletteIndex = 0; paletteIndex < 4; paletteIndex++)
+		{
+			int deltaR = texels[i].r - palette[paletteIndex][0];
+			int deltaG = texels[i].g - palette[paletteIndex][1];
+			int deltaB = texels[i].b - palette[paletteIndex][2];
+			int error = deltaR * deltaR + deltaG * deltaG + deltaB * deltaB;
+			if (error < bestError)
+			{
+				bestError = error;
+				outIndices[i] = (unsigned char)paletteIndex;
+			}
+		}
+		totalError += bestError;
+	}
+	return totalError;
+}
+
+// The two texels furthest apart along the principal axis of the block's colours
+static void FindColorEndpoints( Rgba8 const* texels, float* outEndpoint0, float* outEndpoint1 )
+{
+	float mean[3] = {};
+	float minColor[3] = { 255.f, 255.f, 255.f };
+	float maxColor[3] = {};
+	for (int i = 0; i < k_texelsPerBlock; i++)
+	{
+		float color[3] = { (float)texels[i].r, (float)texels[i].g, (float)texels[i].b };
+		for (int channel = 0; channel < 3; channel++)
+		{
+			mean[channel] += color[channel];
+			minColor[channel] = color[channel] < minColor[channel] ? color[channel] : minColor[channel];
+			maxColor[channel] = color[channel] > maxColor[channel] ? color[channel] : maxColor[channel];
+		}
+	}
+	for (int channel = 0; channel < 3; channel++)
+	{
+		mean[channel] /= (float)k_texelsPerBlock;
+	}
+
+	// rr, rg, rb, gg, gb, bb
+	float covariance[6] = {};
+	for (int i = 0; i < k_texelsPerBlock; i++)
+	{
+		float r = (float)texels[i].r - mean[0];
+		float g = (float)texels[i].g - mean[1];
+		float b = (float)texels[i].b - mean[2];
+		covariance[0] += r * r;
+		covariance[1] += r * g;
+		covariance[2] += r * b;
+		covariance[3] += g * g;
+		covariance[4] += g * b;
+		covariance[5] += b * b;
+	}
+
+	// power iteration from the bounding box diagonal, which is never orthogonal to a strong axis
+	float axis[3] = { maxColor[0] - minColor[0], maxColor[1] - minColor[1], maxColor[2] - minColor[2] };
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[3] =
+		{
+			covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+			covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+			covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2],
+		};
+		float largest = fabsf( next[0] );
+		largest = fabsf( next[1] ) > largest ? fabsf( next[1] ) : largest;
+		largest = fabsf( next[2] ) > largest ? fabsf( next[2] ) : largest;
+		if (largest < 1e-6f)
+			break;
+		for (int channel = 0; channel < 3; channel++)
+		{
+			axis[channel] = next[channel] / largest;
+		}
+	}
+
+	int minIndex = 0;
+	int maxIndex = 0;
+	float minProjection = 0.f;
+	float maxProjection = 0.f;
+	for (int i = 0; i < k_texelsPerBlock; i++)
+	{
+		float projection = texels[i].r * axis[0] + texels[i].g * axis[1] + texels[i].b * axis[2];
+		if (i == 0 || projection < minProjection)
+		{
+			minProjection = projection;
+			minIndex = i;
+		}
+		if (i == 0 || projection > maxProjection)
+		{
+			maxProjection = projection;
+			maxIndex = i;
+		}
+	}
+
+	outEndpoint0[0] = texels[maxIndex].r;
+	outEndpoint0[1] = texels[maxIndex].g;
+	outEndpoint0[2] = texels[maxIndex].b;
+	outEndpoint1[0] = texels[minIndex].r;
+	outEndpoint1[1] = texels[minIndex].g;
+	outEndpoint1[2] = texels[minIndex].b;
+}
+
+// Least squares endpoints for the chosen indices, false when every texel uses the same weight
+static bool RefineColorEndpoints( Rgba8 const* texels, unsigned char const* indices, unsigned short& outColor0, unsigned short& outColor1 )
+{
+	static float const s_weights[4] = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+	float weight00 = 0.f;
+	float weight01 = 0.f;
+	float weight11 = 0.f;
+	float weighted0[3] = {};
+	float weighted1[3] = {};
+	for (int i = 0; i < k_texelsPerBlock; i++)
+	{
+		float weight0 = s_weights[indices[i]];
+		float weight1 = 1.f - weight0;
+		float color[3] = { (float)texels[i].r, (float)texels[i].g, (float)texels[i].b };
+		weight00 += weight0 * weight0;
+		weight01 += weight0 * weight1;
+		weight11 += weight1 * weight1;
+		for (int channel = 0; channel < 3; channel++)
+		{
+			weighted0[channel] += weight0 * color[channel];
+			weighted1[channel] += weight1 * color[channel];
+		}
+	}
+
+	float determinant = weight00 * weight11 - weight01 * weight01;
+	if (fabsf( determinant ) < 1e-4f)
+		return false;
+
+	float endpoint0[3];
+	float endpoint1[3];
+	for (int channel = 0; channel < 3; channel++)
+	{
+		endpoint0[channel] = (weighted0[channel] * weight11 - weighted1[channel] * weight01) / determinant;
+		endpoint1[channel] = (weighted1[channel] * weight00 - weighted0[channel] * weight01) / determinant;
+	}
+	outColor0 = PackColor565( endpoint0 );
+	outColor1 = PackColor565( endpoint1 );
+	return true;
+}
+
+static void EncodeColorBlock( Rgba8 const* texels, unsigned char* outBlock )
+{
+	float endpoint0[3];
+	float endpoint1[3];
+	FindColorEndpoints( texels, endpoint0, endpoint1 );
+	unsigned short color0 = PackColor565( endpoint0 );
+	unsigned short color1 = PackColor565( endpoint1 );
+	unsigned char indices[k_texelsPerBlock];
+	int error = SelectColorIndices( texels, color0, color1, indices );
+
+	for (int iteration = 0; iteration < 2 && error > 0; iteration++)
+	{
+		unsigned short refinedColor0 = color0;
+		unsigned short refinedColor1 = color1;
+		if (!RefineColorEndpoints( texels, indices, refinedColor0, refinedColor1 ))
+			break;
+
+		unsigned char refinedIndices[k_texelsPerBlock];
+		int refinedError = SelectColorIndices( texels, refinedColor0, refinedColor1, refinedIndices );
+		if (refinedError >= error)
+			break;
+
+		color0 = refinedColor0;
+		color1 = refinedColor1;
+		memcpy( indices, refinedIndices, sizeof( indices ) );
+		error = refinedError;
+	}
+
+	// four colour mode needs color0 above color1, swapping the endpoints swaps index 0 with 1 and 2 with 3
+	if (color0 < color1)
+	{
+		unsigned short swapColor = color0;
+		color0 = color1;
+		color1 = swapColor;
+		for (int i = 0; i < k_texelsPerBlock; i++)
+		{
+			indices[i] ^= 1;
+		}
+	}
+	else if (color0 == color1)
+	{
+		memset( indices, 0, sizeof( indices ) );
+	}
+
+	unsigned int packedIndices = 0;
+	for (int i = 0; i < k_texelsPerBlock; i++)
+	{
+		packedIndices |= (unsigned int)indices[i] << (2 * i);
+	}
+	outBlock[0] = (unsigned char)(color0 & 0xff);
+	outBlock[1] = (unsigned char)(color0 >> 8);
+	outBlock[2] = (unsigned char)(color1 & 0xff);
+	outBlock[3] = (unsigned char)(color1 >> 8);
+	for (int byteIndex = 0; byteIndex < 4; byteIndex++)
+	{
+		outBlock[4 + byteIndex] = (unsigned char)(packedIndices >> (8 * byteIndex));
+	}
+}
+
+// The 8 byte interpolated block BC3 uses for alpha and BC5 for each of its two channels
+static void EncodeSingleChannelBlock( Rgba8 const* texels, int channel, unsigned char* outBlock )
+{
+	unsigned char const* bytes = reinterpret_cast<unsigned char const*>(texels);
+	int minValue = 255;
+	int maxValue = 0;
+	for (int i = 0; i < k_texelsPerBlock; i++)
+	{
+		int value = bytes[i * 4 + channel];
+		minValue = value < minValue ? value : minValue;
+		maxValue = value > maxValue ? value : maxValue;
+	}
+
+	// value0 above value1 selects the eight step ramp between them
+	unsigned long long packedIndices = 0;
+	if (maxValue > minValue)
+	{
+		int palette[8];
+		palette[0] = maxValue;
+		palette[1] = minValue;
+		for (int step = 1; step <= 6; step++)
+		{
+			palette[step + 1] = ((7 - step) * maxValue + step * minValue + 3) / 7;
+		}
+
+		for (int i = 0; i < k_texelsPerBlock; i++)
+		{
+			int value = bytes[i * 4 + channel];
+			int bestIndex = 0;
+			int bestError = 256;
+			for (int paletteIndex = 0; paletteIndex < 8; paletteIndex++)
+			{
+				int error = abs( value - palette[paletteIndex] );
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = paletteIndex;
+				}
+			}
+			packedIndices |= (unsigned long long)bestIndex << (3 * i);
+		}
+	}
+
+	outBlock[0] = (unsigned char)maxValue;
+	outBlock[1] = (unsigned char)minValue;
+	for (int byteIndex = 0; byteIndex < 6; byteIndex++)
+	{
+		outBlock[2 + byteIndex] = (unsigned char)(packedIndices >> (8 * byteIndex));
+	}
+}
+
+void EncodeBC1Block( Rgba8 const* blockTexels, unsigned char* outBlock )
+{
+	EncodeColorBlock( blockTexels, outBlock );
+}
+
+void EncodeBC3Block( Rgba8 const* blockTexels, unsigned char* outBlock )
+{
+	EncodeSingleChannelBlock( blockTexels, 3, outBlock );
+	EncodeColorBlock( blockTexels, outBlock + 8 );
+}
+
+void EncodeBC5Block( Rgba8 const* blockTexels, unsigned char* outBlock )
+{
+	EncodeSingleChannelBlock( blockTexels, 0, outBlock );
+	EncodeSingleChannelBlock( blockTexels, 1, outBlock + 8 );
+}
+
+void CompressRgba8ToBlocks( Rgba8 const* texels, IntVec2 const& dimensions, BlockCompressionFormat format, unsigned char* outBlocks )
+{
+	int blockSize = GetBlockCompressionBlockSize( format );
+	if (blockSize == 0 || dimensions.x <= 0 || dimensions.y <= 0)
+		return;
+
+	int blocksWide = (dimensions.x + 3) / 4;
+	int blocksHigh = (dimensions.y + 3) / 4;
+	Rgba8 blockTexels[k_texelsPerBlock];
+	unsigned char* outBlock = outBlocks;
+	for (int blockY = 0; blockY < blocksHigh; blockY++)
+	{
+		for (int blockX = 0; blockX < blocksWide; blockX++)
+		{
+			for (int y = 0; y < 4; y++)
+			{
+				int sourceY = ClampInt( blockY * 4 + y, 0, dimensions.y - 1 );
+				for (int x = 0; x < 4; x++)
+				{
+					int sourceX = ClampInt( blockX * 4 + x, 0, dimensions.x - 1 );
+					blockTexels[y * 4 + x] = texels[(size_t)sourceY * dimensions.x + sourceX];
+				}
+			}
+
+			switch (format)
+			{
+			case BlockCompressionFormat::BC1:
+				EncodeBC1Block( blockTexels, outBlock );
+				break;
+			case BlockCompressionFormat::BC3:
+				EncodeBC3Block( blockTexels, outBlock );
+				break;
+			case BlockCompressionFormat::BC5:
+				EncodeBC5Block( blockTexels, outBlock );
+				break;
+			default:
+				break;
+			}
+			outBlock += blockSize;
+		}
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Core/Rgba8.hpp"
+
+// The D3D block formats, each block covers 4x4 texels
+// BC1 is opaque RGB at 8 bytes, BC3 adds an interpolated alpha block for 16 bytes,
+// BC5 keeps only red and green in two such blocks and is meant for tangent space normals
+enum class BlockCompressionFormat
+{
+	NONE,
+	BC1,
+	BC3,
+	BC5,
+	COUNT
+};
+
+int GetBlockCompressionBlockSize( BlockCompressionFormat format );
+// Bytes in one row of blocks, partial blocks at the right edge count as whole ones
+size_t GetBlockCompressedRowPitch( int width, BlockCompressionFormat format );
+size_t GetBlockCompressedSize( IntVec2 const& dimensions, BlockCompressionFormat format );
+
+// blockTexels is 16 texels in row order, outBlock receives GetBlockCompressionBlockSize bytes
+void EncodeBC1Block( Rgba8 const* blockTexels, unsigned char* outBlock );
+void EncodeBC3Block( Rgba8 const* blockTexels, unsigned char* outBlock );
+void EncodeBC5Block( Rgba8 const* blockTexels, unsigned char* outBlock );
+
+// Compresses a whole level, texels past the right and bottom edges repeat the last column and row
+void CompressRgba8ToBlocks( Rgba8 const* texels, IntVec2 const& dimensions, BlockCompressionFormat format, unsigned char* outBlocks );
@@ -1,4 +1,8 @@
 #include <vector>
+#include <map>
+#include <atomic>
+#include <thread>
+#include <algorithm>
 
 #include "Engine/Core/DebugRenderSystem.hpp"
 #include "Engine/Core/EngineCommon.hpp"
@@ -14,10 +18,55 @@ std::mutex debugScreenMutex;
 DebugRenderConfig g_config = {};
 
 bool g_debugRenderVisible = true;
+
+// Resolved once at startup instead of looked up by path every frame, shapes are added from any thread and must not touch the renderer
+static Shader* g_debugShader = nullptr;
+static BitmapFont* g_debugFont = nullptr;
+
 Camera* g_playerCamera = nullptr;
 
 BillboardType g_billBoardType = BillboardType::FULL_FACING;
 
+enum class DebugPrimitive
+{
+	SPHERE,
+	CYLINDER,
+	CONE,
+	BOX
+};
+
+// One placement of a cached unit mesh, the unit mesh is built once per primitive and tessellation
+struct DebugMeshInstance
+{
+	Mat44 transform;
+	DebugPrimitive primitive = DebugPrimitive::SPHERE;
+	int numSlices = 0;
+	int numStacks = 0;
+	Rgba8 color = Rgba8::WHITE;
+};
+
+struct DebugMeshInstances
+{
+	// the most any shape places, a world basis is three cylinders and three cones
+	static constexpr int MAX_COUNT = 6;
+
+	void Add( DebugPrimitive primitive, Mat44 const& transform, int numSlices = 0, int numStacks = 0, Rgba8 const& color = Rgba8::WHITE )
+	{
+		ASSERT_OR_DIE( count < MAX_COUNT, "Debug shape places more unit meshes than DebugMeshInstances::MAX_COUNT" );
+		if (count >= MAX_COUNT)
+			return;
+		DebugMeshInstance& instance = instances[count++];
+		instance.transform = transform;
+		instance.primitive = primitive;
+		instance.numSlices = numSlices;
+		instance.numStacks = numStacks;
+		instance.color = color;
+	}
+
+	DebugMeshInstance instances[MAX_COUNT];
+	int count = 0;
+};
+
 struct DebugPoint
 {
 	Vec3 pos;
@@ -27,7 +76,7 @@ struct DebugPoint
 	Rgba8 startColor = Rgba8::WHITE;
 	Rgba8 endColor = Rgba8::WHITE;
 	DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
-	std::vector<Vertex_PCU> verts;
+	DebugMeshInstances meshes;
 };
 
 struct DebugLine
@@ -40,7 +89,7 @@ struct DebugLine
 	Rgba8 startColor = Rgba8::WHITE;
 	Rgba8 endColor = Rgba8::WHITE;
 	DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
-	std::vector<Vertex_PCU> verts;
+	DebugMeshInstances meshes;
 };
 
 struct DebugSolidCylinder
@@ -53,7 +102,7 @@ struct DebugSolidCylinder
 	Rgba8 startColor = Rgba8::WHITE;
 	Rgba8 endColor = Rgba8::WHITE;
 	DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
-	std::vector<Vertex_PCU> verts;
+	DebugMeshInstances meshes;
 };
 
 struct DebugWireCylinder
@@ -66,7 +115,7 @@ struct DebugWireCylinder
 	Rgba8 startColor = Rgba8::WHITE;
 	Rgba8 endColor = Rgba8::WHITE;
 	DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
-	std::vector<Vertex_PCU> verts;
+	DebugMeshInstances meshes;
 };
 
 struct DebugSolidSphere
@@ -78,7 +127,7 @@ struct DebugSolidSphere
 	Rgba8 startColor = Rgba8::WHITE;
 	Rgba8 endColor = Rgba8::WHITE;
 	DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
-	std::vector<Vertex_PCU> verts;
+	DebugMeshInstances meshes;
 };
 
 struct DebugWireSphere
@@ -90,7 +139,7 @@ struct DebugWireSphere
 	Rgba8 startColor = Rgba8::WHITE;
 	Rgba8 endColor = Rgba8::WHITE;
 	DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
-	std::vector<Vertex_PCU> verts;
+	DebugMeshInstances meshes;
 };
 
 struct DebugSolidCapsule
@@ -103,7 +152,7 @@ struct DebugSolidCapsule
 	Rgba8 startColor = Rgba8::WHITE;
 	Rgba8 endColor = Rgba8::WHITE;
 	DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
-	std::vector<Vertex_PCU> verts;
+	DebugMeshInstances meshes;
 };
 
 struct DebugWireCapsule
@@ -116,7 +165,7 @@ struct DebugWireCapsule
 	Rgba8 startColor = Rgba8::WHITE;
 	Rgba8 endColor = Rgba8::WHITE;
 	DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
-	std::vector<Vertex_PCU> verts;
+	DebugMeshInstances meshes;
 };
 
 struct DebugSolidBox
@@ -127,7 +176,7 @@ struct DebugSolidBox
 	Rgba8 startColor = Rgba8::WHITE;
 	Rgba8 endColor = Rgba8::WHITE;
 	DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
-	std::vector<Vertex_PCU> verts;
+	DebugMeshInstances meshes;
 };
 
 struct DebugWireBox
@@ -138,7 +187,7 @@ struct DebugWireBox
 	Rgba8 startColor = Rgba8::WHITE;
 	Rgba8 endColor = Rgba8::WHITE;
 	DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
-	std::vector<Vertex_PCU> verts;
+	DebugMeshInstances meshes;
 };
 
 struct DebugArrow
@@ -151,7 +200,7 @@ struct DebugArrow
 	Rgba8 startColor = Rgba8::WHITE;
 	Rgba8 endColor = Rgba8::WHITE;
 	DebugRenderMode mode = DebugRenderMode::USE_DEPTH;
-	std::vector<Vertex_PCU> verts;
+	DebugMeshInstances meshes;
 };
 
 struct DebugWorldText
@@ -186,7 +235,7 @@ struct DebugWorldBasis
 	float remain;
 	float duration;
 	DebugRenderMode mode;
-	std::vector<Vertex_PCU> verts;
+	DebugMeshInstances meshes;
 };
 
 struct DebugScreenText
@@ -227,9 +276,131 @@ std::vector<DebugWorldBasis*>		g_debugWorldBasis;
 std::vector<DebugScreenText*>		g_debugScreenText;
 std::vector<DebugMessage*>			g_debugMessage;
 
+// Unit meshes the world shapes are instanced from, only touched while debugWorldMutex is held
+std::map<int, std::vector<Vertex_PCU>>	g_debugUnitMeshes;
+
+// Shape added on some thread that has not been placed into its list yet
+struct DebugPendingShape
+{
+	void* shape = nullptr;
+	void* list = nullptr;
+	void (*merge)( void* shape, void* list ) = nullptr;
+	unsigned int sequence = 0;
+};
+
+// Only its own thread appends, MergeDebugShapeBuffers flips the halves and drains the one that was being written
+struct DebugShapeBuffer
+{
+	std::vector<DebugPendingShape> shapes[2];
+	std::atomic<int> writeIndex = 0;
+	std::atomic<bool> isWriting = false;
+};
+
+std::vector<DebugShapeBuffer*>		g_debugShapeBuffers;
+std::mutex							g_debugShapeBuffersMutex;
+std::vector<DebugPendingShape>		g_debugMergeList;
+std::atomic<unsigned int>			g_debugShapeSequence = 0;
+// bumped on shutdown so threads drop the buffer they cached
+std::atomic<int>					g_debugShapeBufferGeneration = 1;
+
+static thread_local DebugShapeBuffer* t_debugShapeBuffer = nullptr;
+static thread_local int t_debugShapeBufferGeneration = 0;
+
+template<typename T>
+static void MergeDebugShape( void* shape, void* list )
+{
+	static_cast<std::vector<T*>*>(list)->push_back( static_cast<T*>(shape) );
+}
+
+template<typename T>
+static void QueueDebugShape( T* shape, std::vector<T*>& list )
+{
+	int generation = g_debugShapeBufferGeneration;
+	if (t_debugShapeBufferGeneration != generation)
+	{
+		DebugShapeBuffer* buffer = new DebugShapeBuffer();
+		g_debugShapeBuffersMutex.lock();
+		g_debugShapeBuffers.push_back( buffer );
+		g_debugShapeBuffersMutex.unlock();
+
+		t_debugShapeBuffer = buffer;
+		t_debugShapeBufferGeneration = generation;
+	}
+
+	DebugShapeBuffer* buffer = t_debugShapeBuffer;
+	buffer->isWriting = true;
+	int writeIndex = buffer->writeIndex;
+	buffer->shapes[writeIndex].push_back( DebugPendingShape{ shape, &list, &MergeDebugShape<T>, g_debugShapeSequence++ } );
+	buffer->isWriting = false;
+}
+
+template<typename T>
+static void RemoveDeadDebugShapes( std::vector<T*>& shapes )
+{
+	shapes.erase( std::remove( shapes.begin(), shapes.end(), nullptr ), shapes.end() );
+}
+
+static void MergeDebugShapeBuffers()
+{
+	debugWorldMutex.lock();
+	debugScreenMutex.lock();
+
+	// flip first, then wait out a writer that may have picked the old half just before the flip
+	g_debugShapeBuffersMutex.lock();
+	for (DebugShapeBuffer* buffer : g_debugShapeBuffers)
+	{
+		int readIndex = buffer->writeIndex;
+		buffer->writeIndex = 1 - readIndex;
+		while (buffer->isWriting)
+		{
+			std::this_thread::yield();
+		}
+		g_debugMergeList.insert( g_debugMergeList.end(), buffer->shapes[readIndex].begin(), buffer->shapes[readIndex].end() );
+		buffer->shapes[readIndex].clear();
+	}
+	g_debugShapeBuffersMutex.unlock();
+
+	if (!g_debugMergeList.empty())
+	{
+		RemoveDeadDebugShapes( g_debugPoint );
+		RemoveDeadDebugShapes( g_debugLine );
+		RemoveDeadDebugShapes( g_debugSolidCylinder );
+		RemoveDeadDebugShapes( g_debugWireCylinder );
+		RemoveDeadDebugShapes( g_debugSolidSphere );
+		RemoveDeadDebugShapes( g_debugWireSphere );
+		RemoveDeadDebugShapes( g_debugSolidCapsule );
+		RemoveDeadDebugShapes( g_debugWireCapsule );
+		RemoveDeadDebugShapes( g_debugSolidBox );
+		RemoveDeadDebugShapes( g_debugWireBox );
+		RemoveDeadDebugShapes( g_debugArrow );
+		RemoveDeadDebugShapes( g_debugWorldText );
+		RemoveDeadDebugShapes( g_debugBillboardText );
+		RemoveDeadDebugShapes( g_debugWorldBasis );
+		RemoveDeadDebugShapes( g_debugScreenText );
+		RemoveDeadDebugShapes( g_debugMessage );
+
+		// keep the order shapes were added in across threads, screen text stacks in that order
+		std::sort( g_debugMergeList.begin(), g_debugMergeList.end(),
+			[]( DebugPendingShape const& a, DebugPendingShape const& b )
+			{
+				return a.sequence < b.sequence;
+			} );
+		for (DebugPendingShape const& pendingShape : g_debugMergeList)
+		{
+			pendingShape.merge( pendingShape.shape, pendingShape.list );
+		}
+		g_debugMergeList.clear();
+	}
+
+	debugScreenMutex.unlock();
+	debugWorldMutex.unlock();
+}
+
 void DebugRenderSystemStartup( DebugRenderConfig const& config )
 {
 	g_config = config;
+	g_debugShader = g_config.m_renderer->CreateShader( "Data/Shaders/Default.hlsl", VertexType::VERTEX_PCU );
+	g_debugFont = g_config.m_renderer->CreateOrGetBitmapFont( "Data/Fonts/SquirrelFixedFont.png" );
 
 	g_debugPoint.reserve( 10 );
 	g_debugLine.reserve( 10 );
@@ -248,8 +419,25 @@ void DebugRenderSystemStartup( DebugRenderConfig const& config )
 void DebugRenderSystemShutdown()
 {
 	DebugRenderSetHidden();
+	MergeDebugShapeBuffers();
 	DebugRenderClear();
 
+	debugWorldMutex.lock();
+	g_debugUnitMeshes.clear();
+	debugWorldMutex.unlock();
+
+	g_debugShader = nullptr;
+	g_debugFont = nullptr;
+
+	g_debugShapeBuffersMutex.lock();
+	for (DebugShapeBuffer* buffer : g_debugShapeBuffers)
+	{
+		delete buffer;
+	}
+	g_debugShapeBuffers.clear();
+	g_debugShapeBufferGeneration++;
+	g_debugShapeBuffersMutex.unlock();
+
 	g_eventSystem->UnsubscribeEventCallbackFunc( "DRClear", reinterpret_cast<void(*)()>(Command_DebugRenderClear) );
 	g_eventSystem->UnsubscribeEventCallbackFunc( "DRToggle", reinterpret_cast<void(*)()>(Command_DebugRenderToggle) );
 }
@@ -281,6 +469,171 @@ void DebugRenderClear()
 
 void DebugRenderBeginFrame()
 {
+	MergeDebugShapeBuffers();
+}
+
+// Every DebugRenderWorld call bakes the live shapes into these streams, capacity is kept between frames
+struct DebugWorldBatch
+{
+	std::vector<Vertex_PCU> solidVerts;
+	std::vector<Vertex_PCU> wireVerts;
+	std::vector<Vertex_PCU> xRaySolidVerts;
+	std::vector<Vertex_PCU> xRayWireVerts;
+	std::vector<Vertex_PCU> textVerts;
+	std::vector<Vertex_PCU> billboardVerts;
+};
+
+DebugWorldBatch g_debugWorldBatch;
+
+static Rgba8 GetDebugShapeColor( Rgba8 const& startColor, Rgba8 const& endColor, float duration, float remain )
+{
+	float fraction = Clamp( (duration - remain) / duration, 0.f, 1.f );
+	return Rgba8(
+		static_cast<unsigned char>((int)startColor.r + (int)(((float)endColor.r - (float)startColor.r) * fraction)),
+		static_cast<unsigned char>((int)startColor.g + (int)(((float)endColor.g - (float)startColor.g) * fraction)),
+		static_cast<unsigned char>((int)startColor.b + (int)(((float)endColor.b - (float)startColor.b) * fraction)),
+		static_cast<unsigned char>((int)startColor.a + (int)(((float)endColor.a - (float)startColor.a) * fraction))
+	);
+}
+
+static Rgba8 MultiplyColor( Rgba8 const& color, Rgba8 const& tint )
+{
+	return Rgba8(
+		static_cast<unsigned char>(((int)color.r * (int)tint.r + 127) / 255),
+		static_cast<unsigned char>(((int)color.g * (int)tint.g + 127) / 255),
+		static_cast<unsigned char>(((int)color.b * (int)tint.b + 127) / 255),
+		static_cast<unsigned char>(((int)color.a * (int)tint.a + 127) / 255)
+	);
+}
+
+// Same result as drawing verts with tint as the model color
+static void AppendTintedVerts( std::vector<Vertex_PCU>& outVerts, std::vector<Vertex_PCU> const& verts, Rgba8 const& tint )
+{
+	size_t start = outVerts.size();
+	outVerts.insert( outVerts.end(), verts.begin(), verts.end() );
+	if (tint == Rgba8::WHITE)
+		return;
+
+	for (size_t i = start; i < outVerts.size(); i++)
+	{
+		outVerts[i].m_color = MultiplyColor( outVerts[i].m_color, tint );
+	}
+}
+
+// Sphere has radius 1 around the origin, cylinder and cone run from the origin to +Z with radius 1, box spans -1 to 1
+static std::vector<Vertex_PCU> const& GetDebugUnitMesh( DebugPrimitive primitive, int numSlices, int numStacks )
+{
+	int key = (int)primitive | (numSlices << 4) | (numStacks << 16);
+	auto found = g_debugUnitMeshes.find( key );
+	if (found != g_debugUnitMeshes.end())
+		return found->second;
+
+	std::vector<Vertex_PCU>& verts = g_debugUnitMeshes[key];
+	switch (primitive)
+	{
+	case DebugPrimitive::SPHERE:
+		AddVertsForSphere3D( verts, Vec3::ZERO, 1.f, Rgba8::WHITE, AABB2::ZERO_TO_ONE, numSlices, numStacks );
+		break;
+	case DebugPrimitive::CYLINDER:
+		AddVertsForCylinder3D( verts, Vec3::ZERO, Vec3( 0.f, 0.f, 1.f ), 1.f, Rgba8::WHITE, AABB2::ZERO_TO_ONE, numSlices );
+		break;
+	case DebugPrimitive::CONE:
+		AddVertsForCone3D( verts, Vec3::ZERO, Vec3( 0.f, 0.f, 1.f ), 1.f, Rgba8::WHITE, AABB2::ZERO_TO_ONE, numSlices );
+		break;
+	case DebugPrimitive::BOX:
+		AddVertsForOBB3D( verts, OBB3( Vec3::ZERO, Vec3( 1.f, 0.f, 0.f ), Vec3( 0.f, 1.f, 0.f ), Vec3( 0.f, 0.f, 1.f ), Vec3( 1.f, 1.f, 1.f ) ), Rgba8::WHITE, AABB2::ZERO_TO_ONE );
+		break;
+	}
+	return verts;
+}
+
+static void AppendMeshInstances( std::vector<Vertex_PCU>& outVerts, DebugMeshInstances const& meshes, Rgba8 const& tint )
+{
+	for (int instanceIndex = 0; instanceIndex < meshes.count; instanceIndex++)
+	{
+		DebugMeshInstance const& instance = meshes.instances[instanceIndex];
+		std::vector<Vertex_PCU> const& unitVerts = GetDebugUnitMesh( instance.primitive, instance.numSlices, instance.numStacks );
+		Rgba8 color = MultiplyColor( instance.color, tint );
+
+		size_t start = outVerts.size();
+		outVerts.resize( start + unitVerts.size() );
+		for (size_t i = 0; i < unitVerts.size(); i++)
+		{
+			Vertex_PCU& vert = outVerts[start + i];
+			vert.m_position = instance.transform.TransformPosition3D( unitVerts[i].m_position );
+			vert.m_color = color;
+			vert.m_uvTexCoords = unitVerts[i].m_uvTexCoords;
+		}
+	}
+}
+
+// Places the unit cylinder or cone between start and end, with the same basis AddVertsForCylinder3D picks
+static Mat44 GetDebugPrimitiveTransform( Vec3 const& start, Vec3 const& end, float radius )
+{
+	Vec3 displacement = end - start;
+	float height = displacement.GetLength();
+	Vec3 kBasis = height > 0.f ? displacement / height : Vec3( 0.f, 0.f, 1.f );
+	Vec3 iBasis( 1.f, 0.f, 0.f );
+	Vec3 jBasis( 0.f, 1.f, 0.f );
+	if (kBasis != Vec3( 0.f, 0.f, 1.f ) && kBasis != Vec3( 0.f, 0.f, -1.f ))
+	{
+		jBasis = CrossProduct3D( Vec3( 0.f, 0.f, 1.f ), kBasis ).GetNormalized();
+		iBasis = CrossProduct3D( jBasis, kBasis );
+	}
+	return Mat44( iBasis * radius, jBasis * radius, kBasis * height, start );
+}
+
+static Mat44 GetDebugSphereTransform( Vec3 const& center, float radius )
+{
+	return Mat44( Vec3( radius, 0.f, 0.f ), Vec3( 0.f, radius, 0.f ), Vec3( 0.f, 0.f, radius ), center );
+}
+
+static Mat44 GetDebugBoxTransform( OBB3 const& bound )
+{
+	return Mat44( bound.m_iBasisNormal * bound.m_halfDimensions.x, bound.m_jBasisNormal * bound.m_halfDimensions.y, bound.m_kBasisNormal * bound.m_halfDimensions.z, bound.m_center );
+}
+
+template<typename T>
+static void BatchDebugShapes( std::vector<T*>& shapes, DebugRenderMode renderingMode, float deltaSeconds, std::vector<Vertex_PCU>& outVerts, std::vector<Vertex_PCU>& outXRayVerts )
+{
+	for (T*& shape : shapes)
+	{
+		if (shape == nullptr)
+			continue;
+		if (shape->mode != renderingMode)
+			continue;
+
+		if (shape->duration == -1.f || shape->remain > 0.f)
+		{
+			Rgba8 color = GetDebugShapeColor( shape->startColor, shape->endColor, shape->duration, shape->remain );
+			if (renderingMode == DebugRenderMode::X_RAY)
+			{
+				Rgba8 xRayColor = color;
+				xRayColor.a = 45;
+				AppendMeshInstances( outXRayVerts, shape->meshes, xRayColor );
+			}
+			AppendMeshInstances( outVerts, shape->meshes, color );
+			shape->remain -= deltaSeconds;
+		}
+		else if (shape->duration != -1.f && shape->remain <= 0)
+		{
+			delete shape;
+			shape = nullptr;
+		}
+	}
+}
+
+static void DrawDebugBatch( std::vector<Vertex_PCU> const& verts, BlendMode blendMode, DepthMode depthMode, RasterizerMode rasterizerMode, Texture* texture = nullptr )
+{
+	if (verts.empty())
+		return;
+
+	g_config.m_renderer->SetModelConstants();
+	g_config.m_renderer->SetBlendMode( blendMode );
+	g_config.m_renderer->SetDepthMode( depthMode );
+	g_config.m_renderer->SetRasterizerState( rasterizerMode );
+	g_config.m_renderer->BindTexture( texture );
+	g_config.m_renderer->DrawVertexArray( (int)verts.size(), verts.data() );
 }
 
 void DebugRenderWorld( Camera const& camera, DebugRenderMode renderingMode )
@@ -289,84 +642,68 @@ void DebugRenderWorld( Camera const& camera, DebugRenderMode renderingMode )
 	if (g_debugRenderVisible == false)
 		return;
 
+	// shapes added since DebugRenderBeginFrame still show up this frame
+	MergeDebugShapeBuffers();
 
 	debugWorldMutex.lock();
 
 	float deltaSeconds = Clock::s_systemClock.GetDeltaSeconds();
-	g_config.m_renderer->BeginCamera( camera );
-	g_config.m_renderer->BindShader( g_config.m_renderer->CreateShader( "Data/Shaders/Default.hlsl", VertexType::VERTEX_PCU ) );
 
+	DebugWorldBatch& batch = g_debugWorldBatch;
+	batch.solidVerts.clear();
+	batch.wireVerts.clear();
+	batch.xRaySolidVerts.clear();
+	batch.xRayWireVerts.clear();
+	batch.textVerts.clear();
+	batch.billboardVerts.clear();
+
+	BatchDebugShapes( g_debugPoint, renderingMode, deltaSeconds, batch.solidVerts, batch.xRaySolidVerts );
+	BatchDebugShapes( g_debugLine, renderingMode, deltaSeconds, batch.solidVerts, batch.xRaySolidVerts );
+	BatchDebugShapes( g_debugSolidCylinder, renderingMode, deltaSeconds, batch.solidVerts, batch.xRaySolidVerts );
+	BatchDebugShapes( g_debugWireCylinder, renderingMode, deltaSeconds, batch.wireVerts, batch.xRayWireVerts );
+	BatchDebugShapes( g_debugSolidSphere, renderingMode, deltaSeconds, batch.solidVerts, batch.xRaySolidVerts );
+	BatchDebugShapes( g_debugWireSphere, renderingMode, deltaSeconds, batch.wireVerts, batch.xRayWireVerts );
+	BatchDebugShapes( g_debugSolidCapsule, renderingMode, deltaSeconds, batch.solidVerts, batch.xRaySolidVerts );
+	BatchDebugShapes( g_debugWireCapsule, renderingMode, deltaSeconds, batch.wireVerts, batch.xRayWireVerts );
+	BatchDebugShapes( g_debugSolidBox, renderingMode, deltaSeconds, batch.solidVerts, batch.xRaySolidVerts );
+	BatchDebugShapes( g_debugWireBox, renderingMode, deltaSeconds, batch.wireVerts, batch.xRayWireVerts );
+	BatchDebugShapes( g_debugArrow, renderingMode, deltaSeconds, batch.solidVerts, batch.xRaySolidVerts );
+
+	for (DebugWorldBasis*& shape : g_debugWorldBasis)
+	{
+		if (shape == nullptr)
+			continue;
+		if (shape->mode != renderingMode)
+			continue;
+
+		if (shape->duration == -1.f || shape->remain > 0.f)
+		{
+			if (renderingMode == DebugRenderMode::X_RAY)
+			{
+				AppendMeshInstances( batch.xRaySolidVerts, shape->meshes, Rgba8( 255, 255, 255, 45 ) );
+			}
+			AppendMeshInstances( batch.solidVerts, shape->meshes, Rgba8::WHITE );
+			shape->remain -= deltaSeconds;
+		}
+		else if (shape->duration != -1.f && shape->remain <= 0)
+		{
+			delete shape;
+			shape = nullptr;
+		}
+	}
+
+	// text has no mode of its own and is drawn with the NUL pass
+	if (renderingMode == DebugRenderMode::NUL)
 	{
-		for (DebugPoint*& shape : g_debugPoint)
+		for (DebugWorldText*& shape : g_debugWorldText)
 		{
 			if (shape == nullptr)
 				continue;
-			if (shape->mode != renderingMode)
-				continue;
 
 			if (shape->duration == -1.f || shape->remain > 0.f)
 			{
-				float fraction = Clamp( (shape->duration - shape->remain) / shape->duration, 0.f, 1.f );
-				Rgba8 startColor = shape->startColor;
-				Rgba8 endColor = shape->endColor;
-				Rgba8 color(
-					static_cast<unsigned char>((int)startColor.r + (int)(((float)endColor.r - (float)startColor.r) * fraction)),
-					static_cast<unsigned char>((int)startColor.g + (int)(((float)endColor.g - (float)startColor.g) * fraction)),
-					static_cast<unsigned char>((int)startColor.b + (int)(((float)endColor.b - (float)startColor.b) * fraction)),
-					static_cast<unsigned char>((int)startColor.a + (int)(((float)endColor.a - (float)startColor.a) * fraction))
-				);
-				switch (renderingMode)
-				{
-				case DebugRenderMode::ALWAYS:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::USE_DEPTH:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::NUL:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::X_RAY:
-				{
-					Rgba8 tColor = color;
-					tColor.a = 45;
-					g_config.m_renderer->SetModelConstants( Mat44(), tColor );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::OPAQUE );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				}
+				Rgba8 color = GetDebugShapeColor( shape->startColor, shape->endColor, shape->duration, shape->remain );
+				AppendTintedVerts( batch.textVerts, shape->verts, color );
 				shape->remain -= deltaSeconds;
 			}
 			else if (shape->duration != -1.f && shape->remain <= 0)
@@ -375,79 +712,21 @@ void DebugRenderWorld( Camera const& camera, DebugRenderMode renderingMode )
 				shape = nullptr;
 			}
 		}
-	}
 
-	{
-		for (DebugLine*& shape : g_debugLine)
+		for (DebugBillboardText*& shape : g_debugBillboardText)
 		{
 			if (shape == nullptr)
 				continue;
-			if (shape->mode != renderingMode)
-				continue;
 
 			if (shape->duration == -1.f || shape->remain > 0.f)
 			{
-				float fraction = Clamp( (shape->duration - shape->remain) / shape->duration, 0.f, 1.f );
-				Rgba8 startColor = shape->startColor;
-				Rgba8 endColor = shape->endColor;
-				Rgba8 color(
-					static_cast<unsigned char>((int)startColor.r + (int)(((float)endColor.r - (float)startColor.r) * fraction)),
-					static_cast<unsigned char>((int)startColor.g + (int)(((float)endColor.g - (float)startColor.g) * fraction)),
-					static_cast<unsigned char>((int)startColor.b + (int)(((float)endColor.b - (float)startColor.b) * fraction)),
-					static_cast<unsigned char>((int)startColor.a + (int)(((float)endColor.a - (float)startColor.a) * fraction))
-				);
-				switch (renderingMode)
-				{
-				case DebugRenderMode::ALWAYS:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::USE_DEPTH:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::NUL:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::X_RAY:
-				{
-					Rgba8 tColor = color;
-					tColor.a = 45;
-					g_config.m_renderer->SetModelConstants( Mat44(), tColor );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::OPAQUE );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				}
+				Rgba8 color = GetDebugShapeColor( shape->startColor, shape->endColor, shape->duration, shape->remain );
+				Mat44 tranform = GetBillboardMatrix( g_billBoardType, g_playerCamera->GetTransformMatrix(), shape->origin, Vec2::ONE );
+
+				batch.billboardVerts.clear();
+				AppendTintedVerts( batch.billboardVerts, shape->verts, color );
+				TransformVertexArray3D( batch.billboardVerts, tranform );
+				batch.textVerts.insert( batch.textVerts.end(), batch.billboardVerts.begin(), batch.billboardVerts.end() );
 				shape->remain -= deltaSeconds;
 			}
 			else if (shape->duration != -1.f && shape->remain <= 0)
@@ -458,15 +737,76 @@ void DebugRenderWorld( Camera const& camera, DebugRenderMode renderingMode )
 		}
 	}
 
+	g_config.m_renderer->BeginCamera( camera );
+	g_config.m_renderer->BindShader( g_debugShader );
+
+	switch (renderingMode)
+	{
+	case DebugRenderMode::ALWAYS:
+	{
+		DrawDebugBatch( batch.solidVerts, BlendMode::ALPHA, DepthMode::DISABLED, RasterizerMode::SOLID_CULL_BACK );
+		DrawDebugBatch( batch.wireVerts, BlendMode::ALPHA, DepthMode::DISABLED, RasterizerMode::WIREFRAME_CULL_NONE );
+		break;
+	}
+	case DebugRenderMode::USE_DEPTH:
+	case DebugRenderMode::NUL:
+	{
+		DrawDebugBatch( batch.solidVerts, BlendMode::ALPHA, DepthMode::ENABLED, RasterizerMode::SOLID_CULL_BACK );
+		DrawDebugBatch( batch.wireVerts, BlendMode::ALPHA, DepthMode::ENABLED, RasterizerMode::WIREFRAME_CULL_NONE );
+		break;
+	}
+	case DebugRenderMode::X_RAY:
+	{
+		DrawDebugBatch( batch.xRaySolidVerts, BlendMode::ALPHA, DepthMode::DISABLED, RasterizerMode::SOLID_CULL_BACK );
+		DrawDebugBatch( batch.xRayWireVerts, BlendMode::ALPHA, DepthMode::DISABLED, RasterizerMode::WIREFRAME_CULL_NONE );
+		DrawDebugBatch( batch.solidVerts, BlendMode::OPAQUE, DepthMode::ENABLED, RasterizerMode::SOLID_CULL_BACK );
+		DrawDebugBatch( batch.wireVerts, BlendMode::OPAQUE, DepthMode::ENABLED, RasterizerMode::WIREFRAME_CULL_NONE );
+		break;
+	}
+	}
+
+	if (!batch.textVerts.empty())
+	{
+		DrawDebugBatch( batch.textVerts, BlendMode::ALPHA, DepthMode::ENABLED, RasterizerMode::SOLID_CULL_NONE, &g_debugFont->GetTexture() );
+	}
+
+	g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
+	g_config.m_renderer->BindTexture( nullptr );
+
+	g_config.m_renderer->EndCamera( camera );
+
+	debugWorldMutex.unlock();
+}
+
+void DebugRenderScreen( Camera const& camera )
+{
+	if (g_debugRenderVisible == false)
+		return;
+
+	MergeDebugShapeBuffers();
+
+	debugScreenMutex.lock();
+
+	float deltaSeconds = Clock::s_systemClock.GetDeltaSeconds();
+	BitmapFont* font = g_debugFont;
+	g_config.m_renderer->BeginCamera( camera );
+
 	{
-		for (DebugSolidCylinder*& shape : g_debugSolidCylinder)
+		std::vector<Vertex_PCU> verts;
+		int counter = 0;
+		for (DebugScreenText*& shape : g_debugScreenText)
 		{
 			if (shape == nullptr)
 				continue;
-			if (shape->mode != renderingMode)
-				continue;
 
-			if (shape->duration == -1.f || shape->remain > 0.f)
+			if (shape->duration == -1.f)
+			{
+				float boxWidth = static_cast<float>(shape->text.length()) * shape->size * 0.7f;
+				float boxHeight = shape->size;
+				Vec2 pivot = shape->position - Vec2( boxWidth * (1.f - shape->alignment.x), boxHeight * (1.f - shape->alignment.y) ) - Vec2( 0.f, counter * boxHeight );
+				font->AddVertsForText2D( verts, pivot, shape->size, shape->text, shape->startColor, 0.7f );
+			}
+			else if (shape->remain >= 0.f)
 			{
 				float fraction = Clamp( (shape->duration - shape->remain) / shape->duration, 0.f, 1.f );
 				Rgba8 startColor = shape->startColor;
@@ -477,953 +817,46 @@ void DebugRenderWorld( Camera const& camera, DebugRenderMode renderingMode )
 					static_cast<unsigned char>((int)startColor.b + (int)(((float)endColor.b - (float)startColor.b) * fraction)),
 					static_cast<unsigned char>((int)startColor.a + (int)(((float)endColor.a - (float)startColor.a) * fraction))
 				);
-				switch (renderingMode)
-				{
-				case DebugRenderMode::ALWAYS:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::USE_DEPTH:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::NUL:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::X_RAY:
-				{
-					Rgba8 tColor = color;
-					tColor.a = 45;
-					g_config.m_renderer->SetModelConstants( Mat44(), tColor );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::OPAQUE );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				}
-				shape->remain -= deltaSeconds;
+				float boxWidth = static_cast<float>(shape->text.length()) * shape->size * 0.7f;
+				float boxHeight = shape->size;
+				Vec2 pivot = shape->position - Vec2( boxWidth * (1.f - shape->alignment.x), boxHeight * (1.f - shape->alignment.y) ) - Vec2( 0.f, counter * boxHeight );
+				font->AddVertsForText2D( verts, pivot, shape->size, shape->text, shape->startColor, 0.7f );
 			}
-			else if (shape->duration != -1.f && shape->remain <= 0)
+			else
 			{
 				delete shape;
 				shape = nullptr;
+				continue;
 			}
+			shape->remain -= deltaSeconds;
+			counter++;
 		}
+		g_config.m_renderer->SetModelConstants();
+		g_config.m_renderer->SetLightingConstants( Vec3( 2.f, 1.f, -1.f ).GetNormalized(), 1.f, 1.f );
+		g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
+		g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_NONE );
+		g_config.m_renderer->BindTexture( &font->GetTexture() );
+		g_config.m_renderer->DrawVertexArray( verts );
 	}
 
 	{
-		for (DebugWireCylinder*& shape : g_debugWireCylinder)
+		std::vector<Vertex_PCU> verts;
+		int counter = 0;
+		for (DebugMessage*& shape : g_debugMessage)
 		{
 			if (shape == nullptr)
 				continue;
-			if (shape->mode != renderingMode)
-				continue;
 
-			if (shape->remain == -1.f || shape->remain > 0.f)
-			{
-				float fraction = Clamp( (shape->duration - shape->remain) / shape->duration, 0.f, 1.f );
-				Rgba8 startColor = shape->startColor;
-				Rgba8 endColor = shape->endColor;
-				Rgba8 color(
-					static_cast<unsigned char>((int)startColor.r + (int)(((float)endColor.r - (float)startColor.r) * fraction)),
-					static_cast<unsigned char>((int)startColor.g + (int)(((float)endColor.g - (float)startColor.g) * fraction)),
-					static_cast<unsigned char>((int)startColor.b + (int)(((float)endColor.b - (float)startColor.b) * fraction)),
-					static_cast<unsigned char>((int)startColor.a + (int)(((float)endColor.a - (float)startColor.a) * fraction))
-				);
-				switch (renderingMode)
-				{
-				case DebugRenderMode::ALWAYS:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::USE_DEPTH:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::NUL:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::X_RAY:
-				{
-					Rgba8 tColor = color;
-					tColor.a = 45;
-					g_config.m_renderer->SetModelConstants( Mat44(), tColor );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::OPAQUE );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				}
-				g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-				shape->remain -= deltaSeconds;
-			}
-			else if (shape->duration != -1.f && shape->remain <= 0)
-			{
-				delete shape;
-				shape = nullptr;
-			}
-		}
-	}
-
-	{
-		for (DebugSolidSphere*& shape : g_debugSolidSphere)
-		{
-			if (shape == nullptr)
-				continue;
-			if (shape->mode != renderingMode)
-				continue;
-
-			if (shape->duration == -1.f || shape->remain > 0.f)
-			{
-				float fraction = Clamp( (shape->duration - shape->remain) / shape->duration, 0.f, 1.f );
-				Rgba8 startColor = shape->startColor;
-				Rgba8 endColor = shape->endColor;
-				Rgba8 color(
-					static_cast<unsigned char>((int)startColor.r + (int)(((float)endColor.r - (float)startColor.r) * fraction)),
-					static_cast<unsigned char>((int)startColor.g + (int)(((float)endColor.g - (float)startColor.g) * fraction)),
-					static_cast<unsigned char>((int)startColor.b + (int)(((float)endColor.b - (float)startColor.b) * fraction)),
-					static_cast<unsigned char>((int)startColor.a + (int)(((float)endColor.a - (float)startColor.a) * fraction))
-				);
-				switch (renderingMode)
-				{
-				case DebugRenderMode::ALWAYS:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::USE_DEPTH:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::NUL:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::X_RAY:
-				{
-					Rgba8 tColor = color;
-					tColor.a = 45;
-					g_config.m_renderer->SetModelConstants( Mat44(), tColor );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::OPAQUE );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				}
-				shape->remain -= deltaSeconds;
-			}
-			else if (shape->duration != -1.f && shape->remain <= 0)
-			{
-				delete shape;
-				shape = nullptr;
-			}
-		}
-	}
-
-	{
-		for (DebugWireSphere*& shape : g_debugWireSphere)
-		{
-			if (shape == nullptr)
-				continue;
-			if (shape->mode != renderingMode)
-				continue;
-
-			if (shape->duration == -1.f || shape->remain > 0.f)
-			{
-				float fraction = Clamp( (shape->duration - shape->remain) / shape->duration, 0.f, 1.f );
-				Rgba8 startColor = shape->startColor;
-				Rgba8 endColor = shape->endColor;
-				Rgba8 color(
-					static_cast<unsigned char>((int)startColor.r + (int)(((float)endColor.r - (float)startColor.r) * fraction)),
-					static_cast<unsigned char>((int)startColor.g + (int)(((float)endColor.g - (float)startColor.g) * fraction)),
-					static_cast<unsigned char>((int)startColor.b + (int)(((float)endColor.b - (float)startColor.b) * fraction)),
-					static_cast<unsigned char>((int)startColor.a + (int)(((float)endColor.a - (float)startColor.a) * fraction))
-				);
-				switch (renderingMode)
-				{
-				case DebugRenderMode::ALWAYS:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::USE_DEPTH:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::NUL:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::X_RAY:
-				{
-					Rgba8 tColor = color;
-					tColor.a = 45;
-					g_config.m_renderer->SetModelConstants( Mat44(), tColor );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::OPAQUE );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				}
-				shape->remain -= deltaSeconds;
-				g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-			}
-			else if (shape->duration != -1.f && shape->remain <= 0)
-			{
-				delete shape;
-				shape = nullptr;
-			}
-		}
-	}
-
-	{
-		for (DebugSolidCapsule*& shape : g_debugSolidCapsule)
-		{
-			if (shape == nullptr)
-				continue;
-			if (shape->mode != renderingMode)
-				continue;
-
-			if (shape->duration == -1.f || shape->remain > 0.f)
-			{
-				float fraction = Clamp( (shape->duration - shape->remain) / shape->duration, 0.f, 1.f );
-				Rgba8 startColor = shape->startColor;
-				Rgba8 endColor = shape->endColor;
-				Rgba8 color(
-					static_cast<unsigned char>((int)startColor.r + (int)(((float)endColor.r - (float)startColor.r) * fraction)),
-					static_cast<unsigned char>((int)startColor.g + (int)(((float)endColor.g - (float)startColor.g) * fraction)),
-					static_cast<unsigned char>((int)startColor.b + (int)(((float)endColor.b - (float)startColor.b) * fraction)),
-					static_cast<unsigned char>((int)startColor.a + (int)(((float)endColor.a - (float)startColor.a) * fraction))
-				);
-				switch (renderingMode)
-				{
-				case DebugRenderMode::ALWAYS:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::USE_DEPTH:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::NUL:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::X_RAY:
-				{
-					Rgba8 tColor = color;
-					tColor.a = 45;
-					g_config.m_renderer->SetModelConstants( Mat44(), tColor );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::OPAQUE );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				}
-				shape->remain -= deltaSeconds;
-			}
-			else if (shape->duration != -1.f && shape->remain <= 0)
-			{
-				delete shape;
-				shape = nullptr;
-			}
-		}
-	}
-
-	{
-		for (DebugWireCapsule*& shape : g_debugWireCapsule)
-		{
-			if (shape == nullptr)
-				continue;
-			if (shape->mode != renderingMode)
-				continue;
-
-			if (shape->remain == -1.f || shape->remain > 0.f)
-			{
-				float fraction = Clamp( (shape->duration - shape->remain) / shape->duration, 0.f, 1.f );
-				Rgba8 startColor = shape->startColor;
-				Rgba8 endColor = shape->endColor;
-				Rgba8 color(
-					static_cast<unsigned char>((int)startColor.r + (int)(((float)endColor.r - (float)startColor.r) * fraction)),
-					static_cast<unsigned char>((int)startColor.g + (int)(((float)endColor.g - (float)startColor.g) * fraction)),
-					static_cast<unsigned char>((int)startColor.b + (int)(((float)endColor.b - (float)startColor.b) * fraction)),
-					static_cast<unsigned char>((int)startColor.a + (int)(((float)endColor.a - (float)startColor.a) * fraction))
-				);
-				switch (renderingMode)
-				{
-				case DebugRenderMode::ALWAYS:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::USE_DEPTH:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::NUL:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::X_RAY:
-				{
-					Rgba8 tColor = color;
-					tColor.a = 45;
-					g_config.m_renderer->SetModelConstants( Mat44(), tColor );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::OPAQUE );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				}
-				g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-				shape->remain -= deltaSeconds;
-			}
-			else if (shape->duration != -1.f && shape->remain <= 0)
-			{
-				delete shape;
-				shape = nullptr;
-			}
-		}
-	}
-
-	{
-		for (DebugSolidBox*& shape : g_debugSolidBox)
-		{
-			if (shape == nullptr)
-				continue;
-			if (shape->mode != renderingMode)
-				continue;
-
-			if (shape->duration == -1.f || shape->remain > 0.f)
-			{
-				float fraction = Clamp( (shape->duration - shape->remain) / shape->duration, 0.f, 1.f );
-				Rgba8 startColor = shape->startColor;
-				Rgba8 endColor = shape->endColor;
-				Rgba8 color(
-					static_cast<unsigned char>((int)startColor.r + (int)(((float)endColor.r - (float)startColor.r) * fraction)),
-					static_cast<unsigned char>((int)startColor.g + (int)(((float)endColor.g - (float)startColor.g) * fraction)),
-					static_cast<unsigned char>((int)startColor.b + (int)(((float)endColor.b - (float)startColor.b) * fraction)),
-					static_cast<unsigned char>((int)startColor.a + (int)(((float)endColor.a - (float)startColor.a) * fraction))
-				);
-				switch (renderingMode)
-				{
-				case DebugRenderMode::ALWAYS:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::USE_DEPTH:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::NUL:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::X_RAY:
-				{
-					Rgba8 tColor = color;
-					tColor.a = 45;
-					g_config.m_renderer->SetModelConstants( Mat44(), tColor );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::OPAQUE );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				}
-				shape->remain -= deltaSeconds;
-			}
-			else if (shape->duration != -1.f && shape->remain <= 0)
-			{
-				delete shape;
-				shape = nullptr;
-			}
-		}
-	}
-
-	{
-		for (DebugWireBox*& shape : g_debugWireBox)
-		{
-			if (shape == nullptr)
-				continue;
-			if (shape->mode != renderingMode)
-				continue;
-
-			if (shape->remain == -1.f || shape->remain > 0.f)
-			{
-				float fraction = Clamp( (shape->duration - shape->remain) / shape->duration, 0.f, 1.f );
-				Rgba8 startColor = shape->startColor;
-				Rgba8 endColor = shape->endColor;
-				Rgba8 color(
-					static_cast<unsigned char>((int)startColor.r + (int)(((float)endColor.r - (float)startColor.r) * fraction)),
-					static_cast<unsigned char>((int)startColor.g + (int)(((float)endColor.g - (float)startColor.g) * fraction)),
-					static_cast<unsigned char>((int)startColor.b + (int)(((float)endColor.b - (float)startColor.b) * fraction)),
-					static_cast<unsigned char>((int)startColor.a + (int)(((float)endColor.a - (float)startColor.a) * fraction))
-				);
-				switch (renderingMode)
-				{
-				case DebugRenderMode::ALWAYS:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::USE_DEPTH:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::NUL:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::X_RAY:
-				{
-					Rgba8 tColor = color;
-					tColor.a = 45;
-					g_config.m_renderer->SetModelConstants( Mat44(), tColor );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::OPAQUE );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::WIREFRAME_CULL_NONE );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				}
-				g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-				shape->remain -= deltaSeconds;
-			}
-			else if (shape->duration != -1.f && shape->remain <= 0)
-			{
-				delete shape;
-				shape = nullptr;
-			}
-		}
-	}
-
-	{
-		for (DebugArrow*& shape : g_debugArrow)
-		{
-			if (shape == nullptr)
-				continue;
-			if (shape->mode != renderingMode)
-				continue;
-
-			if (shape->duration == -1.f || shape->remain > 0.f)
-			{
-				float fraction = Clamp( (shape->duration - shape->remain) / shape->duration, 0.f, 1.f );
-				Rgba8 startColor = shape->startColor;
-				Rgba8 endColor = shape->endColor;
-				Rgba8 color(
-					static_cast<unsigned char>((int)startColor.r + (int)(((float)endColor.r - (float)startColor.r) * fraction)),
-					static_cast<unsigned char>((int)startColor.g + (int)(((float)endColor.g - (float)startColor.g) * fraction)),
-					static_cast<unsigned char>((int)startColor.b + (int)(((float)endColor.b - (float)startColor.b) * fraction)),
-					static_cast<unsigned char>((int)startColor.a + (int)(((float)endColor.a - (float)startColor.a) * fraction))
-				);
-				switch (renderingMode)
-				{
-				case DebugRenderMode::ALWAYS:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::USE_DEPTH:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::NUL:
-				{
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::X_RAY:
-				{
-					Rgba8 tColor = color;
-					tColor.a = 45;
-					g_config.m_renderer->SetModelConstants( Mat44(), tColor );
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-
-					g_config.m_renderer->SetModelConstants( Mat44(), color );
-					g_config.m_renderer->SetBlendMode( BlendMode::OPAQUE );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				}
-				shape->remain -= deltaSeconds;
-			}
-			else if (shape->duration != -1.f && shape->remain <= 0)
-			{
-				delete shape;
-				shape = nullptr;
-			}
-		}
-	}
-
-	{
-		BitmapFont* font = g_config.m_renderer->CreateOrGetBitmapFont( "Data/Fonts/SquirrelFixedFont.png" );
-		for (DebugWorldText*& shape : g_debugWorldText)
-		{
-			if (shape == nullptr)
-				continue;
-			if (renderingMode != DebugRenderMode::NUL)
-				continue;
-
-			if (shape->duration == -1.f || shape->remain > 0.f)
-			{
-				float fraction = Clamp( (shape->duration - shape->remain) / shape->duration, 0.f, 1.f );
-				Rgba8 startColor = shape->startColor;
-				Rgba8 endColor = shape->endColor;
-				Rgba8 color(
-					static_cast<unsigned char>((int)startColor.r + (int)(((float)endColor.r - (float)startColor.r) * fraction)),
-					static_cast<unsigned char>((int)startColor.g + (int)(((float)endColor.g - (float)startColor.g) * fraction)),
-					static_cast<unsigned char>((int)startColor.b + (int)(((float)endColor.b - (float)startColor.b) * fraction)),
-					static_cast<unsigned char>((int)startColor.a + (int)(((float)endColor.a - (float)startColor.a) * fraction))
-				);
-				g_config.m_renderer->SetModelConstants( Mat44(), color );
-				g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-				g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-				g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_NONE );
-				g_config.m_renderer->BindTexture( &font->GetTexture() );
-				g_config.m_renderer->DrawVertexArray( shape->verts );
-				shape->remain -= deltaSeconds;
-				g_config.m_renderer->BindTexture( nullptr );
-			}
-			else if (shape->duration != -1.f && shape->remain <= 0)
-			{
-				delete shape;
-				shape = nullptr;
-			}
-		}
-	}
-	
-	{
-		BitmapFont* font = g_config.m_renderer->CreateOrGetBitmapFont( "Data/Fonts/SquirrelFixedFont.png" );
-		for (DebugBillboardText*& shape : g_debugBillboardText)
-		{
-			if (shape == nullptr)
-				continue;
-			if (renderingMode != DebugRenderMode::NUL)
-				continue;
-
-			if (shape->duration == -1.f || shape->remain > 0.f)
-			{
-				float fraction = Clamp( (shape->duration - shape->remain) / shape->duration, 0.f, 1.f );
-				Rgba8 startColor = shape->startColor;
-				Rgba8 endColor = shape->endColor;
-				Rgba8 color(
-					static_cast<unsigned char>((int)startColor.r + (int)(((float)endColor.r - (float)startColor.r) * fraction)),
-					static_cast<unsigned char>((int)startColor.g + (int)(((float)endColor.g - (float)startColor.g) * fraction)),
-					static_cast<unsigned char>((int)startColor.b + (int)(((float)endColor.b - (float)startColor.b) * fraction)),
-					static_cast<unsigned char>((int)startColor.a + (int)(((float)endColor.a - (float)startColor.a) * fraction))
-				);
-				Mat44 tranform = GetBillboardMatrix( g_billBoardType, g_playerCamera->GetTransformMatrix(), shape->origin, Vec2::ONE );
-				
-				g_config.m_renderer->SetModelConstants( tranform, color );
-				g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-				g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-				g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_NONE );
-				g_config.m_renderer->BindTexture( &font->GetTexture() );
-				g_config.m_renderer->DrawVertexArray( shape->verts );
-				shape->remain -= deltaSeconds;
-				g_config.m_renderer->BindTexture( nullptr );
-			}
-			else if (shape->duration != -1.f && shape->remain <= 0)
-			{
-				delete shape;
-				shape = nullptr;
-			}
-		}
-	}
-
-	{
-		for (DebugWorldBasis*& shape : g_debugWorldBasis)
-		{
-			if (shape == nullptr)
-				continue;
-			if (shape->mode != renderingMode)
-				continue;
-
-			if (shape->duration == -1.f || shape->remain > 0.f)
-			{
-				switch (renderingMode)
-				{
-				case DebugRenderMode::ALWAYS:
-				{
-					g_config.m_renderer->SetModelConstants();
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::USE_DEPTH:
-				{
-					g_config.m_renderer->SetModelConstants();
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::NUL:
-				{
-					g_config.m_renderer->SetModelConstants();
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				case DebugRenderMode::X_RAY:
-				{
-					std::vector<Vertex_PCU> tVerts = shape->verts;
-					for (Vertex_PCU& vert : tVerts)
-					{
-						vert.m_color.a = 45;
-					}
-					g_config.m_renderer->SetModelConstants();
-					g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-					g_config.m_renderer->SetDepthMode( DepthMode::DISABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( tVerts );
-
-					g_config.m_renderer->SetModelConstants();
-					g_config.m_renderer->SetBlendMode( BlendMode::OPAQUE );
-					g_config.m_renderer->SetDepthMode( DepthMode::ENABLED );
-					g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_BACK );
-					g_config.m_renderer->BindTexture( nullptr );
-					g_config.m_renderer->DrawVertexArray( shape->verts );
-					break;
-				}
-				}
-				shape->remain -= deltaSeconds;
-			}
-			else if (shape->duration != -1.f && shape->remain <= 0)
-			{
-				delete shape;
-				shape = nullptr;
-			}
-		}
-	}
-
-	g_config.m_renderer->EndCamera( camera );
-
-	debugWorldMutex.unlock();
-}
-
-void DebugRenderScreen( Camera const& camera )
-{
-	if (g_debugRenderVisible == false)
-		return;
-
-	debugScreenMutex.lock();
-
-	float deltaSeconds = Clock::s_systemClock.GetDeltaSeconds();
-	BitmapFont* font = g_config.m_renderer->CreateOrGetBitmapFont( "Data/Fonts/SquirrelFixedFont.png" );
-	g_config.m_renderer->BeginCamera( camera );
-
-	{
-		std::vector<Vertex_PCU> verts;
-		int counter = 0;
-		for (DebugScreenText*& shape : g_debugScreenText)
-		{
-			if (shape == nullptr)
-				continue;
-
-			if (shape->duration == -1.f)
-			{
-				float boxWidth = static_cast<float>(shape->text.length()) * shape->size * 0.7f;
-				float boxHeight = shape->size;
-				Vec2 pivot = shape->position - Vec2( boxWidth * (1.f - shape->alignment.x), boxHeight * (1.f - shape->alignment.y) ) - Vec2( 0.f, counter * boxHeight );
-				font->AddVertsForText2D( verts, pivot, shape->size, shape->text, shape->startColor, 0.7f );
-			}
-			else if (shape->remain >= 0.f)
-			{
-				float fraction = Clamp( (shape->duration - shape->remain) / shape->duration, 0.f, 1.f );
-				Rgba8 startColor = shape->startColor;
-				Rgba8 endColor = shape->endColor;
-				Rgba8 color(
-					static_cast<unsigned char>((int)startColor.r + (int)(((float)endColor.r - (float)startColor.r) * fraction)),
-					static_cast<unsigned char>((int)startColor.g + (int)(((float)endColor.g - (float)startColor.g) * fraction)),
-					static_cast<unsigned char>((int)startColor.b + (int)(((float)endColor.b - (float)startColor.b) * fraction)),
-					static_cast<unsigned char>((int)startColor.a + (int)(((float)endColor.a - (float)startColor.a) * fraction))
-				);
-				float boxWidth = static_cast<float>(shape->text.length()) * shape->size * 0.7f;
-				float boxHeight = shape->size;
-				Vec2 pivot = shape->position - Vec2( boxWidth * (1.f - shape->alignment.x), boxHeight * (1.f - shape->alignment.y) ) - Vec2( 0.f, counter * boxHeight );
-				font->AddVertsForText2D( verts, pivot, shape->size, shape->text, shape->startColor, 0.7f );
-			}
-			else
-			{
-				delete shape;
-				shape = nullptr;
-				continue;
-			}
-			shape->remain -= deltaSeconds;
-			counter++;
-		}
-		g_config.m_renderer->SetModelConstants();
-		g_config.m_renderer->SetLightingConstants( Vec3( 2.f, 1.f, -1.f ).GetNormalized(), 1.f, 1.f );
-		g_config.m_renderer->SetBlendMode( BlendMode::ALPHA );
-		g_config.m_renderer->SetRasterizerState( RasterizerMode::SOLID_CULL_NONE );
-		g_config.m_renderer->BindTexture( &font->GetTexture() );
-		g_config.m_renderer->DrawVertexArray( verts );
-	}
-
-	{
-		std::vector<Vertex_PCU> verts;
-		int counter = 0;
-		for (DebugMessage*& shape : g_debugMessage)
-		{
-			if (shape == nullptr)
-				continue;
-
-			float height = 20.f;
-
-			if (shape->duration == -1.f)
-			{
-				//float boxWidth = static_cast<float>(shape->text.length()) * height * 0.7f;
-				float boxHeight = height;
-				Vec2 pivot = Vec2(0.f, camera.GetBounds().m_maxs.y - camera.GetBounds().m_mins.y) - Vec2( 0.f, boxHeight ) - Vec2( 0.f, counter * boxHeight );
-				font->AddVertsForText2D( verts, pivot, height, shape->text, shape->startColor, 0.7f );
-			}
-			else if (shape->remain >= 0.f)
+			float height = 20.f;
+
+			if (shape->duration == -1.f)
+			{
+				//float boxWidth = static_cast<float>(shape->text.length()) * height * 0.7f;
+				float boxHeight = height;
+				Vec2 pivot = Vec2(0.f, camera.GetBounds().m_maxs.y - camera.GetBounds().m_mins.y) - Vec2( 0.f, boxHeight ) - Vec2( 0.f, counter * boxHeight );
+				font->AddVertsForText2D( verts, pivot, height, shape->text, shape->startColor, 0.7f );
+			}
+			else if (shape->remain >= 0.f)
 			{
 				float fraction = Clamp( (shape->duration - shape->remain) / shape->duration, 0.f, 1.f );
 				Rgba8 startColor = shape->startColor;
@@ -1465,75 +898,31 @@ void DebugRenderEndFrame()
 
 void DebugAddWorldPoint( Vec3 const& pos, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor, DebugRenderMode mode )
 {
-	DebugPoint* newPoint = new DebugPoint{ pos, radius, duration, duration, startColor, endColor, mode };
-	newPoint->verts.reserve( 1000 );
-	AddVertsForSphere3D( newPoint->verts, pos, radius, Rgba8::WHITE, AABB2::ZERO_TO_ONE, 16, 8 );
-	for (DebugPoint*& shape : g_debugPoint)
-	{
-		if (shape == nullptr)
-		{
-			shape = newPoint;
-			return;
-		}
-	}
-	debugWorldMutex.lock();
-	g_debugPoint.push_back( newPoint );
-	debugWorldMutex.unlock();
+	DebugPoint* newPoint = new DebugPoint{ pos, radius, duration, duration, startColor, endColor, mode, DebugMeshInstances() };
+	newPoint->meshes.Add( DebugPrimitive::SPHERE, GetDebugSphereTransform( pos, radius ), 16, 8 );
+	QueueDebugShape( newPoint, g_debugPoint );
 }
 
 void DebugAddWorldLine( Vec3 const& start, Vec3 const& end, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor, DebugRenderMode mode )
 {
-	DebugLine* newLine = new DebugLine{ start, end, radius, duration, duration, startColor, endColor, mode };
-	newLine->verts.reserve( 200 );
-	AddVertsForCylinder3D( newLine->verts, start, end, radius, Rgba8::WHITE, AABB2::ZERO_TO_ONE, 16 );
-	for (DebugLine*& shape : g_debugLine)
-	{
-		if (shape == nullptr)
-		{
-			shape = newLine;
-			return;
-		}
-	}
-	debugWorldMutex.lock();
-	g_debugLine.push_back( newLine );
-	debugWorldMutex.unlock();
+	DebugLine* newLine = new DebugLine{ start, end, radius, duration, duration, startColor, endColor, mode, DebugMeshInstances() };
+	newLine->meshes.Add( DebugPrimitive::CYLINDER, GetDebugPrimitiveTransform( start, end, radius ), 16 );
+	QueueDebugShape( newLine, g_debugLine );
 }
 
 void DebugAddWorldWireCylinder( bool isWired, Vec3 const& base, Vec3 const& top, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor, DebugRenderMode mode )
 {
 	if (isWired)
 	{
-		DebugWireCylinder* newWireCylinder = new DebugWireCylinder{ base, top, radius, duration, duration, startColor, endColor, mode };
-		newWireCylinder->verts.reserve( 200 );
-		AddVertsForCylinder3D( newWireCylinder->verts, base, top, radius, Rgba8::WHITE, AABB2::ZERO_TO_ONE, 16 );
-		for (DebugWireCylinder*& shape : g_debugWireCylinder)
-		{
-			if (shape == nullptr)
-			{
-				shape = newWireCylinder;
-				return;
-			}
-		}
-		debugWorldMutex.lock();
-		g_debugWireCylinder.push_back( newWireCylinder );
-		debugWorldMutex.unlock();
+		DebugWireCylinder* newWireCylinder = new DebugWireCylinder{ base, top, radius, duration, duration, startColor, endColor, mode, DebugMeshInstances() };
+		newWireCylinder->meshes.Add( DebugPrimitive::CYLINDER, GetDebugPrimitiveTransform( base, top, radius ), 16 );
+		QueueDebugShape( newWireCylinder, g_debugWireCylinder );
 	}
 	else
 	{
-		DebugSolidCylinder* newSolidCylinder = new DebugSolidCylinder{ base, top, radius, duration, duration, startColor, endColor, mode };
-		newSolidCylinder->verts.reserve( 200 );
-		AddVertsForCylinder3D( newSolidCylinder->verts, base, top, radius, Rgba8::WHITE, AABB2::ZERO_TO_ONE, 16 );
-		for (DebugSolidCylinder*& shape : g_debugSolidCylinder)
-		{
-			if (shape == nullptr)
-			{
-				shape = newSolidCylinder;
-				return;
-			}
-		}
-		debugWorldMutex.lock();
-		g_debugSolidCylinder.push_back( newSolidCylinder );
-		debugWorldMutex.unlock();
+		DebugSolidCylinder* newSolidCylinder = new DebugSolidCylinder{ base, top, radius, duration, duration, startColor, endColor, mode, DebugMeshInstances() };
+		newSolidCylinder->meshes.Add( DebugPrimitive::CYLINDER, GetDebugPrimitiveTransform( base, top, radius ), 16 );
+		QueueDebugShape( newSolidCylinder, g_debugSolidCylinder );
 	}
 }
 
@@ -1541,37 +930,15 @@ void DebugAddWorldWireSphere( bool isWired, Vec3 const& center, float radius, fl
 {
 	if (isWired)
 	{
-		DebugWireSphere* newWireSphere = new DebugWireSphere{ center, radius, duration, duration, startColor, endColor, mode };
-		newWireSphere->verts.reserve( 1000 );
-		AddVertsForSphere3D( newWireSphere->verts, center, radius, Rgba8::WHITE, AABB2::ZERO_TO_ONE, 8, 4 );
-		for (DebugWireSphere*& shape : g_debugWireSphere)
-		{
-			if (shape == nullptr)
-			{
-				shape = newWireSphere;
-				return;
-			}
-		}
-		debugWorldMutex.lock();
-		g_debugWireSphere.push_back( newWireSphere );
-		debugWorldMutex.unlock();
+		DebugWireSphere* newWireSphere = new DebugWireSphere{ center, radius, duration, duration, startColor, endColor, mode, DebugMeshInstances() };
+		newWireSphere->meshes.Add( DebugPrimitive::SPHERE, GetDebugSphereTransform( center, radius ), 8, 4 );
+		QueueDebugShape( newWireSphere, g_debugWireSphere );
 	}
 	else
 	{
-		DebugSolidSphere* newSolidSphere = new DebugSolidSphere{ center, radius, duration, duration, startColor, endColor, mode };
-		newSolidSphere->verts.reserve( 1000 );
-		AddVertsForSphere3D( newSolidSphere->verts, center, radius, Rgba8::WHITE, AABB2::ZERO_TO_ONE, 8, 4 );
-		for (DebugSolidSphere*& shape : g_debugSolidSphere)
-		{
-			if (shape == nullptr)
-			{
-				shape = newSolidSphere;
-				return;
-			}
-		}
-		debugWorldMutex.lock();
-		g_debugSolidSphere.push_back( newSolidSphere );
-		debugWorldMutex.unlock();
+		DebugSolidSphere* newSolidSphere = new DebugSolidSphere{ center, radius, duration, duration, startColor, endColor, mode, DebugMeshInstances() };
+		newSolidSphere->meshes.Add( DebugPrimitive::SPHERE, GetDebugSphereTransform( center, radius ), 8, 4 );
+		QueueDebugShape( newSolidSphere, g_debugSolidSphere );
 	}
 }
 
@@ -1580,50 +947,26 @@ void DebugAddWorldWireCapsule( bool isWired, Vec3 const& base, Vec3 const& top,
 	if (isWired)
 	{
 		// Create a new wireframe capsule
-		DebugWireCapsule* newWireCapsule = new DebugWireCapsule{ base, top, radius, duration, duration, startColor, endColor, mode };
-		newWireCapsule->verts.reserve( 200 );
-
-		// Add the vertices for the capsule's wireframe (similar to capsule)
-		AddVertsForCapsule3D( newWireCapsule->verts, base, top, radius, Rgba8::WHITE, AABB2::ZERO_TO_ONE, 8 );
+		DebugWireCapsule* newWireCapsule = new DebugWireCapsule{ base, top, radius, duration, duration, startColor, endColor, mode, DebugMeshInstances() };
 
-		// Look for the first empty slot in the global debug capsule list
-		for (DebugWireCapsule*& shape : g_debugWireCapsule)
-		{
-			if (shape == nullptr)
-			{
-				shape = newWireCapsule;
-				return;
-			}
-		}
+		// Same pieces AddVertsForCapsule3D builds, a cylinder and a sphere on each end
+		newWireCapsule->meshes.Add( DebugPrimitive::CYLINDER, GetDebugPrimitiveTransform( base, top, radius ), 8 );
+		newWireCapsule->meshes.Add( DebugPrimitive::SPHERE, GetDebugSphereTransform( base, radius ), 8, 4 );
+		newWireCapsule->meshes.Add( DebugPrimitive::SPHERE, GetDebugSphereTransform( top, radius ), 8, 4 );
 
-		// Lock the mutex and push the new capsule into the global list
-		debugWorldMutex.lock();
-		g_debugWireCapsule.push_back( newWireCapsule );
-		debugWorldMutex.unlock();
+		QueueDebugShape( newWireCapsule, g_debugWireCapsule );
 	}
 	else
 	{
 		// Create a new solid capsule
-		DebugSolidCapsule* newSolidCapsule = new DebugSolidCapsule{ base, top, radius, duration, duration, startColor, endColor, mode };
-		newSolidCapsule->verts.reserve( 200 );
+		DebugSolidCapsule* newSolidCapsule = new DebugSolidCapsule{ base, top, radius, duration, duration, startColor, endColor, mode, DebugMeshInstances() };
 
-		// Add the vertices for the capsule (solid)
-		AddVertsForCapsule3D( newSolidCapsule->verts, base, top, radius, Rgba8::WHITE, AABB2::ZERO_TO_ONE, 8 );
-
-		// Look for the first empty slot in the global solid capsule list
-		for (DebugSolidCapsule*& shape : g_debugSolidCapsule)
-		{
-			if (shape == nullptr)
-			{
-				shape = newSolidCapsule;
-				return;
-			}
-		}
+		// Same pieces AddVertsForCapsule3D builds, a cylinder and a sphere on each end
+		newSolidCapsule->meshes.Add( DebugPrimitive::CYLINDER, GetDebugPrimitiveTransform( base, top, radius ), 8 );
+		newSolidCapsule->meshes.Add( DebugPrimitive::SPHERE, GetDebugSphereTransform( base, radius ), 8, 4 );
+		newSolidCapsule->meshes.Add( DebugPrimitive::SPHERE, GetDebugSphereTransform( top, radius ), 8, 4 );
 
-		// Lock the mutex and push the new capsule into the global list
-		debugWorldMutex.lock();
-		g_debugSolidCapsule.push_back( newSolidCapsule );
-		debugWorldMutex.unlock();
+		QueueDebugShape( newSolidCapsule, g_debugSolidCapsule );
 	}
 }
 
@@ -1632,167 +975,75 @@ void DebugAddWorldWireBox( bool isWired, OBB3 const& bound, float duration, Rgba
 	if (isWired)
 	{
 		// Create a new wireframe box
-		DebugWireBox* newWireBox = new DebugWireBox{ bound, duration, duration, startColor, endColor, mode };
-		newWireBox->verts.reserve( 200 );
+		DebugWireBox* newWireBox = new DebugWireBox{ bound, duration, duration, startColor, endColor, mode, DebugMeshInstances() };
 
-		// Add the vertices for the box's wireframe (similar to box)
-		AddVertsForOBB3D( newWireBox->verts, bound, Rgba8::WHITE, AABB2::ZERO_TO_ONE );
+		// Unit box scaled by the half dimensions along the box basis
+		newWireBox->meshes.Add( DebugPrimitive::BOX, GetDebugBoxTransform( bound ) );
 
-		// Look for the first empty slot in the global debug box list
-		for (DebugWireBox*& shape : g_debugWireBox)
-		{
-			if (shape == nullptr)
-			{
-				shape = newWireBox;
-				return;
-			}
-		}
-
-		// Lock the mutex and push the new box into the global list
-		debugWorldMutex.lock();
-		g_debugWireBox.push_back( newWireBox );
-		debugWorldMutex.unlock();
+		QueueDebugShape( newWireBox, g_debugWireBox );
 	}
 	else
 	{
 		// Create a new solid box
-		DebugSolidBox* newSolidBox = new DebugSolidBox{ bound, duration, duration, startColor, endColor, mode };
-		newSolidBox->verts.reserve( 200 );
+		DebugSolidBox* newSolidBox = new DebugSolidBox{ bound, duration, duration, startColor, endColor, mode, DebugMeshInstances() };
 
-		// Add the vertices for the box (solid)
-		AddVertsForOBB3D( newSolidBox->verts, bound, Rgba8::WHITE, AABB2::ZERO_TO_ONE );
+		// Unit box scaled by the half dimensions along the box basis
+		newSolidBox->meshes.Add( DebugPrimitive::BOX, GetDebugBoxTransform( bound ) );
 
-		// Look for the first empty slot in the global solid box list
-		for (DebugSolidBox*& shape : g_debugSolidBox)
-		{
-			if (shape == nullptr)
-			{
-				shape = newSolidBox;
-				return;
-			}
-		}
-
-		// Lock the mutex and push the new box into the global list
-		debugWorldMutex.lock();
-		g_debugSolidBox.push_back( newSolidBox );
-		debugWorldMutex.unlock();
+		QueueDebugShape( newSolidBox, g_debugSolidBox );
 	}
 }
 
 void DebugAddWorldArrow( Vec3 const& start, Vec3 const& end, float radius, float duration, Rgba8 const& startColor, Rgba8 const& endColor, DebugRenderMode mode )
 {
-	DebugArrow* newArrow = new DebugArrow{ start, end, radius, duration, duration, startColor, endColor, mode };
-	newArrow->verts.reserve( 400 );
+	DebugArrow* newArrow = new DebugArrow{ start, end, radius, duration, duration, startColor, endColor, mode, DebugMeshInstances() };
 	Vec3 coneStart = end - (end - start) * 0.3f;
-	AddVertsForCone3D( newArrow->verts, coneStart, end, radius * 2.f, Rgba8::WHITE, AABB2::ZERO_TO_ONE, 16 );
-	AddVertsForCylinder3D( newArrow->verts, start, coneStart, radius, Rgba8::WHITE, AABB2::ZERO_TO_ONE, 16 );
-	for (DebugArrow*& shape : g_debugArrow)
-	{
-		if (shape == nullptr)
-		{
-			shape = newArrow;
-			return;
-		}
-	}
-	debugWorldMutex.lock();
-	g_debugArrow.push_back( newArrow );
-	debugWorldMutex.unlock();
+	newArrow->meshes.Add( DebugPrimitive::CONE, GetDebugPrimitiveTransform( coneStart, end, radius * 2.f ), 16 );
+	newArrow->meshes.Add( DebugPrimitive::CYLINDER, GetDebugPrimitiveTransform( start, coneStart, radius ), 16 );
+	QueueDebugShape( newArrow, g_debugArrow );
 }
 
 void DebugAddWorldText( std::string const& text, Mat44 const& transform, float textHeight, Vec2 const& alignment, float duration, Rgba8 const& startColor, Rgba8 const& endColor )
 {
 	DebugWorldText* newWorldText = new DebugWorldText{ text, transform, textHeight, alignment, duration, duration, startColor, endColor };
 	newWorldText->verts.reserve( text.size() * 6 );
-	BitmapFont* font = g_config.m_renderer->CreateOrGetBitmapFont( "Data/Fonts/SquirrelFixedFont.png" );
-	font->AddvertsForText3DAtOriginXForward( newWorldText->verts, textHeight, text, startColor, 0.7f, alignment );
+	g_debugFont->AddvertsForText3DAtOriginXForward( newWorldText->verts, textHeight, text, startColor, 0.7f, alignment );
 	TransformVertexArray3D( newWorldText->verts, transform );
-	for (DebugWorldText*& shape : g_debugWorldText)
-	{
-		if (shape == nullptr)
-		{
-			shape = newWorldText;
-			return;
-		}
-	}
-	debugWorldMutex.lock();
-	g_debugWorldText.push_back( newWorldText );
-	debugWorldMutex.unlock();
+	QueueDebugShape( newWorldText, g_debugWorldText );
 }
 
 void DebugAddWorldBillboardText( std::string const& text, Vec3 const& origin, float textHeight, Vec2 const& alignment, float duration, Rgba8 const& startColor, Rgba8 const& endColor )
 {
 	DebugBillboardText* newBillboardText = new DebugBillboardText{ text, origin, textHeight, alignment, duration, duration, startColor, endColor };
 	newBillboardText->verts.reserve( text.size() * 6 );
-	BitmapFont* font = g_config.m_renderer->CreateOrGetBitmapFont( "Data/Fonts/SquirrelFixedFont.png" );
-	font->AddvertsForText3DAtOriginXForward( newBillboardText->verts, textHeight, text, startColor, 0.7f, alignment );
-	for (DebugBillboardText*& shape : g_debugBillboardText)
-	{
-		if (shape == nullptr)
-		{
-			shape = newBillboardText;
-			return;
-		}
-	}
-	debugWorldMutex.lock();
-	g_debugBillboardText.push_back( newBillboardText );
-	debugWorldMutex.unlock();
+	g_debugFont->AddvertsForText3DAtOriginXForward( newBillboardText->verts, textHeight, text, startColor, 0.7f, alignment );
+	QueueDebugShape( newBillboardText, g_debugBillboardText );
 }
 
 void DebugAddWorldBasis( Mat44 const& transform, float duration, DebugRenderMode mode )
 {
-	DebugWorldBasis* newWorldBasis = new DebugWorldBasis{ transform, duration, duration, mode };
-	newWorldBasis->verts.reserve( 1200 );
+	DebugWorldBasis* newWorldBasis = new DebugWorldBasis{ transform, duration, duration, mode, DebugMeshInstances() };
 	Mat44 mat = transform;
 	Vec3 origin = mat.GetTranslation3D();
-	AddVertsForCylinder3D( newWorldBasis->verts, origin, origin + mat.GetIBasis3D() * 0.7f, 0.12f, Rgba8::RED, AABB2::ZERO_TO_ONE, 16 );
-	AddVertsForCone3D( newWorldBasis->verts, origin + mat.GetIBasis3D() * 0.7f, origin + mat.GetIBasis3D(), 0.2f, Rgba8::RED, AABB2::ZERO_TO_ONE, 16 );
-	AddVertsForCylinder3D( newWorldBasis->verts, origin, origin + mat.GetJBasis3D() * 0.7f, 0.12f, Rgba8::GREEN, AABB2::ZERO_TO_ONE, 16 );
-	AddVertsForCone3D( newWorldBasis->verts, origin + mat.GetJBasis3D() * 0.7f, origin + mat.GetJBasis3D(), 0.2f, Rgba8::GREEN, AABB2::ZERO_TO_ONE, 16 );
-	AddVertsForCylinder3D( newWorldBasis->verts, origin, origin + mat.GetKBasis3D() * 0.7f, 0.12f, Rgba8::BLUE, AABB2::ZERO_TO_ONE, 16 );
-	AddVertsForCone3D( newWorldBasis->verts, origin + mat.GetKBasis3D() * 0.7f, origin + mat.GetKBasis3D(), 0.2f, Rgba8::BLUE, AABB2::ZERO_TO_ONE, 16 );
-	for (DebugWorldBasis*& shape : g_debugWorldBasis)
-	{
-		if (shape == nullptr)
-		{
-			shape = newWorldBasis;
-			return;
-		}
-	}
-	debugWorldMutex.lock();
-	g_debugWorldBasis.push_back( newWorldBasis );
-	debugWorldMutex.unlock();
+	newWorldBasis->meshes.Add( DebugPrimitive::CYLINDER, GetDebugPrimitiveTransform( origin, origin + mat.GetIBasis3D() * 0.7f, 0.12f ), 16, 0, Rgba8::RED );
+	newWorldBasis->meshes.Add( DebugPrimitive::CONE, GetDebugPrimitiveTransform( origin + mat.GetIBasis3D() * 0.7f, origin + mat.GetIBasis3D(), 0.2f ), 16, 0, Rgba8::RED );
+	newWorldBasis->meshes.Add( DebugPrimitive::CYLINDER, GetDebugPrimitiveTransform( origin, origin + mat.GetJBasis3D() * 0.7f, 0.12f ), 16, 0, Rgba8::GREEN );
+	newWorldBasis->meshes.Add( DebugPrimitive::CONE, GetDebugPrimitiveTransform( origin + mat.GetJBasis3D() * 0.7f, origin + mat.GetJBasis3D(), 0.2f ), 16, 0, Rgba8::GREEN );
+	newWorldBasis->meshes.Add( DebugPrimitive::CYLINDER, GetDebugPrimitiveTransform( origin, origin + mat.GetKBasis3D() * 0.7f, 0.12f ), 16, 0, Rgba8::BLUE );
+	newWorldBasis->meshes.Add( DebugPrimitive::CONE, GetDebugPrimitiveTransform( origin + mat.GetKBasis3D() * 0.7f, origin + mat.GetKBasis3D(), 0.2f ), 16, 0, Rgba8::BLUE );
+	QueueDebugShape( newWorldBasis, g_debugWorldBasis );
 }
 
 void DebugAddScreenText( std::string const& text, Vec2 const& position, float size, Vec2 const& alignment, float duration, Rgba8 const& startColor, Rgba8 const& endColor )
 {
 	DebugScreenText* newScreenText = new DebugScreenText{ text, position, size, alignment, duration, duration, startColor, endColor };
-// 	for (DebugScreenText*& shape : g_debugScreenText)
-// 	{
-// 		if (shape == nullptr)
-// 		{
-// 			shape = newScreenText;
-// 			return;
-// 		}
-// 	}
-	debugScreenMutex.lock();
-	g_debugScreenText.push_back( newScreenText );
-	debugScreenMutex.unlock();
+	QueueDebugShape( newScreenText, g_debugScreenText );
 }
 
 void DebugAddMessage( std::string const& text, float duration, Rgba8 const& startColor, Rgba8 const& endColor )
 {
 	DebugMessage* newDebugMessage = new DebugMessage{ text, duration, duration, startColor, endColor };
-// 	for (DebugMessage*& shape : g_debugMessage)
-// 	{
-// 		if (shape == nullptr)
-// 		{
-// 			shape = newDebugMessage;
-// 			return;
-// 		}
-// 	}
-	debugScreenMutex.lock();
-	g_debugMessage.push_back( newDebugMessage );
-	debugScreenMutex.unlock();
+	QueueDebugShape( newDebugMessage, g_debugMessage );
 }
 
 bool Command_DebugRenderClear()
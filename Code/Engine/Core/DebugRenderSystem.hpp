@@ -38,6 +38,7 @@ void DebugRenderWorld( Camera const& camera, DebugRenderMode renderingMode );
 void DebugRenderScreen( Camera const& camera );
 void DebugRenderEndFrame();
 
+// DebugAdd* can be called from any thread without locking, shapes are picked up by the next DebugRenderBeginFrame or DebugRender* call
 void DebugAddWorldPoint( Vec3 const& pos,
 	float radius, float duration,
 	Rgba8 const& startColor = Rgba8::WHITE,
@@ -589,3 +589,12 @@ bool DevConsoleFunctionKey( unsigned int param )
 	}
 	return true;
 }
+
+void PrintBenchmarkLine( std::string const& line )
+{
+	DebuggerPrintf( (line + "\n").c_str() );
+	if (g_devConsole)
+	{
+		g_devConsole->AddLine( DevConsole::INFOMSG_MINOR, line );
+	}
+}
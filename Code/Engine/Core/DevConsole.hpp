@@ -99,4 +99,6 @@ bool PrintAllCommand();
 bool ClearScreen();
 bool PrintHistory();
 bool DevConsoleFunctionKey( unsigned int param );
-bool DevConsoleLiteralKey( unsigned int param );
\ No newline at end of file
+bool DevConsoleLiteralKey( unsigned int param );
+// Debugger output plus a minor console line once the console exists, shared by the benchmark commands
+void PrintBenchmarkLine( std::string const& line );
\ No newline at end of file
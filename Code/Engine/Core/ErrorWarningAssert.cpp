@@ -182,7 +182,7 @@ int SystemDialogue_YesNoCancel( std::string const& messageTitle, std::string con
 
 
 //-----------------------------------------------------------------------------------------------
-__declspec( noreturn ) void FatalError( char const* filePath, char const* functionName, int lineNum, std::string const& reasonForError, char const* conditionText )
+[[noreturn]] void FatalError( char const* filePath, char const* functionName, int lineNum, std::string const& reasonForError, char const* conditionText )
 {
 	std::string errorMessage = reasonForError;
 	if( reasonForError.empty() )
@@ -1,10 +1,15 @@
 #include <string>
+#include <algorithm>
+#include <thread>
 
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 
 EventSystem* g_eventSystem = nullptr;
 
+static thread_local DeferredEventBuffer* t_deferredEventBuffer = nullptr;
+static thread_local EventSystem* t_deferredEventBufferOwner = nullptr;
+
 EventSystem::EventSystem( EventSystemConfig const& config )
 	: m_config( config )
 {
@@ -12,6 +17,19 @@ EventSystem::EventSystem( EventSystemConfig const& config )
 
 EventSystem::~EventSystem()
 {
+	for (int i = 0; i < m_typedEvents.size(); i++)
+	{
+		delete m_typedEvents[i];
+		m_typedEvents[i] = nullptr;
+	}
+	m_typedEvents.clear();
+
+	for (int i = 0; i < m_deferredEventBuffers.size(); i++)
+	{
+		delete m_deferredEventBuffers[i];
+		m_deferredEventBuffers[i] = nullptr;
+	}
+	m_deferredEventBuffers.clear();
 }
 
 void EventSystem::Startup()
@@ -24,10 +42,80 @@ void EventSystem::Shutdown()
 
 void EventSystem::BeginFrame()
 {
+	DispatchDeferredEvents();
 }
 
 void EventSystem::EndFrame()
 {
+	DispatchDeferredEvents();
+}
+
+DeferredEventBuffer* EventSystem::GetDeferredEventBuffer()
+{
+	if (t_deferredEventBufferOwner != this)
+	{
+		DeferredEventBuffer* buffer = new DeferredEventBuffer();
+		m_deferredEventBuffersMutex.lock();
+		m_deferredEventBuffers.push_back( buffer );
+		m_deferredEventBuffersMutex.unlock();
+
+		t_deferredEventBuffer = buffer;
+		t_deferredEventBufferOwner = this;
+	}
+	return t_deferredEventBuffer;
+}
+
+void EventSystem::DispatchDeferredEvents()
+{
+	m_deferredDispatchMutex.lock();
+
+	std::vector<DeferredEventBuffer*> buffers;
+	m_deferredEventBuffersMutex.lock();
+	buffers = m_deferredEventBuffers;
+	m_deferredEventBuffersMutex.unlock();
+
+	// flip first, then wait out a writer that may have picked the old half just before the flip
+	std::vector<int> readIndexes( buffers.size() );
+	for (int i = 0; i < buffers.size(); i++)
+	{
+		DeferredEventBuffer* buffer = buffers[i];
+		readIndexes[i] = buffer->m_writeIndex;
+		buffer->m_writeIndex = 1 - readIndexes[i];
+		while (buffer->m_isWriting)
+		{
+			std::this_thread::yield();
+		}
+
+		std::vector<DeferredEventRecord> const& records = buffer->m_records[readIndexes[i]];
+		unsigned char const* payloads = buffer->m_payloads[readIndexes[i]].data();
+		for (DeferredEventRecord const& record : records)
+		{
+			m_deferredDispatchList.push_back( std::make_pair( &record, payloads ) );
+		}
+	}
+
+	std::sort( m_deferredDispatchList.begin(), m_deferredDispatchList.end(),
+		[]( std::pair<DeferredEventRecord const*, unsigned char const*> const& a, std::pair<DeferredEventRecord const*, unsigned char const*> const& b )
+		{
+			return a.first->sequence < b.first->sequence;
+		} );
+
+	m_subscriptionMutex.lock();
+	for (auto const& deferredEvent : m_deferredDispatchList)
+	{
+		DeferredEventRecord const* record = deferredEvent.first;
+		record->dispatch( this, record->eventId, deferredEvent.second + record->payloadOffset );
+	}
+	m_subscriptionMutex.unlock();
+	m_deferredDispatchList.clear();
+
+	for (int i = 0; i < buffers.size(); i++)
+	{
+		buffers[i]->m_records[readIndexes[i]].clear();
+		buffers[i]->m_payloads[readIndexes[i]].clear();
+	}
+
+	m_deferredDispatchMutex.unlock();
 }
 
 void EventSystem::SubscribeEventCallBackFunc( std::string const& eventName, void(*legacyFunctionPtr)(), int numberOfArgs, std::string formatting )
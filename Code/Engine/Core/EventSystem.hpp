@@ -1,9 +1,13 @@
 #pragma once
 
 #include <vector>
+#include <deque>
 #include <unordered_map>
 #include <string>
 #include <mutex>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
 
 #include <any>
 #include <functional>
@@ -13,6 +17,7 @@
 #include "Engine/Core/NamedStrings.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/HashedCaseInsensitiveString.hpp"
 
 typedef NamedStrings EventArgs;
 typedef void (*EventCallBackFunc)(EventArgs);
@@ -30,6 +35,74 @@ struct EventSubscription
 
 typedef std::vector<EventSubscription> SubscriptionList;
 
+// Interned id of an event registered once with a fixed signature, firing it is an array index plus direct calls
+template<typename... Args>
+struct EventHandle
+{
+	static constexpr unsigned int INVALID_ID = 0xffffffff;
+
+	unsigned int m_id = INVALID_ID;
+
+	bool IsValid() const { return m_id != INVALID_ID; }
+};
+
+// keeps fire arguments out of template deduction so they convert to the handle signature
+template<typename T>
+struct EventArgType
+{
+	typedef T type;
+};
+
+struct TypedEventListBase
+{
+	TypedEventListBase( std::string const& name, std::type_index signature )
+		: m_name( name )
+		, m_signature( signature )
+	{}
+	virtual ~TypedEventListBase() = default;
+
+	std::string m_name;
+	std::type_index m_signature;
+};
+
+template<typename... Args>
+struct TypedEventSubscription
+{
+	std::function<bool( Args... )> callback;
+	void* functionKey = nullptr;
+	void* objectInstance = nullptr;
+};
+
+template<typename... Args>
+struct TypedEventList : public TypedEventListBase
+{
+	TypedEventList( std::string const& name )
+		: TypedEventListBase( name, typeid(void(*)(Args...)) )
+	{}
+
+	// a deque keeps subscriptions in place when a callback subscribes while the event is being fired
+	std::deque<TypedEventSubscription<Args...>> m_subscriptions;
+};
+
+class EventSystem;
+
+struct DeferredEventRecord
+{
+	unsigned long long sequence = 0;
+	unsigned int eventId = 0;
+	size_t payloadOffset = 0;
+	void (*dispatch)(EventSystem*, unsigned int, unsigned char const*) = nullptr;
+};
+
+// Owned by one thread, which writes into one half while the dispatching thread drains the other
+struct DeferredEventBuffer
+{
+	std::vector<DeferredEventRecord> m_records[2];
+	std::vector<unsigned char> m_payloads[2];
+	std::atomic<int> m_writeIndex = 0;
+	std::atomic<bool> m_isWriting = false;
+};
+
 struct EventSystemConfig
 {
 
@@ -298,8 +371,247 @@ public:
 
 	Strings GetAllSubscribedName();
 
+public:
+	// Registering the same name again returns the same handle, a different signature returns an invalid handle
+	template<typename... Args>
+	EventHandle<Args...> RegisterTypedEvent( std::string const& eventName )
+	{
+		EventHandle<Args...> handle;
+		m_subscriptionMutex.lock();
+
+		HashedCaseInsensitiveString key( eventName );
+		auto found = m_typedEventIdByName.find( key );
+		if (found != m_typedEventIdByName.end())
+		{
+			if (m_typedEvents[found->second]->m_signature != std::type_index( typeid(void(*)(Args...)) ))
+			{
+				m_subscriptionMutex.unlock();
+				ERROR_RECOVERABLE( (eventName + " typed event registered again with a different signature").c_str() );
+				return handle;
+			}
+			handle.m_id = found->second;
+			m_subscriptionMutex.unlock();
+			return handle;
+		}
+
+		handle.m_id = (unsigned int)m_typedEvents.size();
+		m_typedEvents.push_back( new TypedEventList<Args...>( eventName ) );
+		m_typedEventIdByName[key] = handle.m_id;
+
+		m_subscriptionMutex.unlock();
+		return handle;
+	}
+
+	template<typename... Args>
+	void SubscribeTypedEvent( EventHandle<Args...> handle, bool( *func )(Args...) )
+	{
+		TypedEventSubscription<Args...> newSubscription;
+		newSubscription.callback = func;
+		newSubscription.functionKey = reinterpret_cast<void*>(func);
+		AddTypedSubscription( handle, newSubscription );
+	}
+
+	template<typename T, typename... Args>
+	void SubscribeTypedEvent( EventHandle<Args...> handle, T* instance, bool( T::*method )(Args...) )
+	{
+		TypedEventSubscription<Args...> newSubscription;
+		newSubscription.callback = [instance, method]( Args... args ) -> bool
+			{
+				return (instance->*method)(std::forward<Args>( args )...);
+			};
+		newSubscription.functionKey = *reinterpret_cast<void**>(&method);
+		newSubscription.objectInstance = reinterpret_cast<void*>(instance);
+		AddTypedSubscription( handle, newSubscription );
+	}
+
+	template<typename... Args>
+	void UnsubscribeTypedEvent( EventHandle<Args...> handle, bool( *func )(Args...) )
+	{
+		RemoveTypedSubscription( handle, reinterpret_cast<void*>(func), nullptr );
+	}
+
+	template<typename T, typename... Args>
+	void UnsubscribeTypedEvent( EventHandle<Args...> handle, T* instance, bool( T::*method )(Args...) )
+	{
+		RemoveTypedSubscription( handle, *reinterpret_cast<void**>(&method), reinterpret_cast<void*>(instance) );
+	}
+
+	// Same return convention as FireEventEX, the number of subscribers called before one consumed the event
+	template<typename... Args>
+	int FireTypedEvent( EventHandle<Args...> handle, typename EventArgType<Args>::type... args )
+	{
+		if (!handle.IsValid())
+			return 0;
+
+		int counter = 0;
+		m_subscriptionMutex.lock();
+		TypedEventList<Args...>* eventList = static_cast<TypedEventList<Args...>*>(m_typedEvents[handle.m_id]);
+		for (size_t i = 0; i < eventList->m_subscriptions.size(); i++)
+		{
+			TypedEventSubscription<Args...>& subscription = eventList->m_subscriptions[i];
+			if (!subscription.callback)
+				continue;
+
+			if (subscription.callback( args... ))
+			{
+				m_subscriptionMutex.unlock();
+				return counter;
+			}
+			counter++;
+		}
+		m_subscriptionMutex.unlock();
+		return counter;
+	}
+
+	// Safe from any thread without locking, the event is fired on the thread that calls DispatchDeferredEvents
+	// Events are dispatched in the order they were queued, arguments are copied bytewise so they must be trivially copyable
+	template<typename... Args>
+	void QueueTypedEvent( EventHandle<Args...> handle, typename EventArgType<Args>::type... args )
+	{
+		static_assert(std::conjunction<std::is_trivially_copyable<typename std::decay<Args>::type>...>::value,
+			"Deferred event arguments must be trivially copyable");
+		if (!handle.IsValid())
+			return;
+
+		DeferredEventBuffer* buffer = GetDeferredEventBuffer();
+		buffer->m_isWriting = true;
+		int writeIndex = buffer->m_writeIndex;
+
+		std::vector<unsigned char>& payloads = buffer->m_payloads[writeIndex];
+		DeferredEventRecord record;
+		record.sequence = m_deferredEventSequence++;
+		record.eventId = handle.m_id;
+		record.payloadOffset = payloads.size();
+		record.dispatch = &DispatchDeferredTypedEvent<Args...>;
+		payloads.resize( payloads.size() + GetDeferredPayloadSize<Args...>() );
+		unsigned char* cursor = payloads.data() + record.payloadOffset;
+		(WriteDeferredArg( cursor, args ), ...);
+		(void)cursor;
+		buffer->m_records[writeIndex].push_back( record );
+
+		buffer->m_isWriting = false;
+	}
+
+	// Swaps every thread's buffer and fires what was queued, called from BeginFrame and EndFrame
+	void DispatchDeferredEvents();
+
+protected:
+	template<typename... Args>
+	static constexpr size_t GetDeferredPayloadSize()
+	{
+		size_t sizes[] = { 0, sizeof( typename std::decay<Args>::type )... };
+		size_t total = 0;
+		for (size_t size : sizes)
+		{
+			total += size;
+		}
+		return total;
+	}
+
+	template<typename T>
+	static void WriteDeferredArg( unsigned char*& cursor, T const& value )
+	{
+		memcpy( cursor, &value, sizeof( T ) );
+		cursor += sizeof( T );
+	}
+
+	template<typename T>
+	static T ReadDeferredArg( unsigned char const* source )
+	{
+		typename std::aligned_storage<sizeof( T ), alignof(T)>::type storage;
+		memcpy( &storage, source, sizeof( T ) );
+		return *reinterpret_cast<T*>(&storage);
+	}
+
+	template<typename... Args, size_t... I>
+	static void DispatchDeferredTypedEvent( EventSystem* eventSystem, EventHandle<Args...> handle, unsigned char const* payload, std::index_sequence<I...> )
+	{
+		size_t sizes[] = { sizeof( typename std::decay<Args>::type )..., 0 };
+		size_t offsets[sizeof...(Args) + 1] = {};
+		for (size_t i = 0; i < sizeof...(Args); i++)
+		{
+			offsets[i + 1] = offsets[i] + sizes[i];
+		}
+		eventSystem->FireTypedEvent( handle, ReadDeferredArg<typename std::decay<Args>::type>( payload + offsets[I] )... );
+	}
+
+	template<typename... Args>
+	static void DispatchDeferredTypedEvent( EventSystem* eventSystem, unsigned int eventId, unsigned char const* payload )
+	{
+		EventHandle<Args...> handle;
+		handle.m_id = eventId;
+		DispatchDeferredTypedEvent<Args...>( eventSystem, handle, payload, std::index_sequence_for<Args...>{} );
+	}
+
+	DeferredEventBuffer* GetDeferredEventBuffer();
+
+	template<typename... Args>
+	void AddTypedSubscription( EventHandle<Args...> handle, TypedEventSubscription<Args...> const& newSubscription )
+	{
+		if (!handle.IsValid())
+			return;
+
+		m_subscriptionMutex.lock();
+		TypedEventList<Args...>* eventList = static_cast<TypedEventList<Args...>*>(m_typedEvents[handle.m_id]);
+		TypedEventSubscription<Args...>* emptySlot = nullptr;
+		for (TypedEventSubscription<Args...>& subscription : eventList->m_subscriptions)
+		{
+			if (subscription.callback && subscription.functionKey == newSubscription.functionKey &&
+				subscription.objectInstance == newSubscription.objectInstance)
+			{
+				m_subscriptionMutex.unlock();
+				return;
+			}
+			if (!subscription.callback && !emptySlot)
+			{
+				emptySlot = &subscription;
+			}
+		}
+
+		if (emptySlot)
+		{
+			*emptySlot = newSubscription;
+		}
+		else
+		{
+			eventList->m_subscriptions.push_back( newSubscription );
+		}
+		m_subscriptionMutex.unlock();
+	}
+
+	// slots are cleared rather than erased so a callback may unsubscribe while the event is being fired
+	template<typename... Args>
+	void RemoveTypedSubscription( EventHandle<Args...> handle, void* functionKey, void* objectInstance )
+	{
+		if (!handle.IsValid())
+			return;
+
+		m_subscriptionMutex.lock();
+		TypedEventList<Args...>* eventList = static_cast<TypedEventList<Args...>*>(m_typedEvents[handle.m_id]);
+		for (TypedEventSubscription<Args...>& subscription : eventList->m_subscriptions)
+		{
+			if (subscription.functionKey == functionKey && subscription.objectInstance == objectInstance)
+			{
+				subscription.callback = nullptr;
+				subscription.functionKey = nullptr;
+				subscription.objectInstance = nullptr;
+				break;
+			}
+		}
+		m_subscriptionMutex.unlock();
+	}
+
 protected:
 	EventSystemConfig m_config;
 	std::unordered_map<std::string, SubscriptionList> m_subscriptionListByName;
 	mutable std::recursive_mutex m_subscriptionMutex;
+
+	std::vector<TypedEventListBase*> m_typedEvents;
+	std::unordered_map<HashedCaseInsensitiveString, unsigned int> m_typedEventIdByName;
+
+	std::vector<DeferredEventBuffer*> m_deferredEventBuffers;
+	std::mutex m_deferredEventBuffersMutex;
+	std::mutex m_deferredDispatchMutex;
+	std::atomic<unsigned long long> m_deferredEventSequence = 0;
+	std::vector<std::pair<DeferredEventRecord const*, unsigned char const*>> m_deferredDispatchList;
 };
@@ -2,8 +2,226 @@
 #include "ThirdParty/stbi/stb_image.h"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/FileUtil.hpp"
+#include "Engine/Binary/BinaryUtil.hpp"
 
 #include <string>
+#include <cstring>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <tmmintrin.h>
+#define IMAGE_CONVERT_SSSE3
+#endif
+#include <cmath>
+
+static_assert(sizeof( Rgba8 ) == 4, "texels are copied as packed RGBA bytes");
+
+// Layout: magic, version, source key, format, dimensions, mip count, each level's byte size, then each level's blocks
+constexpr unsigned int k_compressedImageMagic = 0x58544345; // "ECTX"
+constexpr unsigned int k_compressedImageVersion = 1;
+constexpr size_t k_compressedImageHeaderSize = 4 + 4 + 8 + 1 + 8 + 4;
+
+#if defined(IMAGE_CONVERT_SSSE3)
+static bool IsSSSE3Supported()
+{
+	static bool const s_isSupported = []()
+		{
+			int cpuInfo[4] = {};
+			__cpuid( cpuInfo, 1 );
+			return (cpuInfo[2] & (1 << 9)) != 0;
+		}();
+	return s_isSupported;
+}
+#endif
+
+static void ConvertRgbToRgba8( unsigned char const* pixels, Rgba8* outTexels, size_t texelCount )
+{
+	size_t texelIndex = 0;
+#if defined(IMAGE_CONVERT_SSSE3)
+	if (IsSSSE3Supported())
+	{
+		// 4 texels per step from a 16 byte load, the last 4 bytes belong to the next step
+		__m128i const shuffle = _mm_setr_epi8( 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1 );
+		__m128i const alpha = _mm_set1_epi32( (int)0xff000000 );
+		unsigned char* out = reinterpret_cast<unsigned char*>(outTexels);
+		for (; texelIndex + 6 <= texelCount; texelIndex += 4)
+		{
+			__m128i rgb = _mm_loadu_si128( reinterpret_cast<__m128i const*>(pixels + texelIndex * 3) );
+			__m128i rgba = _mm_or_si128( _mm_shuffle_epi8( rgb, shuffle ), alpha );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>(out + texelIndex * 4), rgba );
+		}
+	}
+#endif
+	for (; texelIndex < texelCount; texelIndex++)
+	{
+		unsigned char const* texel = pixels + texelIndex * 3;
+		outTexels[texelIndex].r = texel[0];
+		outTexels[texelIndex].g = texel[1];
+		outTexels[texelIndex].b = texel[2];
+		outTexels[texelIndex].a = 255;
+	}
+}
+
+IntVec2 GetNextMipDimensions( IntVec2 const& dimensions )
+{
+	return IntVec2( dimensions.x > 1 ? dimensions.x / 2 : 1, dimensions.y > 1 ? dimensions.y / 2 : 1 );
+}
+
+// sRGB decode is exact per byte, the encode table is fine enough that every byte round trips
+constexpr int k_linearToSRGBTableSize = 4096;
+
+struct SRGBTables
+{
+	float m_toLinear[256];
+	unsigned char m_toSRGB[k_linearToSRGBTableSize + 1];
+
+	SRGBTables()
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			float value = (float)i / 255.f;
+			m_toLinear[i] = value <= 0.04045f ? value / 12.92f : powf( (value + 0.055f) / 1.055f, 2.4f );
+		}
+		for (int i = 0; i <= k_linearToSRGBTableSize; i++)
+		{
+			float value = (float)i / (float)k_linearToSRGBTableSize;
+			float encoded = value <= 0.0031308f ? value * 12.92f : 1.055f * powf( value, 1.f / 2.4f ) - 0.055f;
+			m_toSRGB[i] = (unsigned char)(encoded * 255.f + 0.5f);
+		}
+	}
+};
+
+static SRGBTables const& GetSRGBTables()
+{
+	static SRGBTables const s_tables;
+	return s_tables;
+}
+
+// Source rows or columns averaged into one destination row or column, the last one also takes an odd edge
+static int GetBoxFootprint( int destinationIndex, int destinationSize, int sourceSize, int* out_sourceIndexes )
+{
+	if (sourceSize == 1)
+	{
+		out_sourceIndexes[0] = 0;
+		return 1;
+	}
+
+	out_sourceIndexes[0] = destinationIndex * 2;
+	out_sourceIndexes[1] = destinationIndex * 2 + 1;
+	if (destinationIndex == destinationSize - 1 && (sourceSize & 1) != 0)
+	{
+		out_sourceIndexes[2] = destinationIndex * 2 + 2;
+		return 3;
+	}
+	return 2;
+}
+
+void DownsampleRgba8Box( Rgba8 const* source, IntVec2 const& sourceDimensions, Rgba8* destination, bool isSRGB )
+{
+	IntVec2 destinationDimensions = GetNextMipDimensions( sourceDimensions );
+	SRGBTables const& tables = GetSRGBTables();
+
+	for (int y = 0; y < destinationDimensions.y; y++)
+	{
+		int rows[3];
+		int rowCount = GetBoxFootprint( y, destinationDimensions.y, sourceDimensions.y, rows );
+		Rgba8* outRow = destination + (size_t)y * destinationDimensions.x;
+
+		for (int x = 0; x < destinationDimensions.x; x++)
+		{
+			int columns[3];
+			int columnCount = GetBoxFootprint( x, destinationDimensions.x, sourceDimensions.x, columns );
+			int texelCount = rowCount * columnCount;
+
+			if (!isSRGB)
+			{
+				int sum[4] = {};
+				for (int rowIndex = 0; rowIndex < rowCount; rowIndex++)
+				{
+					for (int columnIndex = 0; columnIndex < columnCount; columnIndex++)
+					{
+						Rgba8 const& texel = source[(size_t)rows[rowIndex] * sourceDimensions.x + columns[columnIndex]];
+						sum[0] += texel.r;
+						sum[1] += texel.g;
+						sum[2] += texel.b;
+						sum[3] += texel.a;
+					}
+				}
+				// adding half the count rounds to nearest
+				outRow[x].r = (unsigned char)((sum[0] + texelCount / 2) / texelCount);
+				outRow[x].g = (unsigned char)((sum[1] + texelCount / 2) / texelCount);
+				outRow[x].b = (unsigned char)((sum[2] + texelCount / 2) / texelCount);
+				outRow[x].a = (unsigned char)((sum[3] + texelCount / 2) / texelCount);
+				continue;
+			}
+
+			// colour is averaged in linear space, alpha is coverage and stays linear
+			// the table lookups dominate, so this stays scalar and rounds the same way on every build
+			float sum[4] = {};
+			for (int rowIndex = 0; rowIndex < rowCount; rowIndex++)
+			{
+				for (int columnIndex = 0; columnIndex < columnCount; columnIndex++)
+				{
+					Rgba8 const& texel = source[(size_t)rows[rowIndex] * sourceDimensions.x + columns[columnIndex]];
+					sum[0] += tables.m_toLinear[texel.r];
+					sum[1] += tables.m_toLinear[texel.g];
+					sum[2] += tables.m_toLinear[texel.b];
+					sum[3] += (float)texel.a / 255.f;
+				}
+			}
+			float scale = 1.f / (float)texelCount;
+			int channel[4];
+			for (int i = 0; i < 3; i++)
+			{
+				channel[i] = (int)(sum[i] * scale * (float)k_linearToSRGBTableSize + 0.5f);
+			}
+			channel[3] = (int)(sum[3] * scale * 255.f + 0.5f);
+
+			outRow[x].r = tables.m_toSRGB[channel[0]];
+			outRow[x].g = tables.m_toSRGB[channel[1]];
+			outRow[x].b = tables.m_toSRGB[channel[2]];
+			outRow[x].a = (unsigned char)channel[3];
+		}
+	}
+}
+
+void ConvertPixelsToRgba8( unsigned char const* pixels, int bytesPerPixel, Rgba8* outTexels, size_t texelCount )
+{
+	switch (bytesPerPixel)
+	{
+	case 4:
+		memcpy( reinterpret_cast<unsigned char*>(outTexels), pixels, texelCount * 4 );
+		break;
+	case 3:
+		ConvertRgbToRgba8( pixels, outTexels, texelCount );
+		break;
+	case 2:
+		for (size_t i = 0; i < texelCount; i++)
+		{
+			outTexels[i].r = outTexels[i].g = outTexels[i].b = pixels[i * 2];
+			outTexels[i].a = pixels[i * 2 + 1];
+		}
+		break;
+	case 1:
+		for (size_t i = 0; i < texelCount; i++)
+		{
+			outTexels[i].r = outTexels[i].g = outTexels[i].b = pixels[i];
+			outTexels[i].a = 255;
+		}
+		break;
+	}
+}
+
+bool IsCompressedImageFilePath( std::string const& imageFilePath )
+{
+	std::string lowerPath = ToLower( imageFilePath );
+	size_t extensionLength = strlen( k_compressedImageExtension );
+	return lowerPath.size() > extensionLength
+		&& lowerPath.compare( lowerPath.size() - extensionLength, extensionLength, k_compressedImageExtension ) == 0;
+}
 
 Image::Image()
 {
@@ -17,6 +235,28 @@ Image::Image( char const* imageFilePath )
 	: m_imageFilePath( imageFilePath )
 	, m_dimensions( IntVec2::ZERO )
 {
+	LoadFromFile( imageFilePath );
+}
+
+bool Image::LoadFromFile( char const* imageFilePath )
+{
+	m_imageFilePath = imageFilePath;
+	m_dimensions = IntVec2::ZERO;
+	m_rgbaTexels.clear();
+	m_mipLevels.clear();
+	m_compressedFormat = BlockCompressionFormat::NONE;
+	m_compressedMipLevels.clear();
+
+	if (IsCompressedImageFilePath( m_imageFilePath ))
+	{
+		if (!LoadCompressedFile( imageFilePath, 0 ))
+		{
+			ERROR_RECOVERABLE( Stringf( "Fail Load Image: %s", imageFilePath ) );
+			return false;
+		}
+		return true;
+	}
+
 	int width, height, bpp;
 	stbi_set_flip_vertically_on_load( 1 );
 	unsigned char* pixels = stbi_load( imageFilePath, &width, &height, &bpp, 0 );
@@ -24,51 +264,14 @@ Image::Image( char const* imageFilePath )
 	{
 		ERROR_RECOVERABLE( Stringf( "Fail Load Image: %s", imageFilePath ) );
 		stbi_image_free( pixels );
-		return;
+		return false;
 	}
 	m_dimensions = IntVec2( width, height );
 	m_bitPerPixel = bpp;
-	m_rgbaTexels.resize( width * height );
-	for (int i = 0; i < width * height * m_bitPerPixel; ++i)
-	{
-		int index = i / m_bitPerPixel;
-		int mod = i - index * m_bitPerPixel;
-		if (m_bitPerPixel == 3)
-		{
-			switch (mod)
-			{
-			case 0:
-				m_rgbaTexels[index].r = pixels[i];
-				break;
-			case 1:
-				m_rgbaTexels[index].g = pixels[i];
-				break;
-			case 2:
-				m_rgbaTexels[index].b = pixels[i];
-				break;
-			}
-			m_rgbaTexels[index].a = 255;
-		}
-		else if (m_bitPerPixel == 4)
-		{
-			switch (mod)
-			{
-			case 0:
-				m_rgbaTexels[index].r = pixels[i];
-				break;
-			case 1:
-				m_rgbaTexels[index].g = pixels[i];
-				break;
-			case 2:
-				m_rgbaTexels[index].b = pixels[i];
-				break;
-			case 3:
-				m_rgbaTexels[index].a = pixels[i];
-				break;
-			}
-		}
-	}
+	m_rgbaTexels.resize( (size_t)width * height );
+	ConvertPixelsToRgba8( pixels, bpp, m_rgbaTexels.data(), m_rgbaTexels.size() );
  	stbi_image_free( pixels );
+	return true;
 }
 
 Image::Image( IntVec2 size, Rgba8 color )
@@ -76,14 +279,194 @@ Image::Image( IntVec2 size, Rgba8 color )
 	, m_imageFilePath( "" )
 {
 	m_bitPerPixel = 4;
-	m_rgbaTexels.reserve( m_dimensions.x * m_dimensions.y );
-	for (int i = 0; i < size.x; i++)
+	m_rgbaTexels.assign( (size_t)m_dimensions.x * m_dimensions.y, color );
+}
+
+void Image::GenerateMipChain( bool isSRGB )
+{
+	if (IsCompressed())
+		return;
+
+	m_mipLevels.clear();
+	IntVec2 dimensions = m_dimensions;
+	if (dimensions.x <= 0 || dimensions.y <= 0)
+		return;
+
+	Rgba8 const* source = m_rgbaTexels.data();
+	while (dimensions.x > 1 || dimensions.y > 1)
 	{
-		for (int j = 0; j < size.y; j++)
-		{
-			m_rgbaTexels.push_back( color );
-		}
+		IntVec2 mipDimensions = GetNextMipDimensions( dimensions );
+		m_mipLevels.emplace_back( (size_t)mipDimensions.x * mipDimensions.y );
+		DownsampleRgba8Box( source, dimensions, m_mipLevels.back().data(), isSRGB );
+		source = m_mipLevels.back().data();
+		dimensions = mipDimensions;
+	}
+}
+
+void Image::ClearMipChain()
+{
+	m_mipLevels.clear();
+}
+
+int Image::GetMipCount() const
+{
+	if (IsCompressed())
+		return (int)m_compressedMipLevels.size();
+	return 1 + (int)m_mipLevels.size();
+}
+
+IntVec2 Image::GetMipDimensions( int mipLevel ) const
+{
+	IntVec2 dimensions = m_dimensions;
+	for (int i = 0; i < mipLevel; i++)
+	{
+		dimensions = GetNextMipDimensions( dimensions );
+	}
+	return dimensions;
+}
+
+void const* Image::GetMipRawData( int mipLevel ) const
+{
+	if (IsCompressed())
+		return m_compressedMipLevels[mipLevel].data();
+	if (mipLevel == 0)
+		return m_rgbaTexels.data();
+	return m_mipLevels[mipLevel - 1].data();
+}
+
+size_t Image::GetMipRowPitch( int mipLevel ) const
+{
+	IntVec2 mipDimensions = GetMipDimensions( mipLevel );
+	if (IsCompressed())
+		return GetBlockCompressedRowPitch( mipDimensions.x, m_compressedFormat );
+	return sizeof( Rgba8 ) * mipDimensions.x;
+}
+
+size_t Image::GetMipByteSize( int mipLevel ) const
+{
+	IntVec2 mipDimensions = GetMipDimensions( mipLevel );
+	if (IsCompressed())
+		return GetBlockCompressedSize( mipDimensions, m_compressedFormat );
+	return sizeof( Rgba8 ) * mipDimensions.x * mipDimensions.y;
+}
+
+bool Image::Compress( BlockCompressionFormat format )
+{
+	if (IsCompressed() || format == BlockCompressionFormat::NONE || format == BlockCompressionFormat::COUNT)
+		return false;
+	// D3D11 only creates block compressed textures whose top level is a whole number of blocks
+	if (m_dimensions.x <= 0 || m_dimensions.y <= 0 || m_dimensions.x % 4 != 0 || m_dimensions.y % 4 != 0)
+		return false;
+
+	int mipCount = GetMipCount();
+	m_compressedMipLevels.resize( mipCount );
+	for (int mipLevel = 0; mipLevel < mipCount; mipLevel++)
+	{
+		IntVec2 mipDimensions = GetMipDimensions( mipLevel );
+		m_compressedMipLevels[mipLevel].resize( GetBlockCompressedSize( mipDimensions, format ) );
+		CompressRgba8ToBlocks( static_cast<Rgba8 const*>(GetMipRawData( mipLevel )), mipDimensions, format, m_compressedMipLevels[mipLevel].data() );
+	}
+
+	m_compressedFormat = format;
+	std::vector<Rgba8>().swap( m_rgbaTexels );
+	std::vector<std::vector<Rgba8>>().swap( m_mipLevels );
+	return true;
+}
+
+bool Image::HasTranslucentTexels() const
+{
+	for (Rgba8 const& texel : m_rgbaTexels)
+	{
+		if (texel.a != 255)
+			return true;
+	}
+	return false;
+}
+
+bool Image::SaveCompressedFile( char const* compressedFilePath, unsigned long long sourceKey ) const
+{
+	if (!IsCompressed())
+		return false;
+
+	size_t blockBytes = 0;
+	for (std::vector<unsigned char> const& mipLevel : m_compressedMipLevels)
+	{
+		blockBytes += mipLevel.size();
+	}
+
+	BufferWriter writer;
+	writer.SetEndianMode( Endianness::LITTLE );
+	writer.m_buffer.reserve( k_compressedImageHeaderSize + 4 * m_compressedMipLevels.size() + blockBytes );
+	writer.AppendUInt( k_compressedImageMagic );
+	writer.AppendUInt( k_compressedImageVersion );
+	writer.AppendUInt64( sourceKey );
+	writer.AppendByte( (unsigned char)m_compressedFormat );
+	writer.AppendIntVec2( m_dimensions );
+	writer.AppendUInt( (unsigned int)m_compressedMipLevels.size() );
+	for (std::vector<unsigned char> const& mipLevel : m_compressedMipLevels)
+	{
+		writer.AppendUInt( (unsigned int)mipLevel.size() );
+	}
+	for (std::vector<unsigned char> const& mipLevel : m_compressedMipLevels)
+	{
+		writer.m_buffer.insert( writer.m_buffer.end(), mipLevel.begin(), mipLevel.end() );
+	}
+	return FileWriteToBuffer_S( writer.m_buffer, compressedFilePath );
+}
+
+bool Image::LoadCompressedFile( char const* compressedFilePath, unsigned long long expectedSourceKey )
+{
+	std::vector<unsigned char> buffer;
+	if (!FileReadToBuffer( buffer, compressedFilePath ) || buffer.size() < k_compressedImageHeaderSize)
+		return false;
+
+	BufferParser parser( buffer );
+	parser.SetEndianMode( Endianness::LITTLE );
+	if (parser.ParseUInt() != k_compressedImageMagic || parser.ParseUInt() != k_compressedImageVersion)
+		return false;
+	unsigned long long sourceKey = parser.ParseUInt64();
+	if (expectedSourceKey != 0 && sourceKey != expectedSourceKey)
+		return false;
+
+	BlockCompressionFormat format = (BlockCompressionFormat)parser.ParseByte();
+	IntVec2 dimensions = parser.ParseIntVec2();
+	int mipCount = (int)parser.ParseUInt();
+	if (GetBlockCompressionBlockSize( format ) == 0 || dimensions.x <= 0 || dimensions.y <= 0 || dimensions.x % 4 != 0 || dimensions.y % 4 != 0
+		|| mipCount <= 0 || mipCount > 32)
+		return false;
+
+	// every level is checked against the size its dimensions need before anything is kept
+	size_t offset = k_compressedImageHeaderSize + 4 * (size_t)mipCount;
+	if (buffer.size() < offset)
+		return false;
+	std::vector<size_t> mipSizes( mipCount );
+	size_t blockBytes = 0;
+	IntVec2 mipDimensions = dimensions;
+	for (int mipLevel = 0; mipLevel < mipCount; mipLevel++)
+	{
+		mipSizes[mipLevel] = parser.ParseUInt();
+		if (mipSizes[mipLevel] != GetBlockCompressedSize( mipDimensions, format ))
+			return false;
+		blockBytes += mipSizes[mipLevel];
+		mipDimensions = GetNextMipDimensions( mipDimensions );
 	}
+	if (buffer.size() != offset + blockBytes)
+		return false;
+
+	std::vector<std::vector<unsigned char>> mipLevels( mipCount );
+	for (int mipLevel = 0; mipLevel < mipCount; mipLevel++)
+	{
+		mipLevels[mipLevel].assign( buffer.begin() + offset, buffer.begin() + offset + mipSizes[mipLevel] );
+		offset += mipSizes[mipLevel];
+	}
+
+	m_dimensions = dimensions;
+	m_bitPerPixel = 0;
+	m_rgbaTexels.clear();
+	m_mipLevels.clear();
+	m_compressedFormat = format;
+	m_compressedMipLevels.swap( mipLevels );
+	return true;
 }
 
 std::string const& Image::GetImageFilePath() const
@@ -98,7 +481,7 @@ IntVec2 Image::GetDimensions() const
 
 void const* Image::GetRawData() const
 {
-	return m_rgbaTexels.data();
+	return GetMipRawData( 0 );
 }
 
 Rgba8 Image::GetTexelColor( IntVec2 const& texelCoords ) const
@@ -112,3 +495,68 @@ void Image::SetTexelColor( IntVec2 const& texelCoords, Rgba8 const& newColor )
 	int texelIndex = texelCoords.y * m_dimensions.x + texelCoords.x;
 	m_rgbaTexels[texelIndex] = newColor;
 }
+
+// The per byte loop Image used before ConvertPixelsToRgba8, kept as the benchmark baseline
+static void ConvertPixelsPerByte( unsigned char const* pixels, int bytesPerPixel, Rgba8* outTexels, size_t texelCount )
+{
+	for (size_t i = 0; i < texelCount * bytesPerPixel; ++i)
+	{
+		size_t index = i / bytesPerPixel;
+		size_t mod = i - index * bytesPerPixel;
+		switch (mod)
+		{
+		case 0:
+			outTexels[index].r = pixels[i];
+			break;
+		case 1:
+			outTexels[index].g = pixels[i];
+			break;
+		case 2:
+			outTexels[index].b = pixels[i];
+			break;
+		case 3:
+			outTexels[index].a = pixels[i];
+			break;
+		}
+		if (bytesPerPixel == 3)
+		{
+			outTexels[index].a = 255;
+		}
+	}
+}
+
+void RunImageConversionBenchmark( int width, int height )
+{
+	size_t texelCount = (size_t)width * height;
+	PrintBenchmarkLine( Stringf( "Image conversion benchmark: %dx%d", width, height ) );
+
+	std::vector<Rgba8> baselineTexels( texelCount );
+	std::vector<Rgba8> fastTexels( texelCount );
+	for (int bytesPerPixel = 3; bytesPerPixel <= 4; bytesPerPixel++)
+	{
+		std::vector<unsigned char> pixels( texelCount * bytesPerPixel );
+		for (size_t i = 0; i < pixels.size(); i++)
+		{
+			pixels[i] = (unsigned char)(i * 31 + (i >> 8));
+		}
+
+		double startTime = GetCurrentTimeSeconds();
+		ConvertPixelsPerByte( pixels.data(), bytesPerPixel, baselineTexels.data(), texelCount );
+		double baselineSeconds = GetCurrentTimeSeconds() - startTime;
+
+		startTime = GetCurrentTimeSeconds();
+		ConvertPixelsToRgba8( pixels.data(), bytesPerPixel, fastTexels.data(), texelCount );
+		double fastSeconds = GetCurrentTimeSeconds() - startTime;
+
+		bool isMatching = memcmp( baselineTexels.data(), fastTexels.data(), texelCount * sizeof( Rgba8 ) ) == 0;
+		PrintBenchmarkLine( Stringf( "%d channel  per byte %8.3fms  converted %8.3fms  x%.2f  %s",
+			bytesPerPixel, baselineSeconds * 1000.0, fastSeconds * 1000.0,
+			fastSeconds > 0.0 ? baselineSeconds / fastSeconds : 0.0, isMatching ? "match" : "MISMATCH" ) );
+	}
+}
+
+bool Command_ImageConversionBenchmark()
+{
+	RunImageConversionBenchmark( 4096, 4096 );
+	return false;
+}
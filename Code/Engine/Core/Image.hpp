@@ -5,6 +5,7 @@
 
 #include "Engine/Math/IntVec2.hpp"
 #include "Engine/Core/Rgba8.hpp"
+#include "Engine/Core/BlockCompression.hpp"
 
 class Image
 {
@@ -16,15 +17,60 @@ public:
 	Image( char const* imageFilePath );
 	Image( IntVec2 size, Rgba8 color );
 
+	// Decodes with stb_image, or reads the blocks directly when the path ends in the compressed extension
+	bool			LoadFromFile( char const* imageFilePath );
+
 	std::string const& GetImageFilePath() const;
 	IntVec2		GetDimensions() const;
 	void const* GetRawData() const;
 	Rgba8			GetTexelColor( IntVec2 const& texelCoords ) const;
 	void			SetTexelColor( IntVec2 const& texelCoords, Rgba8 const& newColor );
 
+	// Builds every level below the top one down to 1x1, averaging in linear space when isSRGB is set
+	// Textures created from an image with a chain upload it as is instead of generating mips on the GPU
+	void			GenerateMipChain( bool isSRGB = true );
+	void			ClearMipChain();
+	int				GetMipCount() const;
+	IntVec2			GetMipDimensions( int mipLevel ) const;
+	void const*		GetMipRawData( int mipLevel ) const;
+	size_t			GetMipRowPitch( int mipLevel ) const;
+	size_t			GetMipByteSize( int mipLevel ) const;
+
+	// Replaces the texels and every mip level with blocks, false when the top level is not a whole number of blocks
+	// A compressed image can only be uploaded or saved, texel access and GenerateMipChain no longer apply
+	bool			Compress( BlockCompressionFormat format );
+	bool			IsCompressed() const { return m_compressedFormat != BlockCompressionFormat::NONE; }
+	BlockCompressionFormat GetCompressedFormat() const { return m_compressedFormat; }
+	bool			HasTranslucentTexels() const;
+
+	// sourceKey identifies what the blocks were built from, loading with an expected key of 0 accepts any file
+	bool			SaveCompressedFile( char const* compressedFilePath, unsigned long long sourceKey ) const;
+	bool			LoadCompressedFile( char const* compressedFilePath, unsigned long long expectedSourceKey );
+
 private:
 	std::string	m_imageFilePath;
 	IntVec2	m_dimensions = IntVec2( 0, 0 );
 	int m_bitPerPixel = 0;
 	std::vector<Rgba8> m_rgbaTexels;
+	// level 1 onwards, level 0 is m_rgbaTexels
+	std::vector<std::vector<Rgba8>> m_mipLevels;
+	// every level including the top one, only filled once compressed
+	BlockCompressionFormat m_compressedFormat = BlockCompressionFormat::NONE;
+	std::vector<std::vector<unsigned char>> m_compressedMipLevels;
 };
+
+// Extension of the files SaveCompressedFile writes
+constexpr char const* k_compressedImageExtension = ".ctex";
+bool IsCompressedImageFilePath( std::string const& imageFilePath );
+
+// Half size in each dimension, never below 1
+IntVec2 GetNextMipDimensions( IntVec2 const& dimensions );
+// 2x2 box filter from source into the next mip level, an odd last row or column is folded into the last destination texels
+void DownsampleRgba8Box( Rgba8 const* source, IntVec2 const& sourceDimensions, Rgba8* destination, bool isSRGB );
+
+// Expands 1 to 4 channel stb_image output into packed RGBA texels
+void ConvertPixelsToRgba8( unsigned char const* pixels, int bytesPerPixel, Rgba8* outTexels, size_t texelCount );
+
+// Times the conversion against the old per byte loop on synthetic RGB and RGBA images
+void RunImageConversionBenchmark( int width, int height );
+bool Command_ImageConversionBenchmark();
@@ -3,6 +3,77 @@
 
 JobSystem* g_jobSystem = nullptr;
 
+// index of the queue owned by the calling thread, -1 for threads that are not job workers
+static thread_local int t_workerIndex = -1;
+// lowest lane the calling thread may help with, the main thread stays out of BACKGROUND work
+static thread_local JobPriority t_lowestPriority = JobPriority::NORMAL;
+
+void Job::AddDependency( Job* prerequisite )
+{
+	prerequisite->m_successorsMutex.lock();
+	if (!prerequisite->m_hasFinished)
+	{
+		m_pendingDependencies++;
+		prerequisite->m_successors.push_back( this );
+	}
+	prerequisite->m_successorsMutex.unlock();
+}
+
+void Job::Rearm()
+{
+	m_successorsMutex.lock();
+	JobStatus status = m_status;
+	GUARANTEE_OR_DIE( status == JobStatus::NEW || status == JobStatus::COMPLETED || status == JobStatus::RETRIEVED, "Job re-armed while it is still queued or running" );
+	m_hasFinished = false;
+	m_status = JobStatus::NEW;
+	m_successorsMutex.unlock();
+}
+
+void JobQueue::Push( Job* job )
+{
+	m_jobsMutex.lock();
+	m_jobs.push_back( job );
+	m_jobsMutex.unlock();
+}
+
+Job* JobQueue::Pop()
+{
+	m_jobsMutex.lock();
+	if (m_jobs.empty())
+	{
+		m_jobsMutex.unlock();
+		return nullptr;
+	}
+	Job* job = m_jobs.back();
+	m_jobs.pop_back();
+	m_jobsMutex.unlock();
+	return job;
+}
+
+Job* JobQueue::Steal()
+{
+	// thieves only try the lock, a busy queue is skipped instead of waited on
+	if (!m_jobsMutex.try_lock())
+		return nullptr;
+	if (m_jobs.empty())
+	{
+		m_jobsMutex.unlock();
+		return nullptr;
+	}
+	Job* job = m_jobs.front();
+	m_jobs.pop_front();
+	m_jobsMutex.unlock();
+	return job;
+}
+
+bool JobQueue::IsEmpty()
+{
+	m_jobsMutex.lock();
+	bool flag = m_jobs.empty();
+	m_jobsMutex.unlock();
+	return flag;
+}
+
 void JobSystem::Startup()
 {
 	int threadCount;
@@ -14,6 +85,34 @@ void JobSystem::Startup()
 	{
 		threadCount = m_config.m_workerCount;
 	}
+
+	m_criticalWorkerCount = m_config.m_criticalWorkerCount;
+	if (m_criticalWorkerCount > threadCount - 1)
+	{
+		m_criticalWorkerCount = threadCount > 0 ? threadCount - 1 : 0;
+	}
+
+	// keep at least one queue so jobs can still be claimed by the main thread without workers
+	int queueCount = threadCount > 0 ? threadCount : 1;
+	for (int lane = 0; lane < (int)JobPriority::COUNT; lane++)
+	{
+		for (int i = 0; i < queueCount; i++)
+		{
+			m_queues[lane].push_back( new JobQueue() );
+		}
+	}
+
+	if (m_config.m_jobPoolCapacity > 0)
+	{
+		m_jobPool = new PooledJob[m_config.m_jobPoolCapacity];
+		for (int i = 0; i < m_config.m_jobPoolCapacity; i++)
+		{
+			m_jobPool[i].m_isPooled = true;
+			m_jobPool[i].m_nextFreeSlot = i + 2 <= m_config.m_jobPoolCapacity ? i + 2 : 0;
+		}
+		m_freePooledJobHead = 1;
+	}
+
 	CreateNewWorkers( threadCount );
 }
 
@@ -23,62 +122,225 @@ void JobSystem::BeginFrame()
 
 void JobSystem::EndFrame()
 {
+	// frame critical work must not leak into the next frame, help with whatever is still queued and wait for the rest
+	// without workers nobody else can run the prerequisites of a waiting critical job, so the calling thread takes them too
+	JobPriority lowestPriority = m_workers.empty() ? t_lowestPriority : JobPriority::CRITICAL;
+	while (m_unfinishedCriticalJobCount > 0)
+	{
+		Job* claimedJob = ClaimJob( t_workerIndex, lowestPriority );
+		if (claimedJob)
+		{
+			claimedJob->Execute();
+			FinishJob( claimedJob );
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
 }
 
 void JobSystem::Shutdown()
 {
 	m_isQuitting = true;
+	m_sleepMutex.lock();
+	m_sleepCondition.notify_all();
+	m_criticalSleepCondition.notify_all();
+	m_sleepMutex.unlock();
+
 	DestroyWorkers();
+
+	for (int lane = 0; lane < (int)JobPriority::COUNT; lane++)
+	{
+		for (int i = 0; i < m_queues[lane].size(); i++)
+		{
+			delete m_queues[lane][i];
+			m_queues[lane][i] = nullptr;
+		}
+		m_queues[lane].clear();
+	}
+
+	delete[] m_jobPool;
+	m_jobPool = nullptr;
+	m_freePooledJobHead = 0;
+}
+
+void JobSystem::QueueNewJob( Job* newJob, JobCounter* counter )
+{
+	newJob->Rearm();
+	newJob->SetStatus( JobStatus::WAITING );
+	newJob->m_counter = counter;
+	if (counter)
+	{
+		counter->m_value++;
+	}
+	m_unfinishedJobCount++;
+	if (newJob->GetPriority() == JobPriority::CRITICAL)
+	{
+		m_unfinishedCriticalJobCount++;
+	}
+
+	ReleaseDependency( newJob );
 }
 
-void JobSystem::QueueNewJob( Job* newJob )
+void JobSystem::SubmitReadyJob( Job* readyJob )
 {
-	newJob->SetStatus( JobStatus::QUEUED );
-	m_queuedJobsMutex.lock();
-	m_queuedJobs.push_back( newJob );
-	m_queuedJobsMutex.unlock();
+	readyJob->SetStatus( JobStatus::QUEUED );
+	JobPriority priority = readyJob->GetPriority();
+	int lane = (int)priority;
+
+	// workers keep their own jobs local, other threads spread jobs across all queues
+	int queueIndex = t_workerIndex;
+	if (queueIndex < 0)
+	{
+		queueIndex = (int)(m_nextQueueIndex++ % m_queues[lane].size());
+	}
+	m_queues[lane][queueIndex]->Push( readyJob );
+
+	m_queuedJobCount[lane]++;
+	WakeWorker( priority );
 }
 
-Job* JobSystem::ClaimFirstJob()
+void JobSystem::ReleaseDependency( Job* dependentJob )
 {
-	m_queuedJobsMutex.lock();
-	if (m_queuedJobs.size() > 0)
+	if (--dependentJob->m_pendingDependencies == 0)
 	{
-		Job* job = m_queuedJobs.front();
-		m_queuedJobs.pop_front();
-		m_queuedJobsMutex.unlock();
+		SubmitReadyJob( dependentJob );
+	}
+}
 
-		job->SetStatus( JobStatus::EXECUTING );
+Job* JobSystem::ClaimFirstJob()
+{
+	return ClaimJob( t_workerIndex, t_lowestPriority );
+}
+
+Job* JobSystem::ClaimJob( int queueIndex, JobPriority lowestPriority )
+{
+	for (int lane = 0; lane <= (int)lowestPriority; lane++)
+	{
+		if (m_queuedJobCount[lane] <= 0)
+			continue;
 
-		m_claimedJobsMutex.lock();
-		m_claimedJobs.push_back( job );
-		m_claimedJobsMutex.unlock();
+		if (lane == (int)JobPriority::BACKGROUND && m_config.m_maxBackgroundJobCount >= 0)
+		{
+			if (++m_runningBackgroundJobCount > m_config.m_maxBackgroundJobCount)
+			{
+				m_runningBackgroundJobCount--;
+				continue;
+			}
+			Job* job = ClaimJobFromLane( queueIndex, JobPriority::BACKGROUND );
+			if (job)
+				return job;
+			m_runningBackgroundJobCount--;
+			continue;
+		}
 
-		return job;
+		Job* job = ClaimJobFromLane( queueIndex, (JobPriority)lane );
+		if (job)
+			return job;
 	}
-	m_queuedJobsMutex.unlock();
 	return nullptr;
 }
 
+Job* JobSystem::ClaimJobFromLane( int queueIndex, JobPriority priority )
+{
+	int lane = (int)priority;
+	std::vector<JobQueue*>& queues = m_queues[lane];
+
+	Job* job = nullptr;
+	if (queueIndex >= 0)
+	{
+		job = queues[queueIndex]->Pop();
+	}
+
+	int queueCount = (int)queues.size();
+	int startIndex = queueIndex >= 0 ? queueIndex + 1 : 0;
+	for (int i = 0; i < queueCount && !job; i++)
+	{
+		int victimIndex = (startIndex + i) % queueCount;
+		if (victimIndex == queueIndex)
+			continue;
+		job = queues[victimIndex]->Steal();
+	}
+
+	if (!job)
+		return nullptr;
+
+	m_queuedJobCount[lane]--;
+	job->SetStatus( JobStatus::EXECUTING );
+	return job;
+}
+
+bool JobSystem::HasClaimableJob( JobPriority lowestPriority ) const
+{
+	for (int lane = 0; lane <= (int)lowestPriority; lane++)
+	{
+		if (m_queuedJobCount[lane] <= 0)
+			continue;
+		if (lane == (int)JobPriority::BACKGROUND && m_config.m_maxBackgroundJobCount >= 0
+			&& m_runningBackgroundJobCount >= m_config.m_maxBackgroundJobCount)
+			continue;
+		return true;
+	}
+	return false;
+}
+
 void JobSystem::FinishJob( Job* finishedJob )
 {
-	m_claimedJobsMutex.lock();
-	for (auto claimedJobIter = m_claimedJobs.begin(); claimedJobIter != m_claimedJobs.end(); claimedJobIter++)
+	JobPriority priority = finishedJob->GetPriority();
+	if (priority == JobPriority::BACKGROUND && m_config.m_maxBackgroundJobCount >= 0)
 	{
-		if (*claimedJobIter == finishedJob)
+		m_runningBackgroundJobCount--;
+		if (m_queuedJobCount[(int)JobPriority::BACKGROUND] > 0)
 		{
-			m_claimedJobs.erase( claimedJobIter );
-			m_claimedJobsMutex.unlock();
+			WakeWorker( JobPriority::BACKGROUND );
+		}
+	}
 
-			finishedJob->SetStatus( JobStatus::COMPLETED );
+	std::vector<Job*> successors;
+	finishedJob->m_successorsMutex.lock();
+	finishedJob->m_pendingDependencies = 1;
+	finishedJob->m_successors.swap( successors );
+	finishedJob->m_hasFinished = true;
+	finishedJob->m_successorsMutex.unlock();
 
-			m_completedJobsMutex.lock();
-			m_completedJobs.push_back( finishedJob );
-			m_completedJobsMutex.unlock();
-			return;
+	for (Job* successor : successors)
+	{
+		ReleaseDependency( successor );
+	}
+
+	// the job may be deleted by its owner as soon as it is counted down or listed, do not touch it afterwards
+	JobCounter* counter = finishedJob->m_counter;
+	if (finishedJob->m_isPooled)
+	{
+		PooledJob* pooledJob = static_cast<PooledJob*>(finishedJob);
+		pooledJob->m_destroy( pooledJob->m_storage );
+		pooledJob->SetStatus( JobStatus::COMPLETED );
+		FreePooledJob( pooledJob );
+		if (counter)
+		{
+			counter->m_value--;
 		}
 	}
-	m_claimedJobsMutex.unlock();
+	else if (counter)
+	{
+		finishedJob->SetStatus( JobStatus::COMPLETED );
+		counter->m_value--;
+	}
+	else
+	{
+		m_completedJobsMutex.lock();
+		finishedJob->SetStatus( JobStatus::COMPLETED );
+		m_completedJobs.push_back( finishedJob );
+		finishedJob->m_completedIter = std::prev( m_completedJobs.end() );
+		m_completedJobsMutex.unlock();
+	}
+
+	m_unfinishedJobCount--;
+	if (priority == JobPriority::CRITICAL)
+	{
+		m_unfinishedCriticalJobCount--;
+	}
 }
 
 Job* JobSystem::RetrieveJob( Job* retrivedJob )
@@ -86,18 +348,15 @@ Job* JobSystem::RetrieveJob( Job* retrivedJob )
 	m_completedJobsMutex.lock();
 	if (retrivedJob)
 	{
-		for (auto claimedJobIter = m_completedJobs.begin(); claimedJobIter != m_completedJobs.end(); claimedJobIter++)
+		if (retrivedJob->GetStatus() != JobStatus::COMPLETED || retrivedJob->m_counter)
 		{
-			if (*claimedJobIter == retrivedJob)
-			{
-				retrivedJob->SetStatus( JobStatus::RETRIEVED );
-				m_completedJobs.erase( claimedJobIter );
-				m_completedJobsMutex.unlock();
-				return retrivedJob;
-			}
+			m_completedJobsMutex.unlock();
+			return nullptr;
 		}
+		retrivedJob->SetStatus( JobStatus::RETRIEVED );
+		m_completedJobs.erase( retrivedJob->m_completedIter );
 		m_completedJobsMutex.unlock();
-		return nullptr;
+		return retrivedJob;
 	}
 	else
 	{
@@ -119,37 +378,107 @@ Job* JobSystem::RetrieveJob( Job* retrivedJob )
 
 bool JobSystem::HasUnfinishedJob()
 {
-	m_queuedJobsMutex.lock();
-	m_claimedJobsMutex.lock();
-
-	bool flag = !(m_queuedJobs.empty() && m_claimedJobs.empty());
+	return m_unfinishedJobCount > 0;
+}
 
-	m_queuedJobsMutex.unlock();
-	m_claimedJobsMutex.unlock();
+bool JobSystem::IsEmpty()
+{
+	m_completedJobsMutex.lock();
+	bool flag = !(m_unfinishedJobCount == 0 && m_completedJobs.empty());
+	m_completedJobsMutex.unlock();
 
 	return flag;
 }
 
-bool JobSystem::IsEmpty()
+void JobSystem::WaitForCounter( JobCounter const& counter, int targetValue )
 {
-	m_queuedJobsMutex.lock();
-	m_claimedJobsMutex.lock();
-	m_completedJobsMutex.lock();
+	while (counter.GetValue() > targetValue)
+	{
+		Job* claimedJob = ClaimFirstJob();
+		if (claimedJob)
+		{
+			claimedJob->Execute();
+			FinishJob( claimedJob );
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
 
-	bool flag = !(m_queuedJobs.empty() && m_claimedJobs.empty() && m_completedJobs.empty());
+void JobSystem::WaitForJob( JobPriority lowestPriority )
+{
+	std::unique_lock<std::mutex> lock( m_sleepMutex );
+	if (lowestPriority == JobPriority::CRITICAL)
+	{
+		m_sleepingCriticalWorkerCount++;
+		m_criticalSleepCondition.wait( lock, [this]() { return HasClaimableJob( JobPriority::CRITICAL ) || m_isQuitting; } );
+		m_sleepingCriticalWorkerCount--;
+	}
+	else
+	{
+		m_sleepingWorkerCount++;
+		m_sleepCondition.wait( lock, [this, lowestPriority]() { return HasClaimableJob( lowestPriority ) || m_isQuitting; } );
+		m_sleepingWorkerCount--;
+	}
+}
 
-	m_queuedJobsMutex.unlock();
-	m_claimedJobsMutex.unlock();
-	m_completedJobsMutex.unlock();
+void JobSystem::WakeWorker( JobPriority priority )
+{
+	// the sleeping counts are raised under m_sleepMutex before the predicate check, so a zero here means nobody can miss the job
+	if (priority == JobPriority::CRITICAL && m_sleepingCriticalWorkerCount > 0)
+	{
+		m_sleepMutex.lock();
+		m_criticalSleepCondition.notify_one();
+		m_sleepMutex.unlock();
+		return;
+	}
+	if (m_sleepingWorkerCount == 0)
+		return;
 
-	return flag;
+	m_sleepMutex.lock();
+	m_sleepCondition.notify_one();
+	m_sleepMutex.unlock();
+}
+
+PooledJob* JobSystem::AllocatePooledJob()
+{
+	unsigned long long head = m_freePooledJobHead;
+	while (true)
+	{
+		unsigned int slot = (unsigned int)(head & 0xffffffffull);
+		if (slot == 0)
+			return nullptr;
+
+		PooledJob* pooledJob = &m_jobPool[slot - 1];
+		unsigned long long tag = (head >> 32) + 1;
+		unsigned long long newHead = (tag << 32) | pooledJob->m_nextFreeSlot;
+		if (m_freePooledJobHead.compare_exchange_weak( head, newHead ))
+			return pooledJob;
+	}
+}
+
+void JobSystem::FreePooledJob( PooledJob* pooledJob )
+{
+	unsigned int slot = (unsigned int)(pooledJob - m_jobPool) + 1;
+	unsigned long long head = m_freePooledJobHead;
+	while (true)
+	{
+		pooledJob->m_nextFreeSlot = (unsigned int)(head & 0xffffffffull);
+		unsigned long long tag = (head >> 32) + 1;
+		unsigned long long newHead = (tag << 32) | slot;
+		if (m_freePooledJobHead.compare_exchange_weak( head, newHead ))
+			return;
+	}
 }
 
 void JobSystem::CreateNewWorkers( int workerCount )
 {
 	for (int i = 0; i < workerCount; i++)
 	{
-		JobWorker* worker = new JobWorker( i, this );
+		JobPriority lowestPriority = i < m_criticalWorkerCount ? JobPriority::CRITICAL : JobPriority::BACKGROUND;
+		JobWorker* worker = new JobWorker( i, this, lowestPriority );
 		m_workers.push_back( worker );
 	}
 }
@@ -164,8 +493,9 @@ void JobSystem::DestroyWorkers()
 	m_workers.clear();
 }
 
-JobWorker::JobWorker( int id, JobSystem* jobSystem )
+JobWorker::JobWorker( int id, JobSystem* jobSystem, JobPriority lowestPriority )
 	: m_id( id )
+	, m_lowestPriority( lowestPriority )
 	, m_jobSysRef( jobSystem )
 {
 	m_thread = new std::thread( &JobWorker::ThreadMain, this );
@@ -174,13 +504,17 @@ JobWorker::JobWorker( int id, JobSystem* jobSystem )
 JobWorker::~JobWorker()
 {
 	m_thread->join();
+	delete m_thread;
+	m_thread = nullptr;
 }
 
 void JobWorker::ThreadMain()
 {
-	while (!g_jobSystem->m_isQuitting)
+	t_workerIndex = m_id;
+	t_lowestPriority = m_lowestPriority;
+	while (!m_jobSysRef->m_isQuitting)
 	{
-		Job* claimedJob = m_jobSysRef->ClaimFirstJob();
+		Job* claimedJob = m_jobSysRef->ClaimJob( m_id, m_lowestPriority );
 		if (claimedJob)
 		{
 			claimedJob->Execute();
@@ -188,7 +522,7 @@ void JobWorker::ThreadMain()
 		}
 		else
 		{
-			std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+			m_jobSysRef->WaitForJob( m_lowestPriority );
 		}
 	}
 }
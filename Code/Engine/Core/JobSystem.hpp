@@ -2,27 +2,64 @@
 
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <vector>
 #include <deque>
+#include <list>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+class JobWorker;
+class JobSystem;
 
 enum class JobStatus
 {
 	NEW,
+	WAITING,
 	QUEUED,
 	EXECUTING,
 	COMPLETED,
 	RETRIEVED
 };
 
+// Lanes are claimed in order, the main thread never helps with BACKGROUND work
+enum class JobPriority
+{
+	CRITICAL,
+	NORMAL,
+	BACKGROUND,
+	COUNT
+};
+
 struct JobSystemConfig
 {
 	// 0 is not using, -1 is same amount as core
 	int m_workerCount = 0;
+	// workers that only run CRITICAL jobs, at least one worker is always left for the other lanes
+	int m_criticalWorkerCount = 0;
+	// -1 is no limit
+	int m_maxBackgroundJobCount = -1;
+	// jobs queued through QueueLambdaJob, allocated once at startup
+	int m_jobPoolCapacity = 4096;
+};
+
+// Jobs queued with a counter never enter the completed list, the caller owns them again once the counter reaches zero
+class JobCounter
+{
+	friend class JobSystem;
+public:
+	int GetValue() const { return m_value; }
+	bool IsDone() const { return m_value == 0; }
+
+private:
+	std::atomic<int> m_value = 0;
 };
 
 class Job
 {
+	friend class JobSystem;
 public:
 	Job() = default;
 	virtual ~Job() = default;
@@ -33,9 +70,64 @@ public:
 
 	void SetStatus( JobStatus status ) { m_status = status; }
 
+	JobPriority GetPriority() const { return m_priority; }
+
+	// must be called before this job is queued
+	void SetPriority( JobPriority priority ) { m_priority = priority; }
+
+	// must be called before this job is queued, a prerequisite that already finished is ignored
+	void AddDependency( Job* prerequisite );
+
+	// Jobs can be queued again once they completed, a reused job still counts as finished until it is re-armed
+	// Call this before adding dependencies on its next run, QueueNewJob re-arms it otherwise
+	void Rearm();
 
 private:
 	std::atomic<JobStatus> m_status = JobStatus::NEW;
+	JobPriority m_priority = JobPriority::NORMAL;
+
+	// one extra count is held until the job is queued, so a job is released exactly once
+	std::atomic<int> m_pendingDependencies = 1;
+	bool m_hasFinished = false;
+	std::vector<Job*> m_successors;
+	std::mutex m_successorsMutex;
+
+	JobCounter* m_counter = nullptr;
+	std::list<Job*>::iterator m_completedIter;
+
+	bool m_isPooled = false;
+};
+
+// Job slot of the JobSystem pool, the callable is stored inline and destroyed when the job finishes
+class PooledJob : public Job
+{
+	friend class JobSystem;
+public:
+	static constexpr size_t INLINE_STORAGE_SIZE = 64;
+
+	void Execute() override { m_invoke( m_storage ); }
+
+private:
+	alignas(16) unsigned char m_storage[INLINE_STORAGE_SIZE];
+	void (*m_invoke)(void*) = nullptr;
+	void (*m_destroy)(void*) = nullptr;
+
+	std::atomic<unsigned int> m_nextFreeSlot = 0;
+};
+
+// Per-worker deque, the owning worker pushes and pops at the back, other workers steal from the front
+class JobQueue
+{
+public:
+	void Push( Job* job );
+	Job* Pop();
+	Job* Steal();
+
+	bool IsEmpty();
+
+private:
+	std::deque<Job*> m_jobs;
+	std::mutex m_jobsMutex;
 };
 
 class JobSystem
@@ -52,7 +144,31 @@ public:
 	void Shutdown();
 
 public:
-	void QueueNewJob( Job* newJob );
+	void QueueNewJob( Job* newJob, JobCounter* counter = nullptr );
+
+	// Queues a small callable from the job pool, the job is released as soon as it finishes and cannot be retrieved
+	// When the pool is exhausted the callable runs right away on the calling thread
+	template<typename Func>
+	void QueueLambdaJob( Func&& func, JobCounter* counter = nullptr, JobPriority priority = JobPriority::NORMAL )
+	{
+		typedef typename std::decay<Func>::type FuncType;
+		static_assert(sizeof( FuncType ) <= PooledJob::INLINE_STORAGE_SIZE, "Job lambda captures too much to be stored inline");
+		static_assert(alignof(FuncType) <= 16, "Job lambda alignment is too large to be stored inline");
+
+		PooledJob* job = AllocatePooledJob();
+		if (!job)
+		{
+			func();
+			return;
+		}
+
+		new (job->m_storage) FuncType( std::forward<Func>( func ) );
+		job->m_invoke = []( void* storage ) { (*static_cast<FuncType*>(storage))(); };
+		job->m_destroy = []( void* storage ) { static_cast<FuncType*>(storage)->~FuncType(); };
+		job->SetPriority( priority );
+		QueueNewJob( job, counter );
+	}
+
 	Job* ClaimFirstJob();
 	void FinishJob( Job* finishedJob );
 	Job* RetrieveJob( Job* retrivedJob = nullptr );
@@ -61,10 +177,26 @@ public:
 
 	bool IsEmpty();
 
+	// runs queued jobs on the calling thread until the counter drops to targetValue
+	void WaitForCounter( JobCounter const& counter, int targetValue = 0 );
+
+	int GetWorkerCount() const { return (int)m_workers.size(); }
+
 private:
 	void CreateNewWorkers( int workerCount );
 	void DestroyWorkers();
 
+	PooledJob* AllocatePooledJob();
+	void FreePooledJob( PooledJob* pooledJob );
+
+	void SubmitReadyJob( Job* readyJob );
+	void ReleaseDependency( Job* dependentJob );
+	Job* ClaimJob( int queueIndex, JobPriority lowestPriority );
+	Job* ClaimJobFromLane( int queueIndex, JobPriority priority );
+	bool HasClaimableJob( JobPriority lowestPriority ) const;
+	void WaitForJob( JobPriority lowestPriority );
+	void WakeWorker( JobPriority priority );
+
 private:
 	JobSystemConfig m_config;
 
@@ -72,30 +204,43 @@ private:
 
 	std::vector<JobWorker*> m_workers;
 
-	std::deque<Job*> m_queuedJobs;
-	std::mutex m_queuedJobsMutex;
+	// one queue per worker in every lane
+	std::vector<JobQueue*> m_queues[(int)JobPriority::COUNT];
+	std::atomic<unsigned int> m_nextQueueIndex = 0;
+	int m_criticalWorkerCount = 0;
 
-	std::deque<Job*> m_claimedJobs;
-	std::mutex m_claimedJobsMutex;
+	std::atomic<int> m_queuedJobCount[(int)JobPriority::COUNT] = {};
+	std::atomic<int> m_unfinishedJobCount = 0;
+	// CRITICAL jobs from QueueNewJob until FinishJob, waiting, queued or running
+	std::atomic<int> m_unfinishedCriticalJobCount = 0;
+	std::atomic<int> m_runningBackgroundJobCount = 0;
 
-	std::deque<Job*> m_completedJobs;
-	std::mutex m_completedJobsMutex;
+	std::mutex m_sleepMutex;
+	std::condition_variable m_sleepCondition;
+	std::condition_variable m_criticalSleepCondition;
+	std::atomic<int> m_sleepingWorkerCount = 0;
+	std::atomic<int> m_sleepingCriticalWorkerCount = 0;
 
-// 	std::deque<Job*> m_retrivedJobs;
-// 	std::mutex m_retrivedJobsMutex;
+	// lock free stack of free slots, the high 32 bits are a tag against ABA and the low 32 bits are slot index + 1
+	PooledJob* m_jobPool = nullptr;
+	std::atomic<unsigned long long> m_freePooledJobHead = 0;
+
+	std::list<Job*> m_completedJobs;
+	std::mutex m_completedJobsMutex;
 };
 
 class JobWorker
 {
 	friend class JobSystem;
 public:
-	JobWorker( int id, JobSystem* );
+	JobWorker( int id, JobSystem*, JobPriority lowestPriority = JobPriority::BACKGROUND );
 	~JobWorker();
 
 	void ThreadMain();
 
 private:
 	int m_id;
+	JobPriority m_lowestPriority = JobPriority::BACKGROUND;
 	JobSystem* m_jobSysRef;
 	std::thread* m_thread = nullptr;
 };
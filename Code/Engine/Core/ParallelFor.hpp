@@ -0,0 +1,123 @@
+#pragma once
+
+#include <vector>
+
+#include "Engine/Core/JobSystem.hpp"
+
+extern JobSystem* g_jobSystem;
+
+template<typename T, typename MapFunc, typename ReduceFunc>
+class ParallelReduceJob : public Job
+{
+public:
+	void Execute() override
+	{
+		for (int i = m_begin; i < m_end; i++)
+		{
+			m_result = (*m_reduce)( m_result, (*m_map)( i ) );
+		}
+	}
+
+	int m_begin = 0;
+	int m_end = 0;
+	T m_result;
+	MapFunc const* m_map = nullptr;
+	ReduceFunc const* m_reduce = nullptr;
+};
+
+// Chunks that run on the calling thread plus the workers, capped so tiny grain sizes do not flood the queues
+inline int GetParallelChunkCount( int begin, int end, int grainSize )
+{
+	if (end <= begin)
+		return 0;
+	int workerCount = g_jobSystem ? g_jobSystem->GetWorkerCount() : 0;
+	if (workerCount == 0)
+		return 1;
+	if (grainSize < 1)
+		grainSize = 1;
+
+	int chunkCount = (end - begin + grainSize - 1) / grainSize;
+	int maxChunkCount = (workerCount + 1) * 4;
+	return chunkCount < maxChunkCount ? chunkCount : maxChunkCount;
+}
+
+// Calls fn( i ) for every i in [begin, end) and returns once all of them are done, the caller runs jobs instead of sleeping
+template<typename Func>
+void ParallelFor( int begin, int end, int grainSize, Func const& fn )
+{
+	int chunkCount = GetParallelChunkCount( begin, end, grainSize );
+	if (chunkCount <= 1)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			fn( i );
+		}
+		return;
+	}
+
+	int count = end - begin;
+	JobCounter counter;
+	for (int chunkIndex = 1; chunkIndex < chunkCount; chunkIndex++)
+	{
+		int chunkBegin = begin + (int)((long long)count * chunkIndex / chunkCount);
+		int chunkEnd = begin + (int)((long long)count * (chunkIndex + 1) / chunkCount);
+		Func const* func = &fn;
+		g_jobSystem->QueueLambdaJob( [chunkBegin, chunkEnd, func]()
+			{
+				for (int i = chunkBegin; i < chunkEnd; i++)
+				{
+					(*func)( i );
+				}
+			}, &counter );
+	}
+
+	int firstChunkEnd = begin + (int)((long long)count / chunkCount);
+	for (int i = begin; i < firstChunkEnd; i++)
+	{
+		fn( i );
+	}
+	g_jobSystem->WaitForCounter( counter );
+}
+
+// Folds reduce( partial, map( i ) ) over [begin, end), partials are combined in index order so the result is deterministic
+template<typename T, typename MapFunc, typename ReduceFunc>
+T ParallelReduce( int begin, int end, int grainSize, T const& identity, MapFunc const& map, ReduceFunc const& reduce )
+{
+	int chunkCount = GetParallelChunkCount( begin, end, grainSize );
+	if (chunkCount <= 1)
+	{
+		T result = identity;
+		for (int i = begin; i < end; i++)
+		{
+			result = reduce( result, map( i ) );
+		}
+		return result;
+	}
+
+	std::vector<ParallelReduceJob<T, MapFunc, ReduceFunc>> jobs( chunkCount );
+	int count = end - begin;
+	JobCounter counter;
+	for (int chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+	{
+		ParallelReduceJob<T, MapFunc, ReduceFunc>& job = jobs[chunkIndex];
+		job.m_begin = begin + (int)((long long)count * chunkIndex / chunkCount);
+		job.m_end = begin + (int)((long long)count * (chunkIndex + 1) / chunkCount);
+		job.m_result = identity;
+		job.m_map = &map;
+		job.m_reduce = &reduce;
+		if (chunkIndex > 0)
+		{
+			g_jobSystem->QueueNewJob( &job, &counter );
+		}
+	}
+
+	jobs[0].Execute();
+	g_jobSystem->WaitForCounter( counter );
+
+	T result = identity;
+	for (int chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+	{
+		result = reduce( result, jobs[chunkIndex].m_result );
+	}
+	return result;
+}
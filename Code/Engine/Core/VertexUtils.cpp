@@ -2,6 +2,7 @@
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/ParallelFor.hpp"
 
 #include <vector>
 
@@ -26,18 +27,18 @@ void TransformVertexArrayXY3D( std::vector<Vertex_PCU> &verts, float uniformScal
 
 void TransformVertexArray3D( std::vector<Vertex_PCU>& verts, Mat44 const& transform )
 {
-	for (Vertex_PCU& vert : verts)
-	{
-		vert.m_position = transform.TransformPosition3D( vert.m_position );
-	}
+	ParallelFor( 0, (int)verts.size(), 4096, [&]( int i )
+		{
+			verts[i].m_position = transform.TransformPosition3D( verts[i].m_position );
+		} );
 }
 
 void TransformVertexArray3D( std::vector<Vertex_PCUTBN>& verts, Mat44 const& transform )
 {
-	for (Vertex_PCUTBN& vert : verts)
-	{
-		vert.m_position = transform.TransformPosition3D( vert.m_position );
-	}
+	ParallelFor( 0, (int)verts.size(), 4096, [&]( int i )
+		{
+			verts[i].m_position = transform.TransformPosition3D( verts[i].m_position );
+		} );
 }
 
 void CalculateTangantSpaceBasisVectors( std::vector<Vertex_PCUTBN>& vertexes, std::vector<unsigned int>& indexes, bool computeNormals, bool computeTangents )
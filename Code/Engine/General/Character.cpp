@@ -5,6 +5,7 @@
 #include "Engine/General/Character.hpp"
 
 #include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/RenderQueue.hpp"
 #include "Engine/General/SkeletalMesh.hpp"
 #include "Engine/Animation/AnimationSequence.hpp"
 #include "Engine/Animation/AnimationController.hpp"
@@ -19,6 +20,7 @@
 #include "Engine/Model/ModelUtility.hpp"
 #include "Engine/General/SkeletalMeshComponent.hpp"
 #include "Engine/Animation/IKSolver.hpp"
+#include "Engine/Animation/AnimationPipeline.hpp"
 #include "Engine/Math/MathUtils.hpp"
 
 Character::Character()
@@ -121,6 +123,21 @@ Vec3 Character::GetGroundProbePositionAt( Vec3 const& actorWorldPosition ) const
 
 void Character::Update( float deltaSeconds )
 {
+	UpdateBeforePose( deltaSeconds );
+
+	PoseRequest request;
+	if (GetPoseRequest( request ))
+	{
+		SkeletalPoseScratch scratch;
+		EvaluatePoseRequest( request, scratch );
+	}
+
+	UpdateAfterPose( deltaSeconds );
+}
+
+void Character::UpdateBeforePose( float deltaSeconds )
+{
+	m_isPosePending = false;
 	if (m_controller)
 	{
 		m_controller->Update( deltaSeconds );
@@ -158,17 +175,7 @@ void Character::Update( float deltaSeconds )
 					SetActorLocalOrientation( GetActorLocalOrientation() * rootRotation );
 				}
 				GetSkeletalMesh()->Update();
-				AnimationStateMachine* animStateMachine = m_animController->GetStateMachine();
-				float currentTimeSeconds = animStateMachine->GetOngoingAnimation( 0 ).GetCurrentAnimationPlaybackTime();
-				
-				float previousTimeSecond = animStateMachine->GetOngoingAnimation( 0 ).GetPreviousAnimationPlaybackTime();
-				AnimationSequence* previousAnimaiton = (animStateMachine->GetOngoingAnimation( 0 ).GetPreviousState()) ? animStateMachine->GetOngoingAnimation( 0 ).GetPreviousState()->GetAnimation() : nullptr;
-				float crossfadeAlpha = animStateMachine->GetOngoingAnimation( 0 ).GetCrossfadeAlpha();
-				GetSkeletalMesh()->UpdateJoints( GetSkeletalMeshComponent()->GetSkeletonGlobalTransform(), currentTimeSeconds, currentAnimation, previousTimeSecond, previousAnimaiton, crossfadeAlpha );
-				if (!IsStepping())
-				{
-					ComponentCollisionCheck();
-				}
+				m_isPosePending = true;
 			}
 		}
 		return;
@@ -210,8 +217,39 @@ void Character::Update( float deltaSeconds )
 	if (GetSkeletalMesh())
 	{
 		GetSkeletalMesh()->Update();
-		GetSkeletalMesh()->UpdateJoints( GetSkeletalMeshComponent()->GetSkeletonGlobalTransform(), m_animController->GetStateMachine() );
+	}
+	m_isPosePending = true;
+}
+
+bool Character::GetPoseRequest( PoseRequest& out_request ) const
+{
+	if (!m_isPosePending || !GetSkeletalMesh())
+		return false;
+
+	out_request.m_skeletalMesh = GetSkeletalMesh();
+	out_request.m_globalTransforms = &GetSkeletalMeshComponent()->GetSkeletonGlobalTransform();
+	out_request.m_stateMachine = m_animController->GetStateMachine();
+	out_request.m_baseLayerOnly = m_controller == nullptr;
+	return true;
+}
 
+void Character::UpdateAfterPose( float deltaSeconds )
+{
+	if (!m_isPosePending)
+		return;
+	m_isPosePending = false;
+
+	if (!m_controller)
+	{
+		if (!IsStepping())
+		{
+			ComponentCollisionCheck();
+		}
+		return;
+	}
+
+	if (GetSkeletalMesh())
+	{
 // 		for (int i = 0; i < GetSkeletalMesh()->m_skeleton.m_joints.size(); i++)
 // 		{
 // 			Mat44 globalTransform = GetSkeletalMesh()->m_skeleton.m_joints[i].m_globalBindposeInverse.GetInverse();
@@ -334,6 +372,20 @@ void Character::Render() const
 	GetSkeletalMeshComponent()->Render();
 }
 
+void Character::Submit( RenderQueue& queue, float viewDepth ) const
+{
+	SkeletalMesh* skeletalMesh = GetSkeletalMesh();
+	if (!skeletalMesh)
+		return;
+
+	RenderCommand command;
+	command.m_depth = viewDepth;
+	command.m_modelMatrix = GetSkeletalMeshComponent()->GetWorldTransform();
+	command.m_jointTransforms = &GetSkeletalMeshComponent()->GetSkeletonGlobalTransform();
+	command.m_joints = &skeletalMesh->GetSkeleton().m_joints;
+	skeletalMesh->Submit( queue, command );
+}
+
 void Character::InitializeAllCollisions()
 {
 	InitializeCollisionComponents();
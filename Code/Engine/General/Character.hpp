@@ -19,10 +19,12 @@ class AnimationController;
 class MeshT;
 class Texture;
 class Renderer;
+class RenderQueue;
 class Controller;
 class ShapeComponent;
 class CharacterMovementComponent;
 struct CollisionInfo;
+struct PoseRequest;
 
 class Character : public Actor
 {
@@ -76,13 +78,24 @@ protected:
 	float m_movementSpeed = 1.f;
 	float m_sprintParam = 2.f;
 
+	// set by UpdateBeforePose when it got far enough for the pose and the stage after it to run
+	bool m_isPosePending = false;
+
 	bool m_isUsingIK = false;
 	float m_leftFootGroundHeight = 0.f;
 	float m_rightFootGroundHeight = 0.f;
 
 public:
 	virtual void Update( float deltaSeconds ) override;
+	// Update split around the pose so AnimationPipeline can evaluate a crowd's poses on JobSystem workers, Update runs them in order
+	// Before the pose: controller, animation state and root motion. After it: foot IK, collision and physics
+	void UpdateBeforePose( float deltaSeconds );
+	// false when the last UpdateBeforePose left nothing to pose
+	bool GetPoseRequest( PoseRequest& out_request ) const;
+	void UpdateAfterPose( float deltaSeconds );
 	virtual void Render() const override;
+	// Queues every visible mesh with this character's model and joint constants, viewDepth orders translucent draws
+	void Submit( RenderQueue& queue, float viewDepth = 0.f ) const;
 
 	virtual void InitializeAllCollisions();
 
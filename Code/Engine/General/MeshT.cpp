@@ -5,6 +5,7 @@
 #include "Engine/Renderer/IndexBuffer.hpp"
 #include "Engine/Renderer/Material.hpp"
 #include "Engine/Renderer/Shader.hpp"
+#include "Engine/Renderer/RenderQueue.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 
 #include "Engine/Core/DebugRenderSystem.hpp"
@@ -43,11 +44,17 @@ void MeshT::Update( float deltaSeconds )
 	UNUSED( deltaSeconds );
 }
 
+// Looked up in the renderer's shader cache every time, so a renderer restart never leaves a stale pointer behind
+static Shader* GetFallbackMeshShader()
+{
+	return g_theRenderer->CreateShader( "Data/Shaders/Diffuse.hlsl", VertexType::VERTEX_PCUTBN );
+}
+
 void MeshT::Render() const
 {
 	if (!material->m_shader)
 	{
-		g_theRenderer->BindShader( g_theRenderer->CreateShader( "Data/Shaders/Diffuse.hlsl", VertexType::VERTEX_PCUTBN ) );
+		g_theRenderer->BindShader( GetFallbackMeshShader() );
 		g_theRenderer->BindTexture( material->m_diffuseMap, 0 );
 	}
 	else
@@ -61,6 +68,47 @@ void MeshT::Render() const
 			g_theRenderer->BindTexture( material->m_specGlossEmitMap, 2 );
 	}
 
+	CreateBuffersIfNeeded();
+
+	if (material->m_shader && material->m_vertexType == VertexType::VERTEX_ANIM)
+		g_theRenderer->DrawVertexAndIndexBuffer( vertexBuffer, jointBuffer, indexBuffer, (int)indexes.size() );
+	else
+		g_theRenderer->DrawVertexAndIndexBuffer( vertexBuffer, indexBuffer, (int)indexes.size(), VertexType::VERTEX_PCUTBN );
+}
+
+void MeshT::Submit( RenderQueue& queue, RenderCommand const& baseCommand ) const
+{
+	CreateBuffersIfNeeded();
+	if (!vertexBuffer || !indexBuffer)
+		return;
+
+	RenderCommand command = baseCommand;
+	command.m_material = material;
+	command.m_vertexBuffer = vertexBuffer;
+	command.m_indexBuffer = indexBuffer;
+	command.m_count = (int)indexes.size();
+	command.m_vertexType = VertexType::VERTEX_PCUTBN;
+	if (!material->m_shader)
+	{
+		command.m_shader = GetFallbackMeshShader();
+		command.m_textures[0] = material->m_diffuseMap;
+	}
+	else
+	{
+		command.m_shader = material->m_shader;
+		command.m_textures[0] = material->m_diffuseMap;
+		command.m_textures[1] = material->m_normalMap;
+		command.m_textures[2] = material->m_specGlossEmitMap;
+		if (material->m_vertexType == VertexType::VERTEX_ANIM)
+		{
+			command.m_jointBuffer = jointBuffer;
+		}
+	}
+	queue.Submit( command );
+}
+
+void MeshT::CreateBuffersIfNeeded() const
+{
 	if (material->m_shader)
 	{
 		if (material->m_vertexType == VertexType::VERTEX_ANIM)
@@ -99,11 +147,6 @@ void MeshT::Render() const
 			g_theRenderer->CopyCPUToGPU( vertexes.data(), vertexes.size(), vertexBuffer, indexes.data(), indexes.size(), indexBuffer );
 		}
 	}
-
-	if (material->m_shader && material->m_vertexType == VertexType::VERTEX_ANIM)
-		g_theRenderer->DrawVertexAndIndexBuffer( vertexBuffer, jointBuffer, indexBuffer, (int)indexes.size() );
-	else
-		g_theRenderer->DrawVertexAndIndexBuffer( vertexBuffer, indexBuffer, (int)indexes.size(), VertexType::VERTEX_PCUTBN );
 }
 
 void MeshT::DebugRender()
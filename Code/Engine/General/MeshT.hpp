@@ -13,6 +13,8 @@ class Texture;
 class AnimationSequence;
 class Renderer;
 class Material;
+class RenderQueue;
+struct RenderCommand;
 
 class MeshT
 {
@@ -34,10 +36,15 @@ public:
 
 	virtual void Update( float deltaSeconds );
 	virtual void Render() const;
+	// Queues this mesh on top of baseCommand, which carries the pass, states and model constants
+	void Submit( RenderQueue& queue, RenderCommand const& baseCommand ) const;
 	virtual void DebugRender();
 
 	virtual void SetMaterial( Material* const& pMaterial );
 
+protected:
+	void CreateBuffersIfNeeded() const;
+
 protected:
 	float m_currentTimeSecond = 0.f;
 	int m_debugVertSize = 0;
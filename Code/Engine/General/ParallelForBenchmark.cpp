@@ -0,0 +1,181 @@
+#include "Engine/General/ParallelForBenchmark.hpp"
+#include "Engine/Core/ParallelFor.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/VertexUtils.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Animation/AnimationSequence.hpp"
+#include "Engine/General/ParticleSystem/Particle.hpp"
+#include "Engine/General/ParticleSystem/ParticleEmitter.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+#include <cmath>
+#include <cstring>
+
+static void PrintBenchmarkResult( char const* name, int itemCount, double serialSeconds, double parallelSeconds, bool isMatching )
+{
+	double serialRate = serialSeconds > 0.0 ? (double)itemCount / serialSeconds : 0.0;
+	double parallelRate = parallelSeconds > 0.0 ? (double)itemCount / parallelSeconds : 0.0;
+	double speedup = parallelSeconds > 0.0 ? serialSeconds / parallelSeconds : 0.0;
+	PrintBenchmarkLine( Stringf( "%-22s serial %8.3fms (%.1fM/s)  parallel %8.3fms (%.1fM/s)  x%.2f  %s",
+		name, serialSeconds * 1000.0, serialRate / 1000000.0, parallelSeconds * 1000.0, parallelRate / 1000000.0, speedup,
+		isMatching ? "match" : "MISMATCH" ) );
+}
+
+void RunParallelForBenchmark( int itemCount )
+{
+	int workerCount = g_jobSystem ? g_jobSystem->GetWorkerCount() : 0;
+	PrintBenchmarkLine( Stringf( "ParallelFor benchmark: %d items, %d workers", itemCount, workerCount ) );
+
+	// ParticleEmitter::Update
+	{
+		EmitDef emitDef = {};
+		emitDef.minLifetime = emitDef.maxLifetime = 1000.f;
+		emitDef.minSize = emitDef.maxSize = 1.f;
+		emitDef.minSpeed = emitDef.maxSpeed = 1.f;
+		emitDef.direction = Vec3( 1.f, 0.f, 0.f );
+		emitDef.startAlpha = emitDef.endAlpha = 255.f;
+		emitDef.endAlphaTime = emitDef.endSpeedTime = emitDef.endScaleTime = 1.f;
+		emitDef.startSpeed = emitDef.endSpeed = 1.f;
+		emitDef.startScale = emitDef.endScale = 1.f;
+
+		// each pass gets particles allocated right before it, so both start from the same cache state
+		std::vector<Particle*> serialParticles;
+		serialParticles.reserve( itemCount );
+		for (int i = 0; i < itemCount; i++)
+		{
+			serialParticles.push_back( new Particle( &emitDef, Vec3( (float)i, 0.f, 0.f ) ) );
+		}
+
+		Mat44 cameraMatrix;
+		double startTime = GetCurrentTimeSeconds();
+		for (Particle* particle : serialParticles)
+		{
+			particle->Update( 0.001f, cameraMatrix );
+		}
+		double serialSeconds = GetCurrentTimeSeconds() - startTime;
+
+		std::vector<Particle*> parallelParticles;
+		parallelParticles.reserve( itemCount );
+		for (int i = 0; i < itemCount; i++)
+		{
+			parallelParticles.push_back( new Particle( &emitDef, Vec3( (float)i, 0.f, 0.f ) ) );
+		}
+
+		startTime = GetCurrentTimeSeconds();
+		ParallelFor( 0, itemCount, 256, [&]( int i )
+			{
+				parallelParticles[i]->Update( 0.001f, cameraMatrix );
+			} );
+		double parallelSeconds = GetCurrentTimeSeconds() - startTime;
+
+		bool isMatching = true;
+		for (int i = 0; i < itemCount; i++)
+		{
+			Particle const& serialParticle = *serialParticles[i];
+			Particle const& parallelParticle = *parallelParticles[i];
+			if (serialParticle.m_position != parallelParticle.m_position || serialParticle.m_lifetime != parallelParticle.m_lifetime)
+			{
+				isMatching = false;
+				break;
+			}
+		}
+		PrintBenchmarkResult( "Particle Update", itemCount, serialSeconds, parallelSeconds, isMatching );
+
+		for (int i = 0; i < itemCount; i++)
+		{
+			delete serialParticles[i];
+			delete parallelParticles[i];
+		}
+	}
+
+	// TransformVertexArray3D
+	{
+		std::vector<Vertex_PCU> sourceVerts( itemCount * 4 );
+		for (int i = 0; i < (int)sourceVerts.size(); i++)
+		{
+			sourceVerts[i].m_position = Vec3( (float)i, (float)(i % 7), (float)(i % 13) );
+		}
+		Mat44 transform = Mat44::CreateTranslation3D( Vec3( 1.f, 2.f, 3.f ) );
+
+		// each pass gets its own copy made right before it, so both start from the same cache state
+		std::vector<Vertex_PCU> serialVerts = sourceVerts;
+		double startTime = GetCurrentTimeSeconds();
+		for (Vertex_PCU& vert : serialVerts)
+		{
+			vert.m_position = transform.TransformPosition3D( vert.m_position );
+		}
+		double serialSeconds = GetCurrentTimeSeconds() - startTime;
+
+		std::vector<Vertex_PCU> parallelVerts = sourceVerts;
+		startTime = GetCurrentTimeSeconds();
+		TransformVertexArray3D( parallelVerts, transform );
+		double parallelSeconds = GetCurrentTimeSeconds() - startTime;
+
+		bool isMatching = memcmp( serialVerts.data(), parallelVerts.data(), serialVerts.size() * sizeof( Vertex_PCU ) ) == 0;
+		PrintBenchmarkResult( "TransformVertexArray3D", (int)sourceVerts.size(), serialSeconds, parallelSeconds, isMatching );
+	}
+
+	// joint interpolation, the per joint work of SkeletalMesh::UpdateJoints
+	{
+		std::vector<JointPose> keysA( itemCount );
+		std::vector<JointPose> keysB( itemCount );
+		std::vector<Mat44> results( itemCount );
+		for (int i = 0; i < itemCount; i++)
+		{
+			Mat44 keyTransform = Mat44::CreateTranslation3D( Vec3( (float)i, 0.f, 0.f ) );
+			keyTransform.AppendZRotation( (float)(i % 360) );
+			keysB[i] = JointPose( keyTransform );
+		}
+
+		std::vector<Mat44> serialResults( itemCount );
+		double startTime = GetCurrentTimeSeconds();
+		for (int i = 0; i < itemCount; i++)
+		{
+			serialResults[i] = JointPose::Interpolate( keysA[i], keysB[i], 0.5f ).ToMatrix();
+		}
+		double serialSeconds = GetCurrentTimeSeconds() - startTime;
+
+		startTime = GetCurrentTimeSeconds();
+		ParallelFor( 0, itemCount, 128, [&]( int i )
+			{
+				results[i] = JointPose::Interpolate( keysA[i], keysB[i], 0.5f ).ToMatrix();
+			} );
+		double parallelSeconds = GetCurrentTimeSeconds() - startTime;
+
+		bool isMatching = memcmp( serialResults.data(), results.data(), results.size() * sizeof( Mat44 ) ) == 0;
+		PrintBenchmarkResult( "Joint Interpolate", itemCount, serialSeconds, parallelSeconds, isMatching );
+
+		startTime = GetCurrentTimeSeconds();
+		double serialSum = 0.0;
+		for (int i = 0; i < itemCount; i++)
+		{
+			serialSum += (double)results[i].GetTranslation3D().x;
+		}
+		serialSeconds = GetCurrentTimeSeconds() - startTime;
+
+		startTime = GetCurrentTimeSeconds();
+		double parallelSum = ParallelReduce( 0, itemCount, 1024, 0.0,
+			[&]( int i ) { return (double)results[i].GetTranslation3D().x; },
+			[]( double a, double b ) { return a + b; } );
+		parallelSeconds = GetCurrentTimeSeconds() - startTime;
+
+		// the chunks add in another order, so the sums only agree up to rounding
+		isMatching = fabs( serialSum - parallelSum ) <= 1e-9 * fabs( serialSum );
+		PrintBenchmarkResult( "Reduce Translation", itemCount, serialSeconds, parallelSeconds, isMatching );
+	}
+}
+
+bool Command_ParallelForBenchmark()
+{
+	RunParallelForBenchmark( 200000 );
+	return false;
+}
+
+void ParallelForBenchmarkStartup()
+{
+	if (g_eventSystem != nullptr)
+	{
+		g_eventSystem->SubscribeEventCallBackFunc( "ParallelForBenchmark", &Command_ParallelForBenchmark );
+	}
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// Times serial against ParallelFor versions of the particle, vertex transform and joint interpolation loops
+// Lives above Core so it can drive the particle and animation systems
+void RunParallelForBenchmark( int itemCount );
+bool Command_ParallelForBenchmark();
+// Registers the benchmark command, call from app startup once the event system exists
+void ParallelForBenchmarkStartup();
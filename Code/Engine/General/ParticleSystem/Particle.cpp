@@ -70,7 +70,12 @@ void Particle::Update( float deltaSeconds, Mat44 const& cameraMatrix )
 
 void Particle::Render() const
 {
-	g_theRenderer->BindShader( g_theRenderer->CreateShader( m_emitDef->shader.c_str(), VertexType::VERTEX_PCU ) );
-	g_theRenderer->BindTexture( g_theRenderer->CreateOrGetTextureFromFile( m_emitDef->texture.c_str() ) );
+	if (!m_emitDef->shaderResource)
+	{
+		m_emitDef->shaderResource = g_theRenderer->CreateShader( m_emitDef->shader.c_str(), VertexType::VERTEX_PCU );
+		m_emitDef->textureResource = g_theRenderer->CreateOrGetTextureFromFile( m_emitDef->texture.c_str() );
+	}
+	g_theRenderer->BindShader( m_emitDef->shaderResource );
+	g_theRenderer->BindTexture( m_emitDef->textureResource );
 	g_theRenderer->DrawVertexArray( m_quad );
 }
@@ -1,6 +1,7 @@
 #include "Engine/General/ParticleSystem/ParticleEmitter.hpp"
 #include "Engine/General/ParticleSystem/Particle.hpp"
 #include "Engine/Core/XmlUtils.hpp"
+#include "Engine/Core/ParallelFor.hpp"
 
 std::unordered_map<std::string, std::vector<EmitDef>> ParticleEmitter::s_emitDefinitions;
 
@@ -120,17 +121,18 @@ void ParticleEmitter::Emit( Vec3 direction )
 
 void ParticleEmitter::Update( float deltaSeconds, Mat44 const& cameraMatrix )
 {
-	for (auto& particle : m_particles)
-	{
-		if (!particle) continue;
-
-		particle->Update( deltaSeconds, cameraMatrix );
-		if (particle->m_lifetime >= particle->m_maxLifetime)
+	ParallelFor( 0, (int)m_particles.size(), 256, [&]( int i )
 		{
-			delete particle;
-			particle = nullptr;
-		}
-	}
+			Particle*& particle = m_particles[i];
+			if (!particle) return;
+
+			particle->Update( deltaSeconds, cameraMatrix );
+			if (particle->m_lifetime >= particle->m_maxLifetime)
+			{
+				delete particle;
+				particle = nullptr;
+			}
+		} );
 }
 
 void ParticleEmitter::Render() const
@@ -8,6 +8,9 @@
 #include "Engine/Core/Rgba8.hpp"
 #include "Engine/Math/Mat44.hpp"
 
+class Texture;
+class Shader;
+
 struct EmitDef 
 {
 	std::string name;
@@ -30,6 +33,10 @@ struct EmitDef
 	float startSpeedTime, endSpeedTime;
 	float startScale, endScale;
 	float startScaleTime, endScaleTime;
+
+	// looked up from texture and shader on the first render
+	Texture* textureResource = nullptr;
+	Shader* shaderResource = nullptr;
 };
 
 class Particle;
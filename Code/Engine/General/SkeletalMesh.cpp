@@ -13,6 +13,8 @@
 #include "Engine/Renderer/IndexBuffer.hpp"
 #include "Engine/General/Character.hpp"
 #include "Engine/Core/XmlUtils.hpp"
+#include "Engine/Core/FileUtil.hpp"
+#include "Engine/Binary/BinaryUtil.hpp"
 #include "Engine/Renderer/Material.hpp"
 #include "Engine/Renderer/Shader.hpp"
 #include "Engine/Animation/AnimationController.hpp"
@@ -22,6 +24,14 @@
 namespace
 {
 constexpr float FOOT_IK_EPSILON = 0.0001f;
+constexpr unsigned int SKELETAL_MESH_MAGIC = 0x4D4B5345; // "ESKM"
+constexpr unsigned int SKELETAL_MESH_VERSION = 1;
+constexpr size_t SKELETAL_MESH_ARRAY_ALIGNMENT = 16;
+
+// the arrays are copied byte for byte, these layouts are part of the file format
+static_assert(sizeof( Vertex_PCUTBN ) == 60, "vertexes are stored packed");
+static_assert(sizeof( Vertex_Anim ) == 32, "joint influences are stored packed");
+static_assert(sizeof( Mat44 ) == 64, "bind poses are stored as sixteen floats");
 
 Vec3 GetSafeNormalized( Vec3 const& vector, Vec3 const& fallback )
 {
@@ -82,6 +92,42 @@ Quat GetFromToRotation( Vec3 const& fromDir, Vec3 const& toDir, Vec3 const& fall
 	axis = GetSafeNormalized( axis, Vec3( 1.f, 0.f, 0.f ) );
 	return Quat( axis, ACosDegrees( dot ) ).GetNormalized();
 }
+
+// Shared by the XML and binary importers, empty paths leave their slot unset
+Material* CreateImportedMaterial( std::string const& name, VertexType vertexType, Rgba8 const& color, std::string const& shaderPath,
+	std::string const& diffuseTexturePath, std::string const& normalTexturePath, std::string const& specTexturePath, std::string const& transparencyPath )
+{
+	Material* material = new Material;
+	material->m_name = name;
+	material->m_vertexType = vertexType;
+	material->m_color = color;
+	if (shaderPath != "")
+	{
+		material->m_shader = g_theRenderer->CreateShader( shaderPath.c_str(), vertexType );
+	}
+	if (diffuseTexturePath != "")
+	{
+		material->m_diffuseMap = g_theRenderer->CreateOrGetTextureFromFile( diffuseTexturePath.c_str() );
+	}
+	if (normalTexturePath != "")
+	{
+		material->m_normalMap = g_theRenderer->CreateOrGetTextureFromFile( normalTexturePath.c_str(), TextureUsage::NORMAL_MAP );
+	}
+	if (specTexturePath != "")
+	{
+		material->m_specGlossEmitMap = g_theRenderer->CreateOrGetTextureFromFile( specTexturePath.c_str(), TextureUsage::LINEAR );
+	}
+	if (transparencyPath != "")
+	{
+		material->m_transparencyMap = g_theRenderer->CreateOrGetTextureFromFile( transparencyPath.c_str() );
+	}
+	return material;
+}
+
+std::string GetTextureFilePath( Texture const* texture )
+{
+	return texture ? texture->GetImageFilePath() : std::string();
+}
 }
 
 SkeletalMesh::SkeletalMesh()
@@ -141,6 +187,17 @@ void SkeletalMesh::Render()
 	}
 }
 
+void SkeletalMesh::Submit( RenderQueue& queue, RenderCommand const& baseCommand ) const
+{
+	for (int i = 0; i < m_meshes.size(); i++)
+	{
+		if (m_meshes[i].isVisible)
+		{
+			m_meshes[i].Submit( queue, baseCommand );
+		}
+	}
+}
+
 void SkeletalMesh::SetVisibility( bool flag, int index )
 {
 	if (index == -1)
@@ -167,177 +224,117 @@ int SkeletalMesh::GetJointIndexByName( std::string name )
 	return m_jointIndexCheckList[name];
 }
 
-void SkeletalMesh::InterpolateKeyFrames( KeyFrame const* keyframeA, KeyFrame const* keyframeB, float factor, Mat44& interpolatedTransform )
+void SkeletalMesh::UpdateJoints( std::vector<Mat44>& globalTransforms, float currentTime, AnimationSequence* currentAnimation, float previousTime/* = 0.f*/, AnimationSequence* previousAnimation/* = nullptr*/, float alpha/* = 0.f*/ )
 {
-	if (!keyframeA)
-	{
-		interpolatedTransform = keyframeB->m_globalTransform;
-		return;
-	}
-	if (!keyframeB)
-	{
-		interpolatedTransform = keyframeA->m_globalTransform;
-		return;
-	}
-//  	interpolatedTransform = keyframeB->m_globalTransform;
-//  	return;
-	interpolatedTransform = Mat44::Interpolate( keyframeA->m_globalTransform, keyframeB->m_globalTransform, factor );
+	SkeletalPoseScratch scratch;
+	EvaluatePose( globalTransforms, scratch, currentTime, currentAnimation, previousTime, previousAnimation, alpha );
 }
 
-void SkeletalMesh::CrossfadeInterpolateTransform( KeyFrame* leaveKeyframeBegin, float leaveFrameRate, float animationLeaveTimer, KeyFrame* enterKeyframeBegin, float enterFrameRate, float animationEnterTimer, float factor, Mat44& interpolatedTransform )
+void SkeletalMesh::UpdateJoints( std::vector<Mat44>& globalTransforms, AnimationStateMachine* animStateMachine )
 {
-	Mat44 animationEnterTransform;
-	InterpolateTransform( enterKeyframeBegin, enterFrameRate, animationEnterTimer, animationEnterTransform );
-	if (leaveKeyframeBegin)
-	{
-		Mat44 animationLeaveTransform;
-		InterpolateTransform( leaveKeyframeBegin, leaveFrameRate, animationLeaveTimer, animationLeaveTransform );
-		interpolatedTransform = Mat44::Interpolate( animationLeaveTransform, animationEnterTransform, factor );
-	}
-	else
-	{
-		interpolatedTransform = animationEnterTransform;
-	}
+	SkeletalPoseScratch scratch;
+	EvaluatePose( globalTransforms, scratch, animStateMachine );
 }
 
-void SkeletalMesh::InterpolateTransform( KeyFrame* keyFrameBegin, float frameRate, float currentTime, Mat44& interpolatedTransform )
+void SkeletalMesh::EvaluatePose( std::vector<Mat44>& globalTransforms, SkeletalPoseScratch& scratch, float currentTime, AnimationSequence* currentAnimation, float previousTime, AnimationSequence* previousAnimation, float alpha )
 {
-	KeyFrame* prevKeyFrame = nullptr;
-	KeyFrame* nextKeyFrame = nullptr;
-	int currentFrame = int( std::floorf( currentTime * frameRate ) );
-	for (auto keyFrame = keyFrameBegin; keyFrame; keyFrame = keyFrame->m_next)
-	{
-		if (keyFrame->m_frameNum <= currentFrame )
-		{
-			prevKeyFrame = keyFrame;
-		}
-		if (keyFrame->m_frameNum > currentFrame )
-		{
-			nextKeyFrame = keyFrame;
-			break;
-		}
-	}
-
-	if (prevKeyFrame && nextKeyFrame)
-	{
-		float factor = float( currentTime - prevKeyFrame->m_frameNum / frameRate ) / float( nextKeyFrame->m_frameNum - prevKeyFrame->m_frameNum ) * frameRate;
-		InterpolateKeyFrames( prevKeyFrame, nextKeyFrame, factor, interpolatedTransform );
-	}
-	else if (!prevKeyFrame && nextKeyFrame)
-	{
-		interpolatedTransform = nextKeyFrame->m_globalTransform;
-	}
-	else if (prevKeyFrame && !nextKeyFrame)
-	{
-		interpolatedTransform = prevKeyFrame->m_globalTransform;
-	}
-	else
-	{
-		// This is an error
-		//interpolatedTransform.SetIdentity();
-	}
+	SampleLocalPose( scratch.m_localPose, currentTime, currentAnimation, previousTime, previousAnimation, alpha );
+	ComposeModelSpace( globalTransforms, scratch.m_localPose );
 }
 
-void SkeletalMesh::UpdateJoints( std::vector<Mat44>& globalTransforms, float currentTime, AnimationSequence* currentAnimation, float previousTime/* = 0.f*/, AnimationSequence* previousAnimation/* = nullptr*/, float alpha/* = 0.f*/ )
+void SkeletalMesh::EvaluatePose( std::vector<Mat44>& globalTransforms, SkeletalPoseScratch& scratch, AnimationStateMachine* animStateMachine, bool baseLayerOnly )
 {
 	std::vector<Joint> const& joints = m_skeleton.m_joints;
-	globalTransforms.clear();
-	globalTransforms.reserve( joints.size() );
+	std::vector<JointPose>& localPose = scratch.m_localPose;
+	localPose.clear();
 
-	for (Joint const& joint : joints)
+	// layers above the first blend over the subtree under their root joint,
+	// in local space the subtree stays attached to whatever the base layer did with its parent
+	int layerCount = (int)animStateMachine->GetOngoingAnimations().size();
+	if (baseLayerOnly && layerCount > 1)
 	{
-		if (!currentAnimation || currentAnimation->m_keyFrames.find( joint.m_name ) == currentAnimation->m_keyFrames.end())
-		{
-			globalTransforms.push_back( Mat44() );
-			continue;
-		}
-
-		Mat44 globalTransform = Mat44();
-
-		if (previousAnimation)
-		{
-			if (previousAnimation->m_keyFrames.find( joint.m_name ) == previousAnimation->m_keyFrames.end())
-			{
-				globalTransforms.push_back( Mat44() );
-				continue;
-			}
-
-			CrossfadeInterpolateTransform( previousAnimation->m_keyFrames[joint.m_name], previousAnimation->m_frameRate, previousTime,
-				currentAnimation->m_keyFrames[joint.m_name], currentAnimation->m_frameRate, currentTime, alpha, globalTransform );
-		}
-		else
-		{
-			CrossfadeInterpolateTransform( nullptr, 0.f, 0.f,
-				currentAnimation->m_keyFrames[joint.m_name], currentAnimation->m_frameRate, currentTime, alpha, globalTransform );
-		}
-		
-		globalTransforms.push_back( globalTransform );
+		layerCount = 1;
 	}
-}
-
-void SkeletalMesh::UpdateJoints( std::vector<Mat44>& globalTransforms, AnimationStateMachine* animStateMachine )
-{
-	std::vector<Joint> const& joints = m_skeleton.m_joints;
-	std::vector<std::vector<Mat44>> transformsSets;
-
-	for (int i = 0; i < animStateMachine->GetOngoingAnimations().size(); i++)
+	for (int i = 0; i < layerCount; i++)
 	{
 		AnimationStateMachine::StateSet& ongoingAnimation = animStateMachine->GetOngoingAnimation( i );
 
-		if (i > 0 && ongoingAnimation.blendAlpha <= 0)
-			continue;
-		if (ongoingAnimation.currentState == nullptr)
+		if (i > 0 && (ongoingAnimation.blendAlpha <= 0 || ongoingAnimation.currentState == nullptr))
 			continue;
 
 		float currentTimeSeconds = ongoingAnimation.GetCurrentAnimationPlaybackTime();
-		AnimationSequence* currentAnimation = ongoingAnimation.GetCurrentState()->GetAnimation();
+		AnimationSequence* currentAnimation = ongoingAnimation.GetCurrentState() ? ongoingAnimation.GetCurrentState()->GetAnimation() : nullptr;
 		float previousTimeSecond = ongoingAnimation.GetPreviousAnimationPlaybackTime();
-		AnimationSequence* previousAnimaiton = (ongoingAnimation.GetPreviousState()) ? animStateMachine->GetOngoingAnimation( 0 ).GetPreviousState()->GetAnimation() : nullptr;
+		AnimationSequence* previousAnimaiton = (ongoingAnimation.GetPreviousState()) ? ongoingAnimation.GetPreviousState()->GetAnimation() : nullptr;
 		float crossfadeAlpha = ongoingAnimation.GetCrossfadeAlpha();
 
-		std::vector<Mat44> transforms;
-		UpdateJoints( transforms, currentTimeSeconds, currentAnimation, previousTimeSecond, previousAnimaiton, crossfadeAlpha);
-
-		if (i > 0) // Todo: can we optimize this?
+		if (i == 0)
 		{
-			int selfIndex = m_skeleton.GetJointIndexByName( ongoingAnimation.rootJoint );
-			int parentIndex = m_skeleton.m_joints[selfIndex].m_parentIndex;
+			SampleLocalPose( localPose, currentTimeSeconds, currentAnimation, previousTimeSecond, previousAnimaiton, crossfadeAlpha );
+			continue;
+		}
 
-			Mat44 parentGlobalTransform = transforms[parentIndex];
-			Mat44 selfGlobalTransform = transforms[selfIndex];
-			
-			Mat44 newParentGlobalTransform = transformsSets[0][parentIndex];
+		int layerRootIndex = m_skeleton.GetJointIndexByName( ongoingAnimation.rootJoint );
+		if (layerRootIndex < 0)
+			continue;
 
-			for (int j = 0; j < transforms.size(); j++)
-			{
-				transforms[j] = newParentGlobalTransform * parentGlobalTransform.GetInverse() * transforms[j];
-			}
-		}
+		SampleLocalPose( scratch.m_layerPose, currentTimeSeconds, currentAnimation, previousTimeSecond, previousAnimaiton, crossfadeAlpha );
+		// parents come before their children, so the subtree is everything after the root whose parent is in it
+		std::vector<unsigned char>& layerMask = scratch.m_layerMask;
+		layerMask.assign( joints.size(), 0 );
+		for (int jointIndex = layerRootIndex; jointIndex < (int)joints.size(); jointIndex++)
+		{
+			int parentIndex = joints[jointIndex].m_parentIndex;
+			if (jointIndex != layerRootIndex && (parentIndex < 0 || !layerMask[parentIndex]))
+				continue;
 
-		transformsSets.push_back( transforms );
+			layerMask[jointIndex] = 1;
+			localPose[jointIndex] = JointPose::Interpolate( localPose[jointIndex], scratch.m_layerPose[jointIndex], ongoingAnimation.blendAlpha );
+		}
 	}
-	if (transformsSets.size() == 1)
+
+	if (localPose.size() != joints.size())
 	{
-		globalTransforms = transformsSets[0];
+		localPose.assign( joints.size(), JointPose() );
 	}
-	else
+	ComposeModelSpace( globalTransforms, localPose );
+}
+
+void SkeletalMesh::SampleLocalPose( std::vector<JointPose>& localPose, float currentTime, AnimationSequence* currentAnimation, float previousTime, AnimationSequence* previousAnimation, float alpha )
+{
+	std::vector<Joint> const& joints = m_skeleton.m_joints;
+	localPose.assign( joints.size(), JointPose() );
+
+	// a joint the sequence has no keys for keeps the identity pose and follows its parent
+	std::vector<int> const* currentTracks = currentAnimation ? &currentAnimation->GetJointTrackIndices( m_skeleton ) : nullptr;
+	std::vector<int> const* previousTracks = previousAnimation ? &previousAnimation->GetJointTrackIndices( m_skeleton ) : nullptr;
+	for (int jointIndex = 0; jointIndex < (int)joints.size(); jointIndex++)
 	{
-		for (int j = 0; j < joints.size(); j++)
+		int currentTrack = currentTracks ? (*currentTracks)[jointIndex] : -1;
+		if (currentTrack >= 0)
 		{
-			std::unordered_map<int, bool> jointList = m_skeleton.GetChildrenfromJoint( animStateMachine->GetOngoingAnimation( 1 ).rootJoint );
-			float alpha = animStateMachine->GetOngoingAnimation( 1 ).blendAlpha;
-
-			globalTransforms[j] = !jointList[j] ? transformsSets[0][j] : 
-				Mat44::Interpolate( transformsSets[0][j], transformsSets[1][j], alpha );
-			for (int i = 2; i < animStateMachine->GetOngoingAnimations().size(); i++)
-			{
-				globalTransforms[j] = !jointList[j] ? globalTransforms[j] :
-					Mat44::Interpolate( globalTransforms[j], transformsSets[i][j], animStateMachine->GetOngoingAnimation( i ).blendAlpha );
-			}
+			localPose[jointIndex] = currentAnimation->SampleTrack( currentTrack, currentTime );
+		}
+		if (previousTracks)
+		{
+			int previousTrack = (*previousTracks)[jointIndex];
+			JointPose previousPose = previousTrack >= 0 ? previousAnimation->SampleTrack( previousTrack, previousTime ) : JointPose();
+			localPose[jointIndex] = JointPose::Interpolate( previousPose, localPose[jointIndex], alpha );
 		}
 	}
 }
 
+void SkeletalMesh::ComposeModelSpace( std::vector<Mat44>& globalTransforms, std::vector<JointPose> const& localPose ) const
+{
+	std::vector<Joint> const& joints = m_skeleton.m_joints;
+	globalTransforms.resize( joints.size() );
+	for (int jointIndex = 0; jointIndex < (int)joints.size(); jointIndex++)
+	{
+		int parentIndex = joints[jointIndex].m_parentIndex;
+		globalTransforms[jointIndex] = parentIndex >= 0 ? globalTransforms[parentIndex] * localPose[jointIndex].ToMatrix() : localPose[jointIndex].ToMatrix();
+	}
+}
+
 void SkeletalMesh::ApplyFootIK( std::vector<Mat44>& globalTransforms, FootIKConfig const& config, Vec3 const& target, Vec3 const& groundNormal, float ikWeight )
 {
 	ikWeight = ClampZeroToOne( ikWeight );
@@ -587,9 +584,8 @@ SkeletalMesh* SkeletalMesh::ImportFromXML( std::string const& filePath )
 			mesh.isVisible = meshElem->BoolAttribute( "isVisible" );
 
 			// Import material
-			mesh.material = new Material;
 			XmlElement* materialElem = meshElem->FirstChildElement( "Material" );
-			mesh.material->m_name = ParseXmlAttribute( *materialElem, "name", "" );
+			std::string materialName = ParseXmlAttribute( *materialElem, "name", "" );
 			std::string shaderPath = ParseXmlAttribute( *materialElem, "shader", "" );
 			std::string vertexTypeName = ParseXmlAttribute( *materialElem, "vertexType", "Vertex_PCUTBN" );
 			std::string diffuseTexturePath = ParseXmlAttribute( *materialElem, "diffuseTexture", "" );
@@ -598,39 +594,16 @@ SkeletalMesh* SkeletalMesh::ImportFromXML( std::string const& filePath )
 			std::string transparencyPath = ParseXmlAttribute( *materialElem, "transparencyTexture", "" );
 			Rgba8 color = ParseXmlAttribute( *materialElem, "color", Rgba8::WHITE );
 
+			VertexType vertexType = VertexType::VERTEX_ANIM;
 			if (vertexTypeName == "Vertex_PCU")
 			{
-				mesh.material->m_vertexType = VertexType::VERTEX_PCU;
+				vertexType = VertexType::VERTEX_PCU;
 			}
 			else if (vertexTypeName == "Vertex_PCUTBN")
 			{
-				mesh.material->m_vertexType = VertexType::VERTEX_PCUTBN;
-			}
-			else
-			{
-				mesh.material->m_vertexType = VertexType::VERTEX_ANIM;
-			}
-			if (shaderPath != "")
-			{
-				mesh.material->m_shader = g_theRenderer->CreateShader( shaderPath.c_str(), mesh.material->m_vertexType );
-				//m_shader = g_theRenderer->CreateShader( "Data/Shaders/Diffuse.hlsl", m_vertexType);
-			}
-			if (diffuseTexturePath != "")
-			{
-				mesh.material->m_diffuseMap = g_theRenderer->CreateOrGetTextureFromFile( diffuseTexturePath.c_str() );
-			}
-			if (normalTexturePath != "")
-			{
-				mesh.material->m_normalMap = g_theRenderer->CreateOrGetTextureFromFile( normalTexturePath.c_str() );
-			}
-			if (specTexturePath != "")
-			{
-				mesh.material->m_specGlossEmitMap = g_theRenderer->CreateOrGetTextureFromFile( specTexturePath.c_str() );
-			}
-			if (transparencyPath != "")
-			{
-				mesh.material->m_transparencyMap = g_theRenderer->CreateOrGetTextureFromFile( transparencyPath.c_str() );
+				vertexType = VertexType::VERTEX_PCUTBN;
 			}
+			mesh.material = CreateImportedMaterial( materialName, vertexType, color, shaderPath, diffuseTexturePath, normalTexturePath, specTexturePath, transparencyPath );
 
 			// Import vertexes
 			XmlElement* vertexesElem = meshElem->FirstChildElement( "Vertexes" );
@@ -709,3 +682,194 @@ SkeletalMesh* SkeletalMesh::ImportFromXML( std::string const& filePath )
 	}
 	return skeletalMesh;
 }
+
+bool SkeletalMesh::ExportToBinary( std::string const& filePath ) const
+{
+	std::vector<unsigned char> buffer;
+	WriteToBuffer( buffer );
+	return FileWriteToBuffer_S( buffer, filePath );
+}
+
+void SkeletalMesh::WriteToBuffer( std::vector<unsigned char>& out_buffer ) const
+{
+	BufferWriter writer;
+	writer.SetEndianMode( Endianness::LITTLE );
+	writer.AppendUInt( SKELETAL_MESH_MAGIC );
+	writer.AppendUInt( SKELETAL_MESH_VERSION );
+
+	writer.AppendUInt( (unsigned int)m_meshes.size() );
+	for (MeshT const& mesh : m_meshes)
+	{
+		writer.AppendStringAfter32BitLength( mesh.name );
+		writer.AppendBool( mesh.isVisible );
+
+		Material const* material = mesh.material;
+		writer.AppendStringAfter32BitLength( material ? material->m_name : std::string() );
+		writer.AppendByte( (unsigned char)(material ? material->m_vertexType : VertexType::VERTEX_ANIM) );
+		writer.AppendRgba( material ? material->m_color : Rgba8::WHITE );
+		writer.AppendStringAfter32BitLength( material && material->m_shader ? material->m_shader->GetName() : std::string() );
+		writer.AppendStringAfter32BitLength( material ? GetTextureFilePath( material->m_diffuseMap ) : std::string() );
+		writer.AppendStringAfter32BitLength( material ? GetTextureFilePath( material->m_normalMap ) : std::string() );
+		writer.AppendStringAfter32BitLength( material ? GetTextureFilePath( material->m_specGlossEmitMap ) : std::string() );
+		writer.AppendStringAfter32BitLength( material ? GetTextureFilePath( material->m_transparencyMap ) : std::string() );
+
+		writer.AppendUInt( (unsigned int)mesh.vertexes.size() );
+		writer.AppendUInt( (unsigned int)mesh.jointInfluences.size() );
+		writer.AppendUInt( (unsigned int)mesh.indexes.size() );
+	}
+
+	writer.AppendUInt( (unsigned int)m_skeleton.m_joints.size() );
+	for (Joint const& joint : m_skeleton.m_joints)
+	{
+		writer.AppendStringAfter32BitLength( joint.m_name );
+		writer.AppendInt( joint.m_parentIndex );
+		writer.AppendUInt( (unsigned int)joint.m_childrenIndexes.size() );
+		for (int childIndex : joint.m_childrenIndexes)
+		{
+			writer.AppendInt( childIndex );
+		}
+	}
+
+	// every array starts on an aligned offset
+	for (MeshT const& mesh : m_meshes)
+	{
+		writer.AppendPaddingToAlignment( SKELETAL_MESH_ARRAY_ALIGNMENT );
+		writer.AppendBytes( mesh.vertexes.data(), sizeof( Vertex_PCUTBN ) * mesh.vertexes.size() );
+		writer.AppendPaddingToAlignment( SKELETAL_MESH_ARRAY_ALIGNMENT );
+		writer.AppendBytes( mesh.jointInfluences.data(), sizeof( Vertex_Anim ) * mesh.jointInfluences.size() );
+		writer.AppendPaddingToAlignment( SKELETAL_MESH_ARRAY_ALIGNMENT );
+		writer.AppendBytes( mesh.indexes.data(), sizeof( unsigned int ) * mesh.indexes.size() );
+	}
+	writer.AppendPaddingToAlignment( SKELETAL_MESH_ARRAY_ALIGNMENT );
+	for (Joint const& joint : m_skeleton.m_joints)
+	{
+		writer.AppendBytes( joint.m_globalBindposeInverse.m_values, sizeof( Mat44 ) );
+	}
+
+	out_buffer.swap( writer.m_buffer );
+}
+
+SkeletalMesh* SkeletalMesh::ImportFromBinary( std::string const& filePath )
+{
+	std::vector<unsigned char> buffer;
+	if (!FileReadToBuffer( buffer, filePath ))
+		return nullptr;
+	return CreateFromBuffer( buffer );
+}
+
+SkeletalMesh* SkeletalMesh::CreateFromBuffer( std::vector<unsigned char>& buffer )
+{
+	BufferParser parser( buffer );
+	parser.SetEndianMode( Endianness::LITTLE );
+	if (parser.GetRemainingByteCount() < 12 || parser.ParseUInt() != SKELETAL_MESH_MAGIC || parser.ParseUInt() != SKELETAL_MESH_VERSION)
+		return nullptr;
+
+	// materials create shaders and textures, so they are only made once the whole file has checked out
+	struct MaterialDesc
+	{
+		std::string m_name;
+		VertexType m_vertexType = VertexType::VERTEX_ANIM;
+		Rgba8 m_color;
+		std::string m_shaderPath;
+		std::string m_texturePaths[4];
+	};
+
+	size_t meshCount = parser.ParseUInt();
+	if (meshCount > parser.GetRemainingByteCount() / 46)
+		return nullptr;
+	std::vector<MeshT> meshes( meshCount );
+	std::vector<MaterialDesc> materials( meshCount );
+	for (size_t meshIndex = 0; meshIndex < meshCount; meshIndex++)
+	{
+		MeshT& mesh = meshes[meshIndex];
+		MaterialDesc& material = materials[meshIndex];
+		mesh.name = parser.ParseStringAfter32BitLength();
+		if (parser.GetRemainingByteCount() < 1)
+			return nullptr;
+		mesh.isVisible = parser.ParseByte() != 0;
+		material.m_name = parser.ParseStringAfter32BitLength();
+		if (parser.GetRemainingByteCount() < 5)
+			return nullptr;
+		unsigned char vertexType = parser.ParseByte();
+		if (vertexType >= (unsigned char)VertexType::COUNT)
+			return nullptr;
+		material.m_vertexType = (VertexType)vertexType;
+		material.m_color = parser.ParseRgba();
+		material.m_shaderPath = parser.ParseStringAfter32BitLength();
+		for (std::string& texturePath : material.m_texturePaths)
+		{
+			texturePath = parser.ParseStringAfter32BitLength();
+		}
+
+		if (parser.GetRemainingByteCount() < 12)
+			return nullptr;
+		size_t vertexCount = parser.ParseUInt();
+		size_t influenceCount = parser.ParseUInt();
+		size_t indexCount = parser.ParseUInt();
+		if (vertexCount > parser.GetRemainingByteCount() / sizeof( Vertex_PCUTBN ) || influenceCount > parser.GetRemainingByteCount() / sizeof( Vertex_Anim )
+			|| indexCount > parser.GetRemainingByteCount() / sizeof( unsigned int ))
+			return nullptr;
+		mesh.vertexes.resize( vertexCount );
+		mesh.jointInfluences.resize( influenceCount );
+		mesh.indexes.resize( indexCount );
+	}
+
+	if (parser.GetRemainingByteCount() < 4)
+		return nullptr;
+	size_t jointCount = parser.ParseUInt();
+	if (jointCount > parser.GetRemainingByteCount() / 12)
+		return nullptr;
+	Skeleton skeleton;
+	skeleton.m_joints.resize( jointCount );
+	for (Joint& joint : skeleton.m_joints)
+	{
+		joint.m_name = parser.ParseStringAfter32BitLength();
+		if (parser.GetRemainingByteCount() < 8)
+			return nullptr;
+		joint.m_parentIndex = parser.ParseInt();
+		size_t childCount = parser.ParseUInt();
+		if (joint.m_parentIndex < -1 || joint.m_parentIndex >= (int)jointCount || childCount > parser.GetRemainingByteCount() / 4)
+			return nullptr;
+		joint.m_childrenIndexes.resize( childCount );
+		for (int& childIndex : joint.m_childrenIndexes)
+		{
+			childIndex = parser.ParseInt();
+			if (childIndex < 0 || childIndex >= (int)jointCount)
+				return nullptr;
+		}
+	}
+
+	for (MeshT& mesh : meshes)
+	{
+		if (!parser.SkipToAlignedArray( SKELETAL_MESH_ARRAY_ALIGNMENT, sizeof( Vertex_PCUTBN ) * mesh.vertexes.size() ))
+			return nullptr;
+		parser.ParseBytes( mesh.vertexes.data(), sizeof( Vertex_PCUTBN ) * mesh.vertexes.size() );
+		if (!parser.SkipToAlignedArray( SKELETAL_MESH_ARRAY_ALIGNMENT, sizeof( Vertex_Anim ) * mesh.jointInfluences.size() ))
+			return nullptr;
+		parser.ParseBytes( mesh.jointInfluences.data(), sizeof( Vertex_Anim ) * mesh.jointInfluences.size() );
+		if (!parser.SkipToAlignedArray( SKELETAL_MESH_ARRAY_ALIGNMENT, sizeof( unsigned int ) * mesh.indexes.size() ))
+			return nullptr;
+		parser.ParseBytes( mesh.indexes.data(), sizeof( unsigned int ) * mesh.indexes.size() );
+	}
+	if (!parser.SkipToAlignedArray( SKELETAL_MESH_ARRAY_ALIGNMENT, sizeof( Mat44 ) * jointCount ))
+		return nullptr;
+	for (Joint& joint : skeleton.m_joints)
+	{
+		parser.ParseBytes( joint.m_globalBindposeInverse.m_values, sizeof( Mat44 ) );
+	}
+
+	SkeletalMesh* skeletalMesh = new SkeletalMesh;
+	skeletalMesh->m_meshes.swap( meshes );
+	for (size_t meshIndex = 0; meshIndex < meshCount; meshIndex++)
+	{
+		MaterialDesc const& material = materials[meshIndex];
+		skeletalMesh->m_meshes[meshIndex].material = CreateImportedMaterial( material.m_name, material.m_vertexType, material.m_color, material.m_shaderPath,
+			material.m_texturePaths[0], material.m_texturePaths[1], material.m_texturePaths[2], material.m_texturePaths[3] );
+	}
+	skeletalMesh->m_skeleton.m_joints.swap( skeleton.m_joints );
+	for (int jointIndex = 0; jointIndex < (int)skeletalMesh->m_skeleton.m_joints.size(); jointIndex++)
+	{
+		skeletalMesh->m_jointIndexCheckList[skeletalMesh->m_skeleton.m_joints[jointIndex].m_name] = jointIndex;
+	}
+	return skeletalMesh;
+}
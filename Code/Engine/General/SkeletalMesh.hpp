@@ -18,6 +18,18 @@ class Renderer;
 class Character;
 class AnimationStateMachine;
 class Material;
+class RenderQueue;
+struct RenderCommand;
+struct JointPose;
+
+// Working buffers for one pose evaluation, kept by the caller so evaluating every frame does not allocate
+// JointPose has to be complete wherever one of these is created
+struct SkeletalPoseScratch
+{
+	std::vector<JointPose> m_localPose;
+	std::vector<JointPose> m_layerPose;
+	std::vector<unsigned char> m_layerMask;
+};
 
 class SkeletalMesh
 {
@@ -31,6 +43,7 @@ public:
 
 	virtual void Update();
 	virtual void Render();
+	void Submit( RenderQueue& queue, RenderCommand const& baseCommand ) const;
 
 	void SetVisibility( bool flag, int index = -1 );
 
@@ -38,19 +51,32 @@ public:
 
 	int GetJointIndexByName( std::string name );
 
-protected:
-	void InterpolateKeyFrames( KeyFrame const* keyframeA, KeyFrame const* keyframeB, float factor, Mat44& interpolatedTransform );
-	void CrossfadeInterpolateTransform( KeyFrame* leaveKeyframeBegin, float leaveFrameRate, float animationLeaveTimer, KeyFrame* enterKeyframeBegin, float enterFrameRate, float animationEnterTimer, float factor, Mat44& interpolatedTransform );
-	void InterpolateTransform( KeyFrame* keyFrameBegin, float frameRate, float currentTime, Mat44& interpolatedTransform );
+	// Sample and compose into globalTransforms using the caller's buffers
+	// They only read the mesh, so several threads can evaluate poses of one mesh into different outputs
+	void EvaluatePose( std::vector<Mat44>& globalTransforms, SkeletalPoseScratch& scratch, float currentTime, AnimationSequence* currentAnimation, float previousTime = 0.f, AnimationSequence* previousAnimation = nullptr, float alpha = 0.f );
+	// Every layer of the state machine, or only the base layer's crossfade
+	void EvaluatePose( std::vector<Mat44>& globalTransforms, SkeletalPoseScratch& scratch, AnimationStateMachine* animStateMachine, bool baseLayerOnly = false );
 
+protected:
 	void UpdateJoints( std::vector<Mat44>& globalTransforms, float currentTime, AnimationSequence* currentAnimation, float previousTime = 0.f, AnimationSequence* previousAnimation = nullptr, float alpha = 0.f );
 	void UpdateJoints( std::vector<Mat44>& globalTransforms, AnimationStateMachine* animStateMachine );
+	// Local pose of every joint, crossfaded from the previous animation by alpha
+	void SampleLocalPose( std::vector<JointPose>& localPose, float currentTime, AnimationSequence* currentAnimation, float previousTime, AnimationSequence* previousAnimation, float alpha );
+	// One pass in joint order, parents are always listed before their children
+	void ComposeModelSpace( std::vector<Mat44>& globalTransforms, std::vector<JointPose> const& localPose ) const;
 
 	void ApplyFootIK( std::vector<Mat44>& globalTransforms, FootIKConfig const& config, Vec3 const& target, Vec3 const& groundNormal, float ikWeight );
 
 public:
 	void ExportToXML( std::string const& filePath ) const;
 	static SkeletalMesh* ImportFromXML( std::string const& filePath );
+	// Versioned binary form for shipping, vertex, influence, index and bind pose arrays are stored
+	// in their in-memory layout on aligned offsets and copied in whole
+	bool ExportToBinary( std::string const& filePath ) const;
+	void WriteToBuffer( std::vector<unsigned char>& out_buffer ) const;
+	// nullptr when the data is from another version, truncated or inconsistent
+	static SkeletalMesh* ImportFromBinary( std::string const& filePath );
+	static SkeletalMesh* CreateFromBuffer( std::vector<unsigned char>& buffer );
 
 protected:
 	std::vector<MeshT> m_meshes;
@@ -95,6 +95,14 @@ void StaticMesh::Render()
 	}
 }
 
+void StaticMesh::Submit( RenderQueue& queue, RenderCommand const& baseCommand ) const
+{
+	for (int i = 0; i < m_meshes.size(); i++)
+	{
+		m_meshes[i].Submit( queue, baseCommand );
+	}
+}
+
 void StaticMesh::ExportToXML( std::string const& filePath ) const
 {
 	using namespace tinyxml2;
@@ -236,11 +244,11 @@ StaticMesh* StaticMesh::ImportFromXML( std::string const& filePath )
 			}
 			if (normalTexturePath != "")
 			{
-				mesh.material->m_normalMap = g_theRenderer->CreateOrGetTextureFromFile( normalTexturePath.c_str() );
+				mesh.material->m_normalMap = g_theRenderer->CreateOrGetTextureFromFile( normalTexturePath.c_str(), TextureUsage::NORMAL_MAP );
 			}
 			if (specTexturePath != "")
 			{
-				mesh.material->m_specGlossEmitMap = g_theRenderer->CreateOrGetTextureFromFile( specTexturePath.c_str() );
+				mesh.material->m_specGlossEmitMap = g_theRenderer->CreateOrGetTextureFromFile( specTexturePath.c_str(), TextureUsage::LINEAR );
 			}
 			if (transparencyPath != "")
 			{
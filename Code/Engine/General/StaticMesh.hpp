@@ -13,6 +13,8 @@ class Texture;
 class MeshT;
 class Renderer;
 class Material;
+class RenderQueue;
+struct RenderCommand;
 
 enum class StaticMeshPreset
 {
@@ -37,6 +39,7 @@ public:
 
 	virtual void Update( float deltaSeconds );
 	virtual void Render();
+	void Submit( RenderQueue& queue, RenderCommand const& baseCommand ) const;
 
 public:
 	void ExportToXML( std::string const& filePath ) const;
@@ -311,7 +311,7 @@ Quat Quat::SLERP( Quat const& start, Quat const& end, float t )
 
 	if (dotP > 0.9995f) // degenerate to nlerp if too close
 	{
-		return NLERP( start, end, t );
+		return NLERP( start, correctedEnd, t );
 	}
 
 	float theta = acos( dotP );
@@ -324,7 +324,8 @@ Quat Quat::SLERP( Quat const& start, Quat const& end, float t )
 
 Quat Quat::NLERP( Quat const& start, Quat const& end, float t )
 {
-	Quat result = start * (1.f - t) + end * t;
+	// q and -q are the same rotation, blend towards whichever is on start's side to take the short way round
+	Quat result = start.DotProduct( end ) < 0.f ? start * (1.f - t) - end * t : start * (1.f - t) + end * t;
 	return result.GetNormalized();
 }
 
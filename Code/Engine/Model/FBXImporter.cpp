@@ -9,6 +9,7 @@
 #include "Engine/Renderer/VertexBuffer.hpp"
 #include "Engine/Renderer/IndexBuffer.hpp"
 #include "Engine/Animation/AnimationSequence.hpp"
+#include "Engine/Animation/AnimationCompression.hpp"
 #include "Engine/General/MeshT.hpp"
 #include "Engine/Renderer/Material.hpp"
 #include "Engine/Core/DebugRenderSystem.hpp"
@@ -172,6 +173,18 @@ std::string FBX::GetAnimationNameByIndex( int index )
 	return m_animationSequences[index]->m_name;
 }
 
+void FBX::CompressAnimations( AnimationCompressionConfig const& config )
+{
+	for (AnimationSequence* sequence : m_animationSequences)
+	{
+		if (!sequence || sequence->IsCompressed())
+			continue;
+
+		AnimationCompressionStats stats = sequence->Compress( m_skeleton, config );
+		DebuggerPrintf( "%s\n", stats.ToString().c_str() );
+	}
+}
+
 bool FBX::Initialize()
 {
 	if (m_fbxManager)
@@ -225,7 +238,7 @@ void FBX::InitializeAllTexture()
 	for (const std::filesystem::directory_entry& dirEntry : std::filesystem::recursive_directory_iterator( texturePath ))
 	{
 		std::string filePath = dirEntry.path().string();
-		m_textures[filePath] = m_renderer->CreateOrGetTextureFromFile( filePath.c_str() );
+		m_textures[filePath] = m_renderer->CreateOrGetTextureFromFileAsync( filePath.c_str() );
 	}
 }
 
@@ -571,10 +584,11 @@ void FBX::LoadJointsAndAnimations( FbxNode* pNode )
 				if (!m_animationSequences[animationIndex])
 				{
 					m_animationSequences[animationIndex] = new AnimationSequence( animStackName, frameRate, durationSeconds );
+					m_animationSequences[animationIndex]->SetTrackSpace( JointTrackSpace::MODEL );
 					m_animationSequences[animationIndex]->m_rootTranslation.resize( end.GetFrameCount( timeMode ) - start.GetFieldCount( timeMode ) + 1 );
 					m_animationSequences[animationIndex]->m_rootRotation.resize( end.GetFrameCount( timeMode ) - start.GetFieldCount( timeMode ) + 1 );
 				}
-				m_animationSequences[animationIndex]->m_keyFrames[jointName] = new KeyFrame[end.GetFrameCount( timeMode ) - start.GetFieldCount( timeMode ) + 1];
+				m_animationSequences[animationIndex]->AddTrack( jointName, int( end.GetFrameCount( timeMode ) - start.GetFieldCount( timeMode ) + 1 ) );
 			}
 		}
 	}
@@ -723,12 +737,10 @@ void FBX::LoadJointsAndAnimations( FbxNode* pNode )
 			{
 				FbxCluster* cluster = skin->GetCluster( clusterIndex );
 				std::string jointName = cluster->GetLink()->GetName();
-				int jointIndex = FindJointIndexByName( jointName );
 				
 				FbxTime currTime;
 				currTime.SetFrame( i, timeMode );
-				KeyFrame *anim = &m_animationSequences[animationIndex]->m_keyFrames[jointName][i - start.GetFrameCount( timeMode )];
-				(anim)->m_frameNum = i - start.GetFrameCount( timeMode );
+				JointTrack& track = m_animationSequences[animationIndex]->GetTrack( m_animationSequences[animationIndex]->GetTrackIndex( jointName ) );
 
 				FbxAMatrix reverseRootMotion;
  				FbxQuaternion currentTotalReverseRotation = currentTotalRotation;
@@ -738,16 +750,8 @@ void FBX::LoadJointsAndAnimations( FbxNode* pNode )
 
 				FbxAMatrix transformOffset = pNode->EvaluateGlobalTransform( currTime ) * geometryTransformFBX;
 				FbxAMatrix clusterGlobalTransform = reverseRootMotion * cluster->GetLink()->EvaluateGlobalTransform( currTime );
-				(anim)->m_globalTransform = localTransform * ConvertFbxAMatrixToMat44( transformOffset.Inverse() ) * ConvertFbxAMatrixToMat44( clusterGlobalTransform );
-
-				if (i - start.GetFrameCount( timeMode ) > 0)
-				{
-					m_animationSequences[animationIndex]->m_keyFrames[jointName][i - start.GetFrameCount( timeMode ) - 1].m_next = anim;
-				}
-				else
-				{
-					m_skeleton.m_joints[jointIndex].m_keyFrameBegin = anim;
-				}
+				Mat44 globalTransform = localTransform * ConvertFbxAMatrixToMat44( transformOffset.Inverse() ) * ConvertFbxAMatrixToMat44( clusterGlobalTransform );
+				track.SetKey( int( i - start.GetFrameCount( timeMode ) ), JointPose( globalTransform ) );
 			}
 		}
 
@@ -1204,11 +1208,11 @@ void FBX::LoadMaterialTexture( MeshT* localMesh, FbxSurfaceMaterial* pSurfaceMat
 		}
 		else if (textureType == FbxSurfaceMaterial::sNormalMap)
 		{
-			localMesh->material->m_normalMap = m_renderer->CreateOrGetTextureFromFile( textureFileName.c_str() );
+			localMesh->material->m_normalMap = m_renderer->CreateOrGetTextureFromFile( textureFileName.c_str(), TextureUsage::NORMAL_MAP );
 		}
 		else if (textureType == FbxSurfaceMaterial::sSpecular)
 		{
-			localMesh->material->m_specGlossEmitMap = m_renderer->CreateOrGetTextureFromFile( textureFileName.c_str() );
+			localMesh->material->m_specGlossEmitMap = m_renderer->CreateOrGetTextureFromFile( textureFileName.c_str(), TextureUsage::LINEAR );
 		}
 		else if (textureType == FbxSurfaceMaterial::sTransparencyFactor)
 		{
@@ -20,6 +20,7 @@ class VertexBuffer;
 class IndexBuffer;
 class AnimationSequence;
 class MeshT;
+struct AnimationCompressionConfig;
 
 class Character;
 
@@ -80,6 +81,8 @@ public:
 	}
 	int GetAnimationCount() { return int( m_animationSequences.size() ); }
 	std::string GetAnimationNameByIndex( int index );
+	// Compresses every imported sequence against this file's skeleton and prints the error of each one
+	void CompressAnimations( AnimationCompressionConfig const& config );
 
 protected:
 	FbxManager* m_fbxManager = nullptr;
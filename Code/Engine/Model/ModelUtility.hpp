@@ -29,22 +29,10 @@ struct ControlPoint
 	std::vector<BlendingIndexWeightPair> m_blendingInfo;
 };
 
-struct KeyFrame
-{
-	~KeyFrame()
-	{
-		delete m_next;
-	}
-	int64_t m_frameNum;
-	Mat44 m_globalTransform;
-	KeyFrame* m_next = nullptr;
-};
-
 struct Joint
 {
 	Joint()
 		: m_parentIndex( -1 )
-		, m_keyFrameBegin( nullptr )
 		//, m_node( nullptr )
 	{
 		//m_globalBindposeInverse.SetIdentity();
@@ -56,7 +44,6 @@ struct Joint
 
 	std::string m_name;
 	Mat44 m_globalBindposeInverse;
-	KeyFrame* m_keyFrameBegin;
 	int m_parentIndex;
 	std::vector<int> m_childrenIndexes;
 };
@@ -1,6 +1,9 @@
 #pragma once
+// Windows builds keep pulling this in ahead of Renderer.hpp, which undoes its OPAQUE macro
+#if defined( _WIN32 )
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#endif
 
 #include "Engine/Math/Vec2.hpp"
 #include "Engine/Math/Vec3.hpp"
@@ -1,11 +1,5 @@
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
-#include <d3d11.h>
-#include <d3dcompiler.h>
-#include <dxgi.h>
-
 #include "Engine/Renderer/ConstantBuffer.hpp"
-#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/RendererBackend.hpp"
 
 ConstantBuffer::ConstantBuffer( size_t size )
 	:m_size( size )
@@ -14,5 +8,6 @@ ConstantBuffer::ConstantBuffer( size_t size )
 
 ConstantBuffer::~ConstantBuffer()
 {
-	DX_SAFE_RELEASE( m_buffer );
+	delete m_buffer;
+	m_buffer = nullptr;
 }
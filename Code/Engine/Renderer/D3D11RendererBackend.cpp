@@ -0,0 +1,761 @@
+#if defined( _WIN32 )
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <d3d11_1.h>
+#include <d3dcompiler.h>
+#include <dxgi.h>
+
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "d3dcompiler.lib")
+
+#include "Engine/Renderer/D3D11RendererBackend.hpp"
+#include "Engine/Renderer/Shader.hpp"
+#include "Engine/Renderer/Window.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/Image.hpp"
+
+#if defined(ENGINE_DEBUG_RENDER)
+#include <dxgidebug.h>
+#pragma comment(lib, "dxguid.lib")
+#endif
+
+void D3D11RendererBackend::Startup( RenderConfig const& config, IntVec2 const& dimensions )
+{
+	// Create debug module
+#if defined(ENGINE_DEBUG_RENDER)
+	m_dxgiDebugModule = (void*)::LoadLibraryA( "dxgidebug.dll" );
+	if (m_dxgiDebugModule == nullptr)
+	{
+		ERROR_AND_DIE( "Could not load dxgidebug.dll" );
+	}
+
+	typedef HRESULT( WINAPI* GetDebugModuleCB )(REFIID, void**);
+	((GetDebugModuleCB)::GetProcAddress( (HMODULE)m_dxgiDebugModule, "DXGIGetDebugInterface" ))
+		(__uuidof(IDXGIDebug), &m_dxgiDebug);
+
+	if (m_dxgiDebug == nullptr)
+	{
+		ERROR_AND_DIE( "Could not load debug module" );
+	}
+#endif
+
+	// Render startup
+	unsigned int deviceFlags = 0;
+#if defined(ENGINE_DEBUG_RENDER)
+	deviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+	// Create device and swap chain
+	DXGI_SWAP_CHAIN_DESC swapChainDesc = { 0 };
+	swapChainDesc.BufferDesc.Width = dimensions.x;
+	swapChainDesc.BufferDesc.Height = dimensions.y;
+	swapChainDesc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	swapChainDesc.SampleDesc.Count = 1;
+	swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+	swapChainDesc.BufferCount = 2;
+	swapChainDesc.OutputWindow = (HWND)config.m_window->GetHwnd();
+	swapChainDesc.Windowed = true;
+	swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+
+	HRESULT hr;
+	hr = D3D11CreateDeviceAndSwapChain(
+		nullptr, D3D_DRIVER_TYPE_HARDWARE, NULL, deviceFlags,
+		nullptr, 0, D3D11_SDK_VERSION, &swapChainDesc,
+		&m_swapChain, &m_device, nullptr, &m_deviceContext
+	);
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create D3D 11 device and swap chain" );
+	}
+
+	// Get back buffer texture
+	ID3D11Texture2D* backBuffer;
+	hr = m_swapChain->GetBuffer( 0, __uuidof(ID3D11Texture2D), (void**)&backBuffer );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not get swap chain buffer" );
+	}
+
+	hr = m_device->CreateRenderTargetView( backBuffer, NULL, &m_renderTargetView );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create render target view for swap chain buffer" );
+	}
+
+	backBuffer->Release();
+
+	// Constant buffer offsets need the 11.1 runtime, without it every constant update maps a buffer of its own
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+	if (SUCCEEDED( m_deviceContext->QueryInterface( __uuidof(ID3D11DeviceContext1), (void**)&m_deviceContext1 ) )
+		&& SUCCEEDED( m_device->CheckFeatureSupport( D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof( options ) ) ))
+	{
+		m_supportsConstantBufferOffsets = options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+	}
+
+	// Set rasterizer state
+	D3D11_RASTERIZER_DESC rasterizerDesc = {};
+	rasterizerDesc.FillMode = D3D11_FILL_SOLID;
+	rasterizerDesc.CullMode = D3D11_CULL_NONE;
+	rasterizerDesc.FrontCounterClockwise = true;
+	rasterizerDesc.DepthBias = 0;
+	rasterizerDesc.DepthBiasClamp = 0;
+	rasterizerDesc.SlopeScaledDepthBias = 0.0f;
+	rasterizerDesc.DepthClipEnable = true;
+	rasterizerDesc.ScissorEnable = false;
+	rasterizerDesc.MultisampleEnable = false;
+	rasterizerDesc.AntialiasedLineEnable = true;
+
+	hr = m_device->CreateRasterizerState( &rasterizerDesc, &m_rasterizerStates[(int)RasterizerMode::SOLID_CULL_NONE] );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create RasterizerMode::SOLID_CULL_BACK" );
+	}
+
+	rasterizerDesc.CullMode = D3D11_CULL_BACK;
+	hr = m_device->CreateRasterizerState( &rasterizerDesc, &m_rasterizerStates[(int)RasterizerMode::SOLID_CULL_BACK] );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create RasterizerMode::SOLID_CULL_BACK" );
+	}
+
+	rasterizerDesc.CullMode = D3D11_CULL_FRONT;
+	hr = m_device->CreateRasterizerState( &rasterizerDesc, &m_rasterizerStates[(int)RasterizerMode::SOLID_CULL_FRONT] );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create rasterizer state." );
+	}
+
+	rasterizerDesc.FillMode = D3D11_FILL_WIREFRAME;
+	rasterizerDesc.CullMode = D3D11_CULL_NONE;
+	hr = m_device->CreateRasterizerState( &rasterizerDesc, &m_rasterizerStates[(int)RasterizerMode::WIREFRAME_CULL_NONE] );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create RasterizerMode::WIREFRAME_CULL_NONE" );
+	}
+
+	rasterizerDesc.CullMode = D3D11_CULL_BACK;
+	hr = m_device->CreateRasterizerState( &rasterizerDesc, &m_rasterizerStates[(int)RasterizerMode::WIREFRAME_CULL_BACK] );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create RasterizerMode::WIREFRAME_CULL_BACK" );
+	}
+
+	// Create Opaque Blend State
+	D3D11_BLEND_DESC blendDesc = { };
+	blendDesc.RenderTarget[0].BlendEnable = TRUE;
+	blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
+	blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_ZERO;
+	blendDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+	blendDesc.RenderTarget[0].SrcBlendAlpha = blendDesc.RenderTarget[0].SrcBlend;
+	blendDesc.RenderTarget[0].DestBlendAlpha = blendDesc.RenderTarget[0].DestBlend;
+	blendDesc.RenderTarget[0].BlendOpAlpha = blendDesc.RenderTarget[0].BlendOp;
+	blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+
+	hr = m_device->CreateBlendState( &blendDesc, &m_blendStates[(int)(BlendMode::OPAQUE)] );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create BlendMode::Opaque" );
+	}
+
+	// Create Alpha Blend State
+	blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
+	blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+	blendDesc.RenderTarget[0].SrcBlendAlpha = blendDesc.RenderTarget[0].SrcBlend;
+	blendDesc.RenderTarget[0].DestBlendAlpha = blendDesc.RenderTarget[0].DestBlend;
+
+	hr = m_device->CreateBlendState( &blendDesc, &m_blendStates[(int)(BlendMode::ALPHA)] );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create BlendMode::Alpha" );
+	}
+
+	// Create Additive Blend State
+	blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
+	blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
+	blendDesc.RenderTarget[0].SrcBlendAlpha = blendDesc.RenderTarget[0].SrcBlend;
+	blendDesc.RenderTarget[0].DestBlendAlpha = blendDesc.RenderTarget[0].DestBlend;
+
+	hr = m_device->CreateBlendState( &blendDesc, &m_blendStates[(int)(BlendMode::ADDITIVE)] );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create BlendMode::Additive" );
+	}
+
+	D3D11_SAMPLER_DESC samplerDesc = {};
+	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_POINT;
+	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+	hr = m_device->CreateSamplerState( &samplerDesc, &m_samplerStates[(int)(SamplerMode::POINT_CLAMP)] );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create SamplerMode:Point_Clamp" );
+	}
+
+	samplerDesc = {};
+	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+	hr = m_device->CreateSamplerState( &samplerDesc, &m_samplerStates[(int)(SamplerMode::BILINEAR_WARP)] );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create SamplerMode:BILINEAR_WARP" );
+	}
+
+	samplerDesc = {};
+	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+	hr = m_device->CreateSamplerState( &samplerDesc, &m_samplerStates[(int)(SamplerMode::BILINEAR_CLAMP)] );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create SamplerMode:BILINEAR_CLAMP" );
+	}
+
+	D3D11_TEXTURE2D_DESC textureDesc = {};
+	textureDesc.Width = dimensions.x;
+	textureDesc.Height = dimensions.y;
+	textureDesc.MipLevels = 1;
+	textureDesc.ArraySize = 1;
+	textureDesc.Usage = D3D11_USAGE_DEFAULT;
+	textureDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+	textureDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+	textureDesc.SampleDesc.Count = 1;
+	hr = m_device->CreateTexture2D( &textureDesc, nullptr, &m_depthStencilTexture );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create texture for depth stencil" );
+	}
+	hr = m_device->CreateDepthStencilView( m_depthStencilTexture, nullptr, &m_depthStencilView );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create depth stencil view" );
+	}
+
+	D3D11_DEPTH_STENCIL_DESC depthStencilDesc = {};
+	depthStencilDesc.DepthEnable = TRUE;
+	depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+	depthStencilDesc.DepthFunc = D3D11_COMPARISON_ALWAYS;
+	hr = m_device->CreateDepthStencilState( &depthStencilDesc, &m_depthStencilStates[(int)DepthMode::DISABLED] );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create depth stencil state for DepthMode:DISABLED" );
+	}
+
+	depthStencilDesc = {};
+	depthStencilDesc.DepthEnable = TRUE;
+	depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+	depthStencilDesc.DepthFunc = D3D11_COMPARISON_LESS_EQUAL;
+	hr = m_device->CreateDepthStencilState( &depthStencilDesc, &m_depthStencilStates[(int)DepthMode::ENABLED] );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create depth stencil state for DepthMode:ENABLED" );
+	}
+}
+
+void D3D11RendererBackend::Shutdown()
+{
+	for (ID3D11BlendState*& blendState : m_blendStates)
+	{
+		DX_SAFE_RELEASE( blendState );
+	}
+
+	for (ID3D11SamplerState*& samplerState : m_samplerStates)
+	{
+		DX_SAFE_RELEASE( samplerState );
+	}
+
+	for (ID3D11RasterizerState*& rasterizerState : m_rasterizerStates)
+	{
+		DX_SAFE_RELEASE( rasterizerState );
+	}
+
+	for (ID3D11DepthStencilState*& depthStencilState : m_depthStencilStates)
+	{
+		DX_SAFE_RELEASE( depthStencilState );
+	}
+
+	DX_SAFE_RELEASE( m_depthStencilView );
+	DX_SAFE_RELEASE( m_depthStencilTexture );
+
+	DX_SAFE_RELEASE( m_renderTargetView );
+	DX_SAFE_RELEASE( m_swapChain );
+	DX_SAFE_RELEASE( m_deviceContext1 );
+	DX_SAFE_RELEASE( m_deviceContext );
+	DX_SAFE_RELEASE( m_device );
+
+	// Report error leaks and release debug module
+#if defined(ENGINE_DEBUG_RENDER)
+	((IDXGIDebug*)m_dxgiDebug)->ReportLiveObjects(
+		DXGI_DEBUG_ALL,
+		(DXGI_DEBUG_RLO_FLAGS)(DXGI_DEBUG_RLO_DETAIL | DXGI_DEBUG_RLO_IGNORE_INTERNAL)
+	);
+
+	((IDXGIDebug*)m_dxgiDebug)->Release();
+	m_dxgiDebug = nullptr;
+
+	::FreeLibrary( (HMODULE)m_dxgiDebugModule );
+	m_dxgiDebugModule = nullptr;
+#endif
+}
+
+void D3D11RendererBackend::Present()
+{
+	HRESULT hr;
+	hr = m_swapChain->Present( 0, 0 );
+	if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET)
+	{
+		ERROR_AND_DIE( "Device has been lost, application will now terminate" );
+	}
+}
+
+void D3D11RendererBackend::CompileShaderToByteCode( std::vector<unsigned char>& outByteCode, char const* name, char const* source, char const* entryPoint, char const* target )
+{
+	DWORD shaderFlags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#if defined(ENGINE_DEBUG_RENDER)
+	shaderFlags = D3DCOMPILE_DEBUG;
+	shaderFlags |= D3DCOMPILE_SKIP_OPTIMIZATION;
+	shaderFlags |= D3DCOMPILE_WARNINGS_ARE_ERRORS;
+#endif
+	ID3DBlob* shaderBlob = NULL;
+	ID3DBlob* errorBlob = NULL;
+
+	HRESULT hr = D3DCompile(
+		source, strlen( source ),
+		name, nullptr, nullptr,
+		entryPoint, target, shaderFlags, 0,
+		&shaderBlob, &errorBlob
+	);
+	if (SUCCEEDED( hr ))
+	{
+		outByteCode.resize( shaderBlob->GetBufferSize() );
+		memcpy(
+			outByteCode.data(),
+			shaderBlob->GetBufferPointer(),
+			shaderBlob->GetBufferSize()
+		);
+	}
+	else
+	{
+		if (errorBlob != NULL)
+		{
+			DebuggerPrintf( (char*)errorBlob->GetBufferPointer() );
+		}
+		ERROR_AND_DIE( Stringf( "Could not compile %s", name ) );
+	}
+
+	shaderBlob->Release();
+	if (errorBlob != NULL)
+	{
+		errorBlob->Release();
+	}
+}
+
+void D3D11RendererBackend::CreateShader( Shader* shader, std::vector<unsigned char> const& vertexByteCode, std::vector<unsigned char> const& pixelByteCode, VertexType vertexType )
+{
+	HRESULT hr = m_device->CreateVertexShader(
+		vertexByteCode.data(),
+		vertexByteCode.size(),
+		NULL, &shader->m_vertexShader
+	);
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( Stringf( "Could not create vertex shader." ) );
+	}
+
+	hr = m_device->CreatePixelShader(
+		pixelByteCode.data(),
+		pixelByteCode.size(),
+		NULL, &shader->m_pixelShader
+	);
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( Stringf( "Could not create pixel shader." ) );
+	}
+
+	D3D11_INPUT_ELEMENT_DESC inputElementDesc[] = {
+		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"BITANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"JOINTINDEX", 0, DXGI_FORMAT_R32G32B32A32_UINT, 1, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"JOINTWEIGHT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0}
+	};
+
+	// every layout is a prefix of the skinned one
+	UINT numElements = 8;
+	if (vertexType == VertexType::VERTEX_PCU)
+	{
+		numElements = 3;
+	}
+	else if (vertexType == VertexType::VERTEX_PCUTBN)
+	{
+		numElements = 6;
+	}
+
+	hr = m_device->CreateInputLayout(
+		inputElementDesc, numElements,
+		vertexByteCode.data(),
+		vertexByteCode.size(),
+		&shader->m_inputLayoutForVertex
+	);
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create vertex layout" );
+	}
+	m_stats.m_shadersCreated++;
+}
+
+void D3D11RendererBackend::BindShader( Shader* shader )
+{
+	m_deviceContext->IASetInputLayout( shader->m_inputLayoutForVertex );
+	m_deviceContext->VSSetShader( shader->m_vertexShader, nullptr, 0 );
+	m_deviceContext->PSSetShader( shader->m_pixelShader, nullptr, 0 );
+	m_stats.m_shaderBinds++;
+}
+
+D3D11RenderBuffer::~D3D11RenderBuffer()
+{
+	DX_SAFE_RELEASE( m_buffer );
+}
+
+static ID3D11Buffer* GetD3D11Buffer( RenderBuffer* buffer )
+{
+	return buffer ? static_cast<D3D11RenderBuffer*>(buffer)->m_buffer : nullptr;
+}
+
+void D3D11RendererBackend::CreateBuffer( RenderBuffer*& out_buffer, size_t size, RenderBufferType type )
+{
+	D3D11_BUFFER_DESC bufferDesc = { 0 };
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = (UINT)size;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	if (type == RenderBufferType::VERTEX)
+	{
+		bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	}
+	else if (type == RenderBufferType::INDEX)
+	{
+		bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	}
+	else
+	{
+		bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	}
+
+	D3D11RenderBuffer* newBuffer = new D3D11RenderBuffer();
+	HRESULT hr = m_device->CreateBuffer( &bufferDesc, nullptr, &newBuffer->m_buffer );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create buffer" );
+	}
+	out_buffer = newBuffer;
+	m_stats.m_buffersCreated++;
+}
+
+void D3D11RendererBackend::CopyToBuffer( RenderBuffer* buffer, void const* data, size_t size )
+{
+	ID3D11Buffer* d3dBuffer = GetD3D11Buffer( buffer );
+	D3D11_MAPPED_SUBRESOURCE resource;
+	m_deviceContext->Map( d3dBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource );
+	memcpy( resource.pData, data, size );
+	m_deviceContext->Unmap( d3dBuffer, 0 );
+	m_stats.m_bytesUploaded += size;
+	m_stats.m_bufferUploads++;
+}
+
+void D3D11RendererBackend::WriteToBuffer( RenderBuffer* buffer, size_t offset, void const* data, size_t size, bool discard )
+{
+	ID3D11Buffer* d3dBuffer = GetD3D11Buffer( buffer );
+	D3D11_MAPPED_SUBRESOURCE resource;
+	m_deviceContext->Map( d3dBuffer, 0, discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &resource );
+	memcpy( (unsigned char*)resource.pData + offset, data, size );
+	m_deviceContext->Unmap( d3dBuffer, 0 );
+	m_stats.m_bytesUploaded += size;
+	m_stats.m_bufferUploads++;
+}
+
+void D3D11RendererBackend::BindVertexBuffer( int slot, RenderBuffer* buffer, unsigned int stride, unsigned int offset )
+{
+	ID3D11Buffer* d3dBuffer = GetD3D11Buffer( buffer );
+	m_deviceContext->IASetVertexBuffers( slot, 1, &d3dBuffer, &stride, &offset );
+	m_stats.m_bufferBinds++;
+}
+
+void D3D11RendererBackend::BindIndexBuffer( RenderBuffer* buffer )
+{
+	m_deviceContext->IASetIndexBuffer( GetD3D11Buffer( buffer ), DXGI_FORMAT_R32_UINT, 0 );
+	m_stats.m_bufferBinds++;
+}
+
+void D3D11RendererBackend::BindConstantBuffer( int slot, RenderBuffer* buffer )
+{
+	ID3D11Buffer* d3dBuffer = GetD3D11Buffer( buffer );
+	m_deviceContext->VSSetConstantBuffers( slot, 1, &d3dBuffer );
+	m_deviceContext->PSSetConstantBuffers( slot, 1, &d3dBuffer );
+	m_stats.m_bufferBinds++;
+}
+
+void D3D11RendererBackend::BindConstantBufferRange( int slot, RenderBuffer* buffer, size_t offset, size_t size )
+{
+	// offsets and counts are in 16 byte constants, counts must be multiples of 16
+	UINT firstConstant = (UINT)(offset / 16);
+	UINT constantCount = (UINT)(((size + 255) / 256) * 16);
+	ID3D11Buffer* d3dBuffer = GetD3D11Buffer( buffer );
+	m_deviceContext1->VSSetConstantBuffers1( slot, 1, &d3dBuffer, &firstConstant, &constantCount );
+	m_deviceContext1->PSSetConstantBuffers1( slot, 1, &d3dBuffer, &firstConstant, &constantCount );
+	m_stats.m_bufferBinds++;
+}
+
+void D3D11RendererBackend::SetPrimitiveTopology( bool isLineList )
+{
+	m_deviceContext->IASetPrimitiveTopology( isLineList ? D3D11_PRIMITIVE_TOPOLOGY_LINELIST : D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+}
+
+void D3D11RendererBackend::Draw( int vertexCount, int vertexOffset )
+{
+	m_deviceContext->Draw( vertexCount, vertexOffset );
+	m_stats.m_drawCount++;
+	m_stats.m_elementsDrawn += vertexCount;
+}
+
+void D3D11RendererBackend::DrawIndexed( int indexCount, int startIndex, int baseVertex )
+{
+	m_deviceContext->DrawIndexed( indexCount, startIndex, baseVertex );
+	m_stats.m_drawCount++;
+	m_stats.m_elementsDrawn += indexCount;
+}
+
+void D3D11RendererBackend::SetBlendMode( BlendMode blendMode )
+{
+	float blendFactor[4] = { 0.f, 0.f, 0.f, 0.f };
+	UINT SampleMask = 0xffffffff;
+	m_deviceContext->OMSetBlendState( m_blendStates[(int)blendMode], blendFactor, SampleMask );
+	m_stats.m_stateChanges++;
+}
+
+void D3D11RendererBackend::SetRasterizerMode( RasterizerMode rasterizerMode )
+{
+	m_deviceContext->RSSetState( m_rasterizerStates[(int)rasterizerMode] );
+	m_stats.m_stateChanges++;
+}
+
+void D3D11RendererBackend::SetSamplerMode( SamplerMode samplerMode, unsigned int slot )
+{
+	m_deviceContext->PSSetSamplers( slot, 1, &m_samplerStates[(int)samplerMode] );
+	m_stats.m_stateChanges++;
+}
+
+void D3D11RendererBackend::SetDepthMode( DepthMode depthMode )
+{
+	m_deviceContext->OMSetDepthStencilState( m_depthStencilStates[(int)depthMode], 0 );
+	m_stats.m_stateChanges++;
+}
+
+void D3D11RendererBackend::CreateTexture( Texture* texture, Image const& image, bool generateMips )
+{
+	if (image.GetMipCount() > 1 || image.IsCompressed() || !generateMips)
+	{
+		CreateTextureWithMips( texture, image );
+		return;
+	}
+
+	D3D11_TEXTURE2D_DESC textureDesc = {};
+	textureDesc.Width = image.GetDimensions().x;
+	textureDesc.Height = image.GetDimensions().y;
+	textureDesc.MipLevels = 0;
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.Usage = D3D11_USAGE_DEFAULT;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+	textureDesc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+
+	HRESULT hr = m_device->CreateTexture2D( &textureDesc, nullptr, &texture->m_texture );
+	if (FAILED( hr ))
+	{
+		ERROR_AND_DIE( Stringf( "Could not create texture from image for file \"%s\".", image.GetImageFilePath().c_str() ) );
+	}
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = textureDesc.Format;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Texture2D.MostDetailedMip = 0;
+	srvDesc.Texture2D.MipLevels = (UINT)-1;
+
+	hr = m_device->CreateShaderResourceView( texture->m_texture, &srvDesc, &texture->m_shaderResourceView );
+	if (FAILED( hr ))
+	{
+		ERROR_AND_DIE( Stringf( "Could not create shader resource view from image for file \"%s\".", image.GetImageFilePath().c_str() ) );
+	}
+
+	m_deviceContextMutex.lock();
+
+	m_deviceContext->UpdateSubresource( texture->m_texture, 0, nullptr, image.GetRawData(), 4 * image.GetDimensions().x, 0 );
+
+	m_deviceContext->GenerateMips( texture->m_shaderResourceView );
+
+	m_stats.m_texturesCreated++;
+	m_stats.m_bytesUploaded += (size_t)4 * image.GetDimensions().x * image.GetDimensions().y;
+
+	m_deviceContextMutex.unlock();
+}
+
+void D3D11RendererBackend::CreateTextureWithMips( Texture* texture, Image const& image )
+{
+	// every level comes from the image, so the texture is immutable and needs no device context
+	int mipCount = image.GetMipCount();
+	std::vector<D3D11_SUBRESOURCE_DATA> initialData( mipCount );
+	size_t bytesUploaded = 0;
+	for (int mipLevel = 0; mipLevel < mipCount; mipLevel++)
+	{
+		initialData[mipLevel].pSysMem = image.GetMipRawData( mipLevel );
+		initialData[mipLevel].SysMemPitch = (UINT)image.GetMipRowPitch( mipLevel );
+		bytesUploaded += image.GetMipByteSize( mipLevel );
+	}
+
+	DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	switch (image.GetCompressedFormat())
+	{
+	case BlockCompressionFormat::BC1:
+		format = DXGI_FORMAT_BC1_UNORM;
+		break;
+	case BlockCompressionFormat::BC3:
+		format = DXGI_FORMAT_BC3_UNORM;
+		break;
+	case BlockCompressionFormat::BC5:
+		format = DXGI_FORMAT_BC5_UNORM;
+		break;
+	default:
+		break;
+	}
+
+	D3D11_TEXTURE2D_DESC textureDesc = {};
+	textureDesc.Width = image.GetDimensions().x;
+	textureDesc.Height = image.GetDimensions().y;
+	textureDesc.MipLevels = mipCount;
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = format;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+	HRESULT hr = m_device->CreateTexture2D( &textureDesc, initialData.data(), &texture->m_texture );
+	if (FAILED( hr ))
+	{
+		ERROR_AND_DIE( Stringf( "Could not create texture from image for file \"%s\".", image.GetImageFilePath().c_str() ) );
+	}
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = textureDesc.Format;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Texture2D.MostDetailedMip = 0;
+	srvDesc.Texture2D.MipLevels = mipCount;
+
+	hr = m_device->CreateShaderResourceView( texture->m_texture, &srvDesc, &texture->m_shaderResourceView );
+	if (FAILED( hr ))
+	{
+		ERROR_AND_DIE( Stringf( "Could not create shader resource view from image for file \"%s\".", image.GetImageFilePath().c_str() ) );
+	}
+
+	std::lock_guard<std::mutex> lock( m_deviceContextMutex );
+	m_stats.m_texturesCreated++;
+	m_stats.m_bytesUploaded += bytesUploaded;
+}
+
+void D3D11RendererBackend::CreateRenderTexture( Texture* texture )
+{
+	D3D11_TEXTURE2D_DESC renderTextureDesc = {};
+	renderTextureDesc.Width = texture->m_dimensions.x;
+	renderTextureDesc.Height = texture->m_dimensions.y;
+	renderTextureDesc.MipLevels = 1;
+	renderTextureDesc.ArraySize = 1;
+	renderTextureDesc.Usage = D3D11_USAGE_DEFAULT;
+	renderTextureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	renderTextureDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+	renderTextureDesc.SampleDesc.Count = 1;
+	HRESULT hr = m_device->CreateTexture2D( &renderTextureDesc, nullptr, &texture->m_texture );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( "Could not create render texture" );
+	}
+	hr = m_device->CreateShaderResourceView( texture->m_texture, NULL, &texture->m_shaderResourceView );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( Stringf( "Could not create shader resource view" ) );
+	}
+	hr = m_device->CreateRenderTargetView( texture->m_texture, NULL, &texture->m_renderTargetView );
+	if (!SUCCEEDED( hr ))
+	{
+		ERROR_AND_DIE( Stringf( "Could not create render target view" ) );
+	}
+	m_stats.m_texturesCreated++;
+}
+
+void D3D11RendererBackend::BindTexture( Texture* texture, unsigned int slot )
+{
+	m_deviceContext->PSSetShaderResources( slot, 1, &texture->m_shaderResourceView );
+	m_stats.m_textureBinds++;
+}
+
+void D3D11RendererBackend::UnbindTextures( unsigned int firstSlot, int count )
+{
+	ID3D11ShaderResourceView* nullSRVs[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT] = {};
+	m_deviceContext->PSSetShaderResources( firstSlot, count, nullSRVs );
+	m_stats.m_textureBinds++;
+}
+
+void D3D11RendererBackend::SetRenderTargets( Texture* const* targets, int targetCount, bool bindDepth )
+{
+	ID3D11RenderTargetView* RTVs[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT] = {};
+	for (int i = 0; i < targetCount; i++)
+	{
+		RTVs[i] = targets[i] ? targets[i]->m_renderTargetView : m_renderTargetView;
+	}
+	m_deviceContext->OMSetRenderTargets( targetCount, RTVs, bindDepth ? m_depthStencilView : nullptr );
+	m_stats.m_renderTargetChanges++;
+}
+
+void D3D11RendererBackend::UnbindRenderTargets()
+{
+	ID3D11RenderTargetView* nullRTVs[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT] = {};
+	m_deviceContext->OMSetRenderTargets( D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT, nullRTVs, nullptr );
+	m_stats.m_renderTargetChanges++;
+}
+
+void D3D11RendererBackend::ClearRenderTarget( Texture* target, Rgba8 const& color )
+{
+	float colorAsFloats[4];
+	color.GetAsFloats( colorAsFloats );
+	m_deviceContext->ClearRenderTargetView( target ? target->m_renderTargetView : m_renderTargetView, colorAsFloats );
+}
+
+void D3D11RendererBackend::ClearDepth()
+{
+	m_deviceContext->ClearDepthStencilView( m_depthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0 );
+}
+
+void D3D11RendererBackend::SetViewport( float topLeftX, float topLeftY, float width, float height )
+{
+	D3D11_VIEWPORT viewport = { 0 };
+	viewport.TopLeftX = topLeftX;
+	viewport.TopLeftY = topLeftY;
+	viewport.Width = width;
+	viewport.Height = height;
+	viewport.MinDepth = 0.0f;
+	viewport.MaxDepth = 1.0f;
+	m_deviceContext->RSSetViewports( 1, &viewport );
+}
+
+#endif
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <mutex>
+
+#include "Engine/Renderer/RendererBackend.hpp"
+
+#define DX_SAFE_RELEASE(dxObject)		\
+{										\
+	if ((dxObject) != nullptr)			\
+	{									\
+		(dxObject)->Release();			\
+		(dxObject) = nullptr;			\
+	}									\
+}	
+
+struct ID3D11Device;
+struct ID3D11DeviceContext;
+struct ID3D11DeviceContext1;
+struct IDXGISwapChain;
+struct ID3D11RenderTargetView;
+struct ID3D11RasterizerState;
+struct ID3D11BlendState;
+struct ID3D11SamplerState;
+struct ID3D11DepthStencilView;
+struct ID3D11Texture2D;
+struct ID3D11DepthStencilState;
+struct ID3D11Buffer;
+
+class D3D11RenderBuffer : public RenderBuffer
+{
+public:
+	virtual ~D3D11RenderBuffer();
+
+	ID3D11Buffer* m_buffer = nullptr;
+};
+
+class D3D11RendererBackend : public RendererBackend
+{
+public:
+	D3D11RendererBackend() = default;
+	virtual ~D3D11RendererBackend() = default;
+
+	virtual void Startup( RenderConfig const& config, IntVec2 const& dimensions ) override;
+	virtual void Shutdown() override;
+	virtual void Present() override;
+
+	virtual void CompileShaderToByteCode( std::vector<unsigned char>& outByteCode, char const* name, char const* source, char const* entryPoint, char const* target ) override;
+	virtual void CreateShader( Shader* shader, std::vector<unsigned char> const& vertexByteCode, std::vector<unsigned char> const& pixelByteCode, VertexType vertexType ) override;
+	virtual void BindShader( Shader* shader ) override;
+
+	virtual void CreateBuffer( RenderBuffer*& out_buffer, size_t size, RenderBufferType type ) override;
+	virtual void CopyToBuffer( RenderBuffer* buffer, void const* data, size_t size ) override;
+	virtual void WriteToBuffer( RenderBuffer* buffer, size_t offset, void const* data, size_t size, bool discard ) override;
+	virtual void BindVertexBuffer( int slot, RenderBuffer* buffer, unsigned int stride, unsigned int offset ) override;
+	virtual void BindIndexBuffer( RenderBuffer* buffer ) override;
+	virtual void BindConstantBuffer( int slot, RenderBuffer* buffer ) override;
+	virtual void BindConstantBufferRange( int slot, RenderBuffer* buffer, size_t offset, size_t size ) override;
+	virtual bool SupportsConstantBufferOffsets() const override { return m_supportsConstantBufferOffsets; }
+	virtual void SetPrimitiveTopology( bool isLineList ) override;
+	virtual void Draw( int vertexCount, int vertexOffset ) override;
+	virtual void DrawIndexed( int indexCount, int startIndex = 0, int baseVertex = 0 ) override;
+
+	virtual void SetBlendMode( BlendMode blendMode ) override;
+	virtual void SetRasterizerMode( RasterizerMode rasterizerMode ) override;
+	virtual void SetSamplerMode( SamplerMode samplerMode, unsigned int slot ) override;
+	virtual void SetDepthMode( DepthMode depthMode ) override;
+
+	virtual void CreateTexture( Texture* texture, Image const& image, bool generateMips ) override;
+	virtual void CreateRenderTexture( Texture* texture ) override;
+	virtual void BindTexture( Texture* texture, unsigned int slot ) override;
+	virtual void UnbindTextures( unsigned int firstSlot, int count ) override;
+
+	virtual void SetRenderTargets( Texture* const* targets, int targetCount, bool bindDepth ) override;
+	virtual void UnbindRenderTargets() override;
+	virtual void ClearRenderTarget( Texture* target, Rgba8 const& color ) override;
+	virtual void ClearDepth() override;
+	virtual void SetViewport( float topLeftX, float topLeftY, float width, float height ) override;
+
+	// For D3D11 only systems such as ImGui, reached through Renderer::GetBackend
+	ID3D11Device* GetD3D11Device() const { return m_device; }
+	ID3D11DeviceContext* GetD3D11DeviceContext() const { return m_deviceContext; }
+	ID3D11RenderTargetView* GetD3D11RenderTargetView() const { return m_renderTargetView; }
+
+private:
+	// uploads the image's own levels, uncompressed or block compressed, instead of generating mips on the GPU
+	void CreateTextureWithMips( Texture* texture, Image const& image );
+
+private:
+	void* m_dxgiDebugModule = nullptr;
+	void* m_dxgiDebug = nullptr;
+	ID3D11Device* m_device = nullptr;
+	ID3D11DeviceContext* m_deviceContext = nullptr;
+	ID3D11DeviceContext1* m_deviceContext1 = nullptr;
+	bool m_supportsConstantBufferOffsets = false;
+	IDXGISwapChain* m_swapChain = nullptr;
+	ID3D11RenderTargetView* m_renderTargetView = nullptr;
+
+	ID3D11BlendState* m_blendStates[(int)(BlendMode::COUNT)] = {};
+	ID3D11SamplerState* m_samplerStates[(int)(SamplerMode::COUNT)] = {};
+	ID3D11RasterizerState* m_rasterizerStates[(int)(RasterizerMode::COUNT)] = {};
+	ID3D11DepthStencilState* m_depthStencilStates[(int)(DepthMode::COUNT)] = {};
+
+	ID3D11DepthStencilView* m_depthStencilView = nullptr;
+	ID3D11Texture2D* m_depthStencilTexture = nullptr;
+
+	// textures are created from loading threads while the main thread draws
+	std::mutex m_deviceContextMutex;
+};
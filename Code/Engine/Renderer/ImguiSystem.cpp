@@ -1,9 +1,12 @@
+#if defined( _WIN32 )
+
 #include <d3d11.h>
 
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Renderer/ImGuiSystem.hpp"
 #include "Engine/Renderer/Window.hpp"
 #include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/D3D11RendererBackend.hpp"
 
 ImGuiSystem::ImGuiSystem( Renderer* renderer, Window* window )
 	: m_rendererRef( renderer )
@@ -24,7 +27,8 @@ void ImGuiSystem::Startup()
 	ImGui::CreateContext();
 	ImGuiIO& io = ImGui::GetIO();
 	ImGui_ImplWin32_Init( m_windowRef->GetHwnd() );
-	ImGui_ImplDX11_Init( m_rendererRef->GetD3D11Device(), m_rendererRef->GetD3D11DeviceContext() );
+	D3D11RendererBackend* backend = static_cast<D3D11RendererBackend*>(m_rendererRef->GetBackend());
+	ImGui_ImplDX11_Init( backend->GetD3D11Device(), backend->GetD3D11DeviceContext() );
 	ImGui::StyleColorsDark();
 	UNUSED( io );
 }
@@ -39,8 +43,9 @@ void ImGuiSystem::Render()
 {
 	ImGui::Render();
 	ImDrawData* data = ImGui::GetDrawData();
-	ID3D11RenderTargetView* dx11_rtv = m_rendererRef->GetD3D11RenderTargetView();
-	ID3D11DeviceContext* context = m_rendererRef->GetD3D11DeviceContext();
+	D3D11RendererBackend* backend = static_cast<D3D11RendererBackend*>(m_rendererRef->GetBackend());
+	ID3D11RenderTargetView* dx11_rtv = backend->GetD3D11RenderTargetView();
+	ID3D11DeviceContext* context = backend->GetD3D11DeviceContext();
 	context->OMSetRenderTargets( 1, &dx11_rtv, NULL );
 
 	ImGui_ImplDX11_RenderDrawData( data );
@@ -49,3 +54,5 @@ void ImGuiSystem::Render()
 void ImGuiSystem::EndFrame()
 {
 }
+
+#endif
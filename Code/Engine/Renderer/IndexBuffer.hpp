@@ -1,6 +1,8 @@
 #pragma once
 
-struct ID3D11Buffer;
+#include <cstddef>
+
+class RenderBuffer;
 
 class IndexBuffer
 {
@@ -11,6 +13,6 @@ public:
 	IndexBuffer( IndexBuffer const& copy ) = delete;
 	virtual ~IndexBuffer();
 
-	ID3D11Buffer* m_buffer = nullptr;
+	RenderBuffer* m_buffer = nullptr;
 	size_t m_size = 0;
 };
@@ -48,11 +48,11 @@ Material::Material( std::string XmlPath )
 	}
 	if (normalTexturePath != "")
 	{
-		m_normalMap = g_theRenderer->CreateOrGetTextureFromFile( normalTexturePath.c_str() );
+		m_normalMap = g_theRenderer->CreateOrGetTextureFromFile( normalTexturePath.c_str(), TextureUsage::NORMAL_MAP );
 	}
 	if (specTexturePath != "")
 	{
-		m_specGlossEmitMap = g_theRenderer->CreateOrGetTextureFromFile( specTexturePath.c_str() );
+		m_specGlossEmitMap = g_theRenderer->CreateOrGetTextureFromFile( specTexturePath.c_str(), TextureUsage::LINEAR );
 	}
 	if (transparencyPath != "")
 	{
@@ -0,0 +1,224 @@
+#include "Engine/Renderer/NullRendererBackend.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Image.hpp"
+
+void NullRendererBackend::Startup( RenderConfig const& config, IntVec2 const& dimensions )
+{
+	UNUSED( config );
+	UNUSED( dimensions );
+}
+
+void NullRendererBackend::Shutdown()
+{
+	m_recordedCommands.clear();
+}
+
+void NullRendererBackend::Present()
+{
+}
+
+void NullRendererBackend::CompileShaderToByteCode( std::vector<unsigned char>& outByteCode, char const* name, char const* source, char const* entryPoint, char const* target )
+{
+	UNUSED( name );
+	UNUSED( source );
+	UNUSED( entryPoint );
+	UNUSED( target );
+	outByteCode.clear();
+}
+
+void NullRendererBackend::CreateShader( Shader* shader, std::vector<unsigned char> const& vertexByteCode, std::vector<unsigned char> const& pixelByteCode, VertexType vertexType )
+{
+	UNUSED( shader );
+	UNUSED( vertexByteCode );
+	UNUSED( pixelByteCode );
+	UNUSED( vertexType );
+	m_stats.m_shadersCreated++;
+}
+
+void NullRendererBackend::BindShader( Shader* shader )
+{
+	UNUSED( shader );
+	m_stats.m_shaderBinds++;
+	Record( RecordedRenderCommandType::BIND_SHADER, 0 );
+}
+
+void NullRendererBackend::CreateBuffer( RenderBuffer*& out_buffer, size_t size, RenderBufferType type )
+{
+	UNUSED( size );
+	UNUSED( type );
+	out_buffer = nullptr;
+	m_stats.m_buffersCreated++;
+}
+
+void NullRendererBackend::CopyToBuffer( RenderBuffer* buffer, void const* data, size_t size )
+{
+	UNUSED( buffer );
+	UNUSED( data );
+	m_stats.m_bytesUploaded += size;
+	m_stats.m_bufferUploads++;
+	Record( RecordedRenderCommandType::UPLOAD, size );
+}
+
+void NullRendererBackend::WriteToBuffer( RenderBuffer* buffer, size_t offset, void const* data, size_t size, bool discard )
+{
+	UNUSED( buffer );
+	UNUSED( offset );
+	UNUSED( data );
+	UNUSED( discard );
+	m_stats.m_bytesUploaded += size;
+	m_stats.m_bufferUploads++;
+	Record( RecordedRenderCommandType::UPLOAD, size );
+}
+
+void NullRendererBackend::BindVertexBuffer( int slot, RenderBuffer* buffer, unsigned int stride, unsigned int offset )
+{
+	UNUSED( buffer );
+	UNUSED( stride );
+	UNUSED( offset );
+	m_stats.m_bufferBinds++;
+	Record( RecordedRenderCommandType::BIND_BUFFER, (size_t)slot );
+}
+
+void NullRendererBackend::BindIndexBuffer( RenderBuffer* buffer )
+{
+	UNUSED( buffer );
+	m_stats.m_bufferBinds++;
+	Record( RecordedRenderCommandType::BIND_BUFFER, 0 );
+}
+
+void NullRendererBackend::BindConstantBuffer( int slot, RenderBuffer* buffer )
+{
+	UNUSED( buffer );
+	m_stats.m_bufferBinds++;
+	Record( RecordedRenderCommandType::BIND_BUFFER, (size_t)slot );
+}
+
+void NullRendererBackend::BindConstantBufferRange( int slot, RenderBuffer* buffer, size_t offset, size_t size )
+{
+	UNUSED( buffer );
+	UNUSED( offset );
+	UNUSED( size );
+	m_stats.m_bufferBinds++;
+	Record( RecordedRenderCommandType::BIND_BUFFER, (size_t)slot );
+}
+
+void NullRendererBackend::SetPrimitiveTopology( bool isLineList )
+{
+	UNUSED( isLineList );
+}
+
+void NullRendererBackend::Draw( int vertexCount, int vertexOffset )
+{
+	UNUSED( vertexOffset );
+	m_stats.m_drawCount++;
+	m_stats.m_elementsDrawn += vertexCount;
+	Record( RecordedRenderCommandType::DRAW, (size_t)vertexCount );
+}
+
+void NullRendererBackend::DrawIndexed( int indexCount, int startIndex, int baseVertex )
+{
+	UNUSED( startIndex );
+	UNUSED( baseVertex );
+	m_stats.m_drawCount++;
+	m_stats.m_elementsDrawn += indexCount;
+	Record( RecordedRenderCommandType::DRAW, (size_t)indexCount );
+}
+
+void NullRendererBackend::SetBlendMode( BlendMode blendMode )
+{
+	m_stats.m_stateChanges++;
+	Record( RecordedRenderCommandType::SET_STATE, (size_t)blendMode );
+}
+
+void NullRendererBackend::SetRasterizerMode( RasterizerMode rasterizerMode )
+{
+	m_stats.m_stateChanges++;
+	Record( RecordedRenderCommandType::SET_STATE, (size_t)rasterizerMode );
+}
+
+void NullRendererBackend::SetSamplerMode( SamplerMode samplerMode, unsigned int slot )
+{
+	UNUSED( slot );
+	m_stats.m_stateChanges++;
+	Record( RecordedRenderCommandType::SET_STATE, (size_t)samplerMode );
+}
+
+void NullRendererBackend::SetDepthMode( DepthMode depthMode )
+{
+	m_stats.m_stateChanges++;
+	Record( RecordedRenderCommandType::SET_STATE, (size_t)depthMode );
+}
+
+void NullRendererBackend::CreateTexture( Texture* texture, Image const& image, bool generateMips )
+{
+	UNUSED( texture );
+	UNUSED( generateMips );
+	m_stats.m_texturesCreated++;
+	for (int mipLevel = 0; mipLevel < image.GetMipCount(); mipLevel++)
+	{
+		m_stats.m_bytesUploaded += image.GetMipByteSize( mipLevel );
+	}
+}
+
+void NullRendererBackend::CreateRenderTexture( Texture* texture )
+{
+	UNUSED( texture );
+	m_stats.m_texturesCreated++;
+}
+
+void NullRendererBackend::BindTexture( Texture* texture, unsigned int slot )
+{
+	UNUSED( texture );
+	m_stats.m_textureBinds++;
+	Record( RecordedRenderCommandType::BIND_TEXTURE, slot );
+}
+
+void NullRendererBackend::UnbindTextures( unsigned int firstSlot, int count )
+{
+	UNUSED( count );
+	m_stats.m_textureBinds++;
+	Record( RecordedRenderCommandType::BIND_TEXTURE, firstSlot );
+}
+
+void NullRendererBackend::SetRenderTargets( Texture* const* targets, int targetCount, bool bindDepth )
+{
+	UNUSED( targets );
+	UNUSED( bindDepth );
+	m_stats.m_renderTargetChanges++;
+	Record( RecordedRenderCommandType::SET_RENDER_TARGETS, (size_t)targetCount );
+}
+
+void NullRendererBackend::UnbindRenderTargets()
+{
+	m_stats.m_renderTargetChanges++;
+	Record( RecordedRenderCommandType::SET_RENDER_TARGETS, 0 );
+}
+
+void NullRendererBackend::ClearRenderTarget( Texture* target, Rgba8 const& color )
+{
+	UNUSED( target );
+	UNUSED( color );
+}
+
+void NullRendererBackend::ClearDepth()
+{
+}
+
+void NullRendererBackend::SetViewport( float topLeftX, float topLeftY, float width, float height )
+{
+	UNUSED( topLeftX );
+	UNUSED( topLeftY );
+	UNUSED( width );
+	UNUSED( height );
+}
+
+void NullRendererBackend::Record( RecordedRenderCommandType type, size_t value )
+{
+	if (!m_isRecording)
+		return;
+
+	RecordedRenderCommand command;
+	command.m_type = type;
+	command.m_value = value;
+	m_recordedCommands.push_back( command );
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Engine/Renderer/RendererBackend.hpp"
+
+enum class RecordedRenderCommandType
+{
+	BIND_SHADER,
+	BIND_TEXTURE,
+	BIND_BUFFER,
+	UPLOAD,
+	SET_STATE,
+	SET_RENDER_TARGETS,
+	DRAW,
+	COUNT
+};
+
+struct RecordedRenderCommand
+{
+	RecordedRenderCommandType m_type = RecordedRenderCommandType::COUNT;
+	// draw element count, upload byte count, state enum value or bind slot
+	size_t m_value = 0;
+};
+
+// Accepts every call without a device so the CPU side of rendering can run and be measured headless
+class NullRendererBackend : public RendererBackend
+{
+public:
+	NullRendererBackend() = default;
+	virtual ~NullRendererBackend() = default;
+
+	virtual void Startup( RenderConfig const& config, IntVec2 const& dimensions ) override;
+	virtual void Shutdown() override;
+	virtual void Present() override;
+
+	virtual void CompileShaderToByteCode( std::vector<unsigned char>& outByteCode, char const* name, char const* source, char const* entryPoint, char const* target ) override;
+	virtual void CreateShader( Shader* shader, std::vector<unsigned char> const& vertexByteCode, std::vector<unsigned char> const& pixelByteCode, VertexType vertexType ) override;
+	virtual void BindShader( Shader* shader ) override;
+
+	virtual void CreateBuffer( RenderBuffer*& out_buffer, size_t size, RenderBufferType type ) override;
+	virtual void CopyToBuffer( RenderBuffer* buffer, void const* data, size_t size ) override;
+	virtual void WriteToBuffer( RenderBuffer* buffer, size_t offset, void const* data, size_t size, bool discard ) override;
+	virtual void BindVertexBuffer( int slot, RenderBuffer* buffer, unsigned int stride, unsigned int offset ) override;
+	virtual void BindIndexBuffer( RenderBuffer* buffer ) override;
+	virtual void BindConstantBuffer( int slot, RenderBuffer* buffer ) override;
+	virtual void BindConstantBufferRange( int slot, RenderBuffer* buffer, size_t offset, size_t size ) override;
+	virtual bool SupportsConstantBufferOffsets() const override { return true; }
+	virtual void SetPrimitiveTopology( bool isLineList ) override;
+	virtual void Draw( int vertexCount, int vertexOffset ) override;
+	virtual void DrawIndexed( int indexCount, int startIndex = 0, int baseVertex = 0 ) override;
+
+	virtual void SetBlendMode( BlendMode blendMode ) override;
+	virtual void SetRasterizerMode( RasterizerMode rasterizerMode ) override;
+	virtual void SetSamplerMode( SamplerMode samplerMode, unsigned int slot ) override;
+	virtual void SetDepthMode( DepthMode depthMode ) override;
+
+	virtual void CreateTexture( Texture* texture, Image const& image, bool generateMips ) override;
+	virtual void CreateRenderTexture( Texture* texture ) override;
+	virtual void BindTexture( Texture* texture, unsigned int slot ) override;
+	virtual void UnbindTextures( unsigned int firstSlot, int count ) override;
+
+	virtual void SetRenderTargets( Texture* const* targets, int targetCount, bool bindDepth ) override;
+	virtual void UnbindRenderTargets() override;
+	virtual void ClearRenderTarget( Texture* target, Rgba8 const& color ) override;
+	virtual void ClearDepth() override;
+	virtual void SetViewport( float topLeftX, float topLeftY, float width, float height ) override;
+
+public:
+	// Off by default, recording every call costs memory on long runs
+	void SetRecording( bool isRecording ) { m_isRecording = isRecording; }
+	std::vector<RecordedRenderCommand> const& GetRecordedCommands() const { return m_recordedCommands; }
+	void ClearRecordedCommands() { m_recordedCommands.clear(); }
+
+private:
+	void Record( RecordedRenderCommandType type, size_t value );
+
+private:
+	bool m_isRecording = false;
+	std::vector<RecordedRenderCommand> m_recordedCommands;
+};
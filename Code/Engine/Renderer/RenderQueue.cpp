@@ -0,0 +1,232 @@
+#include <cstring>
+
+#include "Engine/Renderer/RenderQueue.hpp"
+#include "Engine/Renderer/Shader.hpp"
+#include "Engine/Renderer/Material.hpp"
+
+constexpr unsigned int k_sortKeyShaderBits = 12;
+constexpr unsigned int k_sortKeyMaterialBits = 22;
+constexpr unsigned int k_sortKeyDepthBits = 24;
+
+unsigned long long RenderQueue::MakeSortKey( RenderPass pass, BlendMode blendMode, unsigned int shaderId, unsigned int materialId, float depth )
+{
+	// positive floats keep their order when compared as integers, so the top bits of the float are a free quantization
+	if (!(depth > 0.f))
+	{
+		depth = 0.f;
+	}
+	unsigned int depthBits = 0;
+	memcpy( &depthBits, &depth, sizeof( depthBits ) );
+	unsigned long long depthKey = depthBits >> (32 - k_sortKeyDepthBits);
+
+	unsigned long long shaderKey = shaderId & ((1u << k_sortKeyShaderBits) - 1);
+	unsigned long long materialKey = materialId & ((1u << k_sortKeyMaterialBits) - 1);
+
+	unsigned long long key = (unsigned long long)pass << 60;
+	key |= (unsigned long long)blendMode << 58;
+	if (blendMode == BlendMode::OPAQUE)
+	{
+		// front to back, after shader and material so state changes win over overdraw
+		key |= shaderKey << (k_sortKeyMaterialBits + k_sortKeyDepthBits);
+		key |= materialKey << k_sortKeyDepthBits;
+		key |= depthKey;
+	}
+	else
+	{
+		// back to front
+		depthKey = ((1ull << k_sortKeyDepthBits) - 1) - depthKey;
+		key |= depthKey << (k_sortKeyShaderBits + k_sortKeyMaterialBits);
+		key |= shaderKey << k_sortKeyMaterialBits;
+		key |= materialKey;
+	}
+	return key;
+}
+
+void RenderQueue::Submit( RenderCommand const& command )
+{
+	unsigned int shaderId = GetSortId( command.m_shader, m_shaderIds, (1u << k_sortKeyShaderBits) - 1 );
+	unsigned int materialId = GetSortId( command.m_material ? (void const*)command.m_material : (void const*)command.m_textures[0], m_materialIds, (1u << k_sortKeyMaterialBits) - 1 );
+
+	SortEntry entry;
+	entry.m_key = MakeSortKey( command.m_pass, command.m_blendMode, shaderId, materialId, command.m_depth );
+	entry.m_commandIndex = (unsigned int)m_commands.size();
+
+	m_commands.push_back( command );
+	m_sortedEntries.push_back( entry );
+	m_isSorted = false;
+}
+
+void RenderQueue::Sort()
+{
+	if (m_isSorted)
+		return;
+	m_isSorted = true;
+
+	// LSD radix sort, a byte per pass, stable so equal keys keep their submit order
+	int count = (int)m_sortedEntries.size();
+	if (count <= 1)
+		return;
+	m_sortScratch.resize( count );
+	SortEntry* source = m_sortedEntries.data();
+	SortEntry* destination = m_sortScratch.data();
+
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		int offsets[256] = {};
+		for (int i = 0; i < count; i++)
+		{
+			offsets[(source[i].m_key >> shift) & 0xff]++;
+		}
+
+		// every key has the same byte here, nothing to move
+		if (offsets[(source[0].m_key >> shift) & 0xff] == count)
+			continue;
+
+		int total = 0;
+		for (int bucket = 0; bucket < 256; bucket++)
+		{
+			int bucketCount = offsets[bucket];
+			offsets[bucket] = total;
+			total += bucketCount;
+		}
+		for (int i = 0; i < count; i++)
+		{
+			destination[offsets[(source[i].m_key >> shift) & 0xff]++] = source[i];
+		}
+
+		SortEntry* swap = source;
+		source = destination;
+		destination = swap;
+	}
+
+	if (source != m_sortedEntries.data())
+	{
+		m_sortedEntries.swap( m_sortScratch );
+	}
+}
+
+RenderQueueStats RenderQueue::Execute( Renderer* renderer )
+{
+	Sort();
+
+	m_jointPalettes.clear();
+	m_jointPaletteIndices.clear();
+	if (renderer)
+	{
+		for (SortEntry const& entry : m_sortedEntries)
+		{
+			RenderCommand const& command = m_commands[entry.m_commandIndex];
+			if (command.m_jointTransforms && command.m_joints
+				&& m_jointPaletteIndices.emplace( command.m_jointTransforms, (int)m_jointPalettes.size() ).second)
+			{
+				JointPalette palette;
+				palette.m_globalTransforms = command.m_jointTransforms;
+				palette.m_joints = command.m_joints;
+				m_jointPalettes.push_back( palette );
+			}
+		}
+		renderer->UploadJointPalettes( m_jointPalettes );
+	}
+
+	RenderQueueStats stats;
+	RenderCommand const* previous = nullptr;
+	for (SortEntry const& entry : m_sortedEntries)
+	{
+		RenderCommand const& command = m_commands[entry.m_commandIndex];
+
+		if (!previous || previous->m_shader != command.m_shader)
+		{
+			stats.m_shaderChanges++;
+			if (renderer)
+				renderer->BindShader( command.m_shader );
+		}
+
+		for (int slot = 0; slot < k_renderCommandTextureCount; slot++)
+		{
+			// an empty slot is a change too, BindTexture puts the default texture back instead of leaving the last one bound
+			Texture* texture = command.m_textures[slot];
+			if (!previous || previous->m_textures[slot] != texture)
+			{
+				stats.m_textureChanges++;
+				if (renderer)
+					renderer->BindTexture( texture, slot );
+			}
+		}
+
+		if (!previous || previous->m_blendMode != command.m_blendMode)
+		{
+			stats.m_stateChanges++;
+			if (renderer)
+				renderer->SetBlendMode( command.m_blendMode );
+		}
+		if (!previous || previous->m_depthMode != command.m_depthMode)
+		{
+			stats.m_stateChanges++;
+			if (renderer)
+				renderer->SetDepthMode( command.m_depthMode );
+		}
+		if (!previous || previous->m_rasterizerMode != command.m_rasterizerMode)
+		{
+			stats.m_stateChanges++;
+			if (renderer)
+				renderer->SetRasterizerState( command.m_rasterizerMode );
+		}
+		if (!previous || previous->m_samplerMode != command.m_samplerMode)
+		{
+			stats.m_stateChanges++;
+			if (renderer)
+				renderer->SetSamplerMode( command.m_samplerMode );
+		}
+
+		if (!previous || !(previous->m_modelColor == command.m_modelColor)
+			|| memcmp( previous->m_modelMatrix.m_values, command.m_modelMatrix.m_values, sizeof( command.m_modelMatrix.m_values ) ) != 0)
+		{
+			stats.m_modelConstantUpdates++;
+			if (renderer)
+				renderer->SetModelConstants( command.m_modelMatrix, command.m_modelColor );
+		}
+		if (command.m_jointTransforms && command.m_joints
+			&& (!previous || previous->m_jointTransforms != command.m_jointTransforms || previous->m_joints != command.m_joints))
+		{
+			stats.m_jointConstantUpdates++;
+			if (renderer)
+				renderer->BindJointPalette( m_jointPalettes[m_jointPaletteIndices[command.m_jointTransforms]] );
+		}
+
+		stats.m_drawCount++;
+		if (renderer)
+		{
+			if (command.m_indexBuffer && command.m_jointBuffer)
+				renderer->DrawVertexAndIndexBuffer( command.m_vertexBuffer, command.m_jointBuffer, command.m_indexBuffer, command.m_count );
+			else if (command.m_indexBuffer)
+				renderer->DrawVertexAndIndexBuffer( command.m_vertexBuffer, command.m_indexBuffer, command.m_count, command.m_vertexType );
+			else
+				renderer->DrawVertexBuffer( command.m_vertexBuffer, command.m_count, command.m_vertexOffset );
+		}
+
+		previous = &command;
+	}
+	return stats;
+}
+
+void RenderQueue::Clear()
+{
+	m_commands.clear();
+	m_sortedEntries.clear();
+	m_isSorted = true;
+}
+
+unsigned int RenderQueue::GetSortId( void const* resource, std::unordered_map<void const*, unsigned int>& ids, unsigned int maxId )
+{
+	if (!resource)
+		return 0;
+
+	auto found = ids.find( resource );
+	if (found != ids.end())
+		return found->second;
+
+	// ids wrap once a field is full, colliding resources only lose some batching
+	unsigned int newId = (unsigned int)(ids.size() % maxId) + 1;
+	ids[resource] = newId;
+	return newId;
+}
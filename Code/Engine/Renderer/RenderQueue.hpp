@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Math/Mat44.hpp"
+
+class Material;
+
+constexpr int k_renderCommandTextureCount = 3;
+
+// Passes are drawn in this order, every pass is sorted on its own
+enum class RenderPass
+{
+	GEOMETRY,
+	TRANSLUCENT,
+	OVERLAY,
+	COUNT
+};
+
+// One draw with everything it needs bound, submitted to a RenderQueue instead of drawing right away
+struct RenderCommand
+{
+	RenderPass m_pass = RenderPass::GEOMETRY;
+	float m_depth = 0.f;
+
+	Shader* m_shader = nullptr;
+	Material const* m_material = nullptr;
+	Texture* m_textures[k_renderCommandTextureCount] = {};
+
+	BlendMode m_blendMode = BlendMode::OPAQUE;
+	DepthMode m_depthMode = DepthMode::ENABLED;
+	RasterizerMode m_rasterizerMode = RasterizerMode::SOLID_CULL_BACK;
+	SamplerMode m_samplerMode = SamplerMode::POINT_CLAMP;
+
+	Mat44 m_modelMatrix;
+	Rgba8 m_modelColor = Rgba8::WHITE;
+	// skinned draws only, both vectors must stay alive until the queue is executed
+	std::vector<Mat44> const* m_jointTransforms = nullptr;
+	std::vector<Joint> const* m_joints = nullptr;
+
+	VertexBuffer* m_vertexBuffer = nullptr;
+	VertexBuffer* m_jointBuffer = nullptr;
+	IndexBuffer* m_indexBuffer = nullptr;
+	VertexType m_vertexType = VertexType::VERTEX_PCU;
+	int m_count = 0;
+	int m_vertexOffset = 0;
+};
+
+struct RenderQueueStats
+{
+	int m_drawCount = 0;
+	int m_shaderChanges = 0;
+	int m_textureChanges = 0;
+	int m_stateChanges = 0;
+	int m_modelConstantUpdates = 0;
+	int m_jointConstantUpdates = 0;
+};
+
+class RenderQueue
+{
+public:
+	RenderQueue() = default;
+	~RenderQueue() = default;
+
+	// Key layout from the most significant bit: pass(4) blend(2) shader(12) material(22) depth(24)
+	// Translucent blend modes move depth above shader and material so they still draw back to front
+	static unsigned long long MakeSortKey( RenderPass pass, BlendMode blendMode, unsigned int shaderId, unsigned int materialId, float depth );
+
+	void Submit( RenderCommand const& command );
+	void Sort();
+	// Draws every command in key order and only rebinds what differs from the previous draw
+	// Joint palettes of all skinned commands are uploaded together before the first draw
+	// With no renderer nothing is issued, the transitions are only counted
+	RenderQueueStats Execute( Renderer* renderer );
+	void Clear();
+
+	int GetCommandCount() const { return (int)m_commands.size(); }
+	RenderCommand const& GetSortedCommand( int index ) const { return m_commands[m_sortedEntries[index].m_commandIndex]; }
+
+private:
+	struct SortEntry
+	{
+		unsigned long long m_key = 0;
+		unsigned int m_commandIndex = 0;
+	};
+
+	unsigned int GetSortId( void const* resource, std::unordered_map<void const*, unsigned int>& ids, unsigned int maxId );
+
+private:
+	std::vector<RenderCommand> m_commands;
+	std::vector<SortEntry> m_sortedEntries;
+	std::vector<SortEntry> m_sortScratch;
+	bool m_isSorted = true;
+
+	// ids stay stable across frames so identical scenes produce identical keys
+	std::unordered_map<void const*, unsigned int> m_shaderIds;
+	std::unordered_map<void const*, unsigned int> m_materialIds;
+
+	// one per distinct joint transform array, rebuilt every Execute
+	std::vector<JointPalette> m_jointPalettes;
+	std::unordered_map<void const*, int> m_jointPaletteIndices;
+};
@@ -1,22 +1,12 @@
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
-#include <d3d11.h>
-#include <d3dcompiler.h>
-#include <dxgi.h>
-#include <mutex>
-
-#pragma comment(lib, "d3d11.lib")
-#pragma comment(lib, "dxgi.lib")
-#pragma comment(lib, "d3dcompiler.lib")
-
 #include <filesystem>
 
 #include "Engine/Renderer/Renderer.hpp"
+#include "Engine/Renderer/RendererBackend.hpp"
+#include "Engine/Renderer/NullRendererBackend.hpp"
 #include "Engine/Renderer/Shader.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/FileUtil.hpp"
-#include "Engine/Renderer/Window.hpp"
 #include "Engine/Renderer/VertexBuffer.hpp"
 #include "Engine/Renderer/IndexBuffer.hpp"
 #include "Engine/Renderer/ConstantBuffer.hpp"
@@ -24,12 +14,18 @@
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Model/Vertex_Anim.hpp"
 #include "Engine/Core/Image.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/JobSystem.hpp"
 #include "Engine/Math/Mat44.hpp"
 #define STB_IMAGE_IMPLEMENTATION
 #include "ThirdParty/stbi/stb_image.h"
 #include "Engine/Model/ModelUtility.hpp"
 
-std::mutex deviceContextMutex;
+// D3D11 and the Win32 window only build on Windows, elsewhere the renderer always runs on the null backend
+#if defined( _WIN32 )
+#include "Engine/Renderer/D3D11RendererBackend.hpp"
+#include "Engine/Renderer/Window.hpp"
+#endif
 
 Renderer* g_theRenderer = nullptr;
 
@@ -84,370 +80,160 @@ Renderer::~Renderer() {}
 
 void Renderer::Startup() 
 {
-	// Create debug module
-#if defined(ENGINE_DEBUG_RENDER)
-	m_dxgiDebugModule = (void*)::LoadLibraryA( "dxgidebug.dll" );
-	if (m_dxgiDebugModule == nullptr)
+#if defined( _WIN32 )
+	if (!m_config.m_headless)
 	{
-		ERROR_AND_DIE( "Could not load dxgidebug.dll" );
+		m_backend = new D3D11RendererBackend();
 	}
-
-	typedef HRESULT( WINAPI* GetDebugModuleCB )(REFIID, void**);
-	((GetDebugModuleCB)::GetProcAddress( (HMODULE)m_dxgiDebugModule, "DXGIGetDebugInterface" ))
-		(__uuidof(IDXGIDebug), &m_dxgiDebug);
-
-	if (m_dxgiDebug == nullptr)
-	{
-		ERROR_AND_DIE( "Could not load debug module" );
-	}
-#endif
-
-	// Render startup
-	unsigned int deviceFlags = 0;
-#if defined(ENGINE_DEBUG_RENDER)
-	deviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
+	else
 #endif
-
-	// Create device and swap chain
-	DXGI_SWAP_CHAIN_DESC swapChainDesc = { 0 };
-	swapChainDesc.BufferDesc.Width = m_config.m_window->GetClientDimensions().x;
-	swapChainDesc.BufferDesc.Height = m_config.m_window->GetClientDimensions().y;
-	swapChainDesc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-	swapChainDesc.SampleDesc.Count = 1;
-	swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-	swapChainDesc.BufferCount = 2;
-	swapChainDesc.OutputWindow = (HWND)m_config.m_window->GetHwnd();
-	swapChainDesc.Windowed = true;
-	swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
-
-	HRESULT hr;
-	hr = D3D11CreateDeviceAndSwapChain(
-		nullptr, D3D_DRIVER_TYPE_HARDWARE, NULL, deviceFlags,
-		nullptr, 0, D3D11_SDK_VERSION, &swapChainDesc,
-		&m_swapChain, &m_device, nullptr, &m_deviceContext
-	);
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create D3D 11 device and swap chain" );
-	}
-
-	// Get back buffer texture
-	ID3D11Texture2D* backBuffer;
-	hr = m_swapChain->GetBuffer( 0, __uuidof(ID3D11Texture2D), (void**)&backBuffer );
-	if (!SUCCEEDED( hr ))
 	{
-		ERROR_AND_DIE( "Could not get swap chain buffer" );
+		m_backend = new NullRendererBackend();
 	}
+	m_backend->Startup( m_config, GetRenderDimensions() );
+	m_shaderCache = new ShaderCache( m_config.m_shaderCacheConfig );
+	m_textureStreamingCounter = new JobCounter();
 
-	hr = m_device->CreateRenderTargetView( backBuffer, NULL, &m_renderTargetView );
-	if (!SUCCEEDED( hr ))
+	if (g_eventSystem != nullptr)
 	{
-		ERROR_AND_DIE( "Could not create render target view for swap chain buffer" );
+		g_eventSystem->SubscribeEventCallBackFunc( "ImageConversionBenchmark", &Command_ImageConversionBenchmark );
 	}
 
-	backBuffer->Release();
-
 	BindShader( m_defaultShader = CreateShader( "Default", defaultShaderSource ) );
 	//BindShader( CreateShader( "Data/Shaders/Default.hlsl" ) );
 	//BindShader( CreateShader( "Data/Shaders/Diffuse.hlsl", VertexType::VERTEX_PCUTBN ) );
 	m_immediateVBO = CreateVertexBuffer( 1 );
 	m_immediateIBO = CreateIndexBuffer( 1 );
-
-	// Set rasterizer state
-	D3D11_RASTERIZER_DESC rasterizerDesc = {};
-	rasterizerDesc.FillMode = D3D11_FILL_SOLID;
-	rasterizerDesc.CullMode = D3D11_CULL_NONE;
-	rasterizerDesc.FrontCounterClockwise = true;
-	rasterizerDesc.DepthBias = 0;
-	rasterizerDesc.DepthBiasClamp = 0;
-	rasterizerDesc.SlopeScaledDepthBias = 0.0f;
-	rasterizerDesc.DepthClipEnable = true;
-	rasterizerDesc.ScissorEnable = false;
-	rasterizerDesc.MultisampleEnable = false;
-	rasterizerDesc.AntialiasedLineEnable = true;
-
-	hr = m_device->CreateRasterizerState( &rasterizerDesc, &m_rasterizerStates[(int)RasterizerMode::SOLID_CULL_NONE] );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create RasterizerMode::SOLID_CULL_BACK" );
-	}
-
-	rasterizerDesc = {};
-	rasterizerDesc.FillMode = D3D11_FILL_SOLID;
-	rasterizerDesc.CullMode = D3D11_CULL_BACK;
-	rasterizerDesc.FrontCounterClockwise = true;
-	rasterizerDesc.DepthBias = 0;
-	rasterizerDesc.DepthBiasClamp = 0;
-	rasterizerDesc.SlopeScaledDepthBias = 0.0f;
-	rasterizerDesc.DepthClipEnable = true;
-	rasterizerDesc.ScissorEnable = false;
-	rasterizerDesc.MultisampleEnable = false;
-	rasterizerDesc.AntialiasedLineEnable = true;
-
-	hr = m_device->CreateRasterizerState( &rasterizerDesc, &m_rasterizerStates[(int)RasterizerMode::SOLID_CULL_BACK] );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create RasterizerMode::SOLID_CULL_BACK" );
-	}
-
-	rasterizerDesc = {};
-	rasterizerDesc.FillMode = D3D11_FILL_SOLID;
-	rasterizerDesc.CullMode = D3D11_CULL_FRONT;
-	rasterizerDesc.FrontCounterClockwise = true;
-	rasterizerDesc.DepthBias = 0;
-	rasterizerDesc.DepthBiasClamp = 0;
-	rasterizerDesc.SlopeScaledDepthBias = 0.0f;
-	rasterizerDesc.DepthClipEnable = true;
-	rasterizerDesc.ScissorEnable = false;
-	rasterizerDesc.MultisampleEnable = false;
-	rasterizerDesc.AntialiasedLineEnable = true;
-	hr = m_device->CreateRasterizerState( &rasterizerDesc, &m_rasterizerStates[(int)RasterizerMode::SOLID_CULL_FRONT] );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create rasterizer state." );
-	}
-
-	rasterizerDesc = {};
-	rasterizerDesc.FillMode = D3D11_FILL_WIREFRAME;
-	rasterizerDesc.CullMode = D3D11_CULL_NONE;
-	rasterizerDesc.FrontCounterClockwise = true;
-	rasterizerDesc.DepthBias = 0;
-	rasterizerDesc.DepthBiasClamp = 0;
-	rasterizerDesc.SlopeScaledDepthBias = 0.0f;
-	rasterizerDesc.DepthClipEnable = true;
-	rasterizerDesc.ScissorEnable = false;
-	rasterizerDesc.MultisampleEnable = false;
-	rasterizerDesc.AntialiasedLineEnable = true;
-
-	hr = m_device->CreateRasterizerState( &rasterizerDesc, &m_rasterizerStates[(int)RasterizerMode::WIREFRAME_CULL_NONE] );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create RasterizerMode::WIREFRAME_CULL_NONE" );
-	}
-
-	rasterizerDesc = {};
-	rasterizerDesc.FillMode = D3D11_FILL_WIREFRAME;
-	rasterizerDesc.CullMode = D3D11_CULL_BACK;
-	rasterizerDesc.FrontCounterClockwise = true;
-	rasterizerDesc.DepthBias = 0;
-	rasterizerDesc.DepthBiasClamp = 0;
-	rasterizerDesc.SlopeScaledDepthBias = 0.0f;
-	rasterizerDesc.DepthClipEnable = true;
-	rasterizerDesc.ScissorEnable = false;
-	rasterizerDesc.MultisampleEnable = false;
-	rasterizerDesc.AntialiasedLineEnable = true;
-
-	hr = m_device->CreateRasterizerState( &rasterizerDesc, &m_rasterizerStates[(int)RasterizerMode::WIREFRAME_CULL_BACK] );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create RasterizerMode::WIREFRAME_CULL_BACK" );
-	}
-
-	m_deviceContext->RSSetState( m_rasterizerStates[(int)RasterizerMode::SOLID_CULL_NONE] );
+	m_immediateRingVBO = CreateVertexBuffer( k_immediateRingVertexBytes );
+	m_immediateRingIBO = CreateIndexBuffer( k_immediateRingIndexBytes );
 
 	m_lightingCBO = CreateConstantBuffer( sizeof( LightingConstants ) );
 	m_cameraCBO = CreateConstantBuffer( sizeof( CameraConstants ) );
 	m_modelCBO = CreateConstantBuffer( sizeof( ModelConstants ) );
 	m_blurCBO = CreateConstantBuffer( sizeof( BlurConstants ) );
 	m_jointCBO = CreateConstantBuffer( sizeof( JointConstants ) );
-
-	// Create Opaque Blend State
-	D3D11_BLEND_DESC blendDesc = { };
-	blendDesc.RenderTarget[0].BlendEnable = TRUE;
-	blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
-	blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_ZERO;
-	blendDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
-	blendDesc.RenderTarget[0].SrcBlendAlpha = blendDesc.RenderTarget[0].SrcBlend;
-	blendDesc.RenderTarget[0].DestBlendAlpha = blendDesc.RenderTarget[0].DestBlend;
-	blendDesc.RenderTarget[0].BlendOpAlpha = blendDesc.RenderTarget[0].BlendOp;
-	blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
-	
-	hr = m_device->CreateBlendState( &blendDesc, &m_blendStates[(int)(BlendMode::OPAQUE)] );
-	if (!SUCCEEDED( hr ))
+	// a buffer this large needs the 11.1 runtime, backends without offset binding use the per slot buffers instead
+	if (m_backend->SupportsConstantBufferOffsets())
 	{
-		ERROR_AND_DIE( "Could not create BlendMode::Opaque" );
-	}
-
-	// Create Alpha Blend State
-	blendDesc = { };
-	blendDesc.RenderTarget[0].BlendEnable = TRUE;
-	blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
-	blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
-	blendDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
-	blendDesc.RenderTarget[0].SrcBlendAlpha = blendDesc.RenderTarget[0].SrcBlend;
-	blendDesc.RenderTarget[0].DestBlendAlpha = blendDesc.RenderTarget[0].DestBlend;
-	blendDesc.RenderTarget[0].BlendOpAlpha = blendDesc.RenderTarget[0].BlendOp;
-	blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
-
-	hr = m_device->CreateBlendState( &blendDesc, &m_blendStates[(int)(BlendMode::ALPHA)] );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create BlendMode::Alpha" );
+		m_constantRingCBO = CreateConstantBuffer( k_constantRingBytes );
 	}
 
-	// Create Additive Blend State
-	blendDesc = { };
-	blendDesc.RenderTarget[0].BlendEnable = TRUE;
-	blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
-	blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
-	blendDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
-	blendDesc.RenderTarget[0].SrcBlendAlpha = blendDesc.RenderTarget[0].SrcBlend;
-	blendDesc.RenderTarget[0].DestBlendAlpha = blendDesc.RenderTarget[0].DestBlend;
-	blendDesc.RenderTarget[0].BlendOpAlpha = blendDesc.RenderTarget[0].BlendOp;
-	blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
-
-	hr = m_device->CreateBlendState( &blendDesc, &m_blendStates[(int)(BlendMode::ADDITIVE)] );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create BlendMode::Additive" );
-	}
 	Image defaultImage = Image( IntVec2( 2, 2 ), Rgba8::WHITE );
 	m_defaultTexture = CreateTextureFromImage( defaultImage, "Default" );
-	m_loadedTextures.push_back( m_defaultTexture );
+	AddLoadedTexture( m_defaultTexture );
 	BindTexture( m_defaultTexture );
 
-	D3D11_SAMPLER_DESC samplerDesc = {};
-	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_POINT;
-	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
-	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
-	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
-	samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
-	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
-	hr = m_device->CreateSamplerState( &samplerDesc, &m_samplerStates[(int)(SamplerMode::POINT_CLAMP)] );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create SamplerMode:Point_Clamp" );
-	}
-
-	samplerDesc = {};
-	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
-	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
-	hr = m_device->CreateSamplerState( &samplerDesc, &m_samplerStates[(int)(SamplerMode::BILINEAR_WARP)] );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create SamplerMode:BILINEAR_WARP" );
-	}
-
-	samplerDesc = {};
-	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
-	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
-	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
-	hr = m_device->CreateSamplerState( &samplerDesc, &m_samplerStates[(int)(SamplerMode::BILINEAR_CLAMP)] );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create SamplerMode:BILINEAR_CLAMP" );
-	}
-
 	SetSamplerMode( SamplerMode::POINT_CLAMP );
-	m_deviceContext->PSSetSamplers( 0, 1, &m_samplerState );
-
-	D3D11_TEXTURE2D_DESC textureDesc = {};
-	textureDesc.Width = m_config.m_window->GetClientDimensions().x;
-	textureDesc.Height = m_config.m_window->GetClientDimensions().y;
-	textureDesc.MipLevels = 1;
-	textureDesc.ArraySize = 1;
-	textureDesc.Usage = D3D11_USAGE_DEFAULT;
-	textureDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
-	textureDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
-	textureDesc.SampleDesc.Count = 1;
-	hr = m_device->CreateTexture2D( &textureDesc, nullptr, &m_depthStencilTexture );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create texture for depth stencil" );
-	}
-	hr = m_device->CreateDepthStencilView( m_depthStencilTexture, nullptr, &m_depthStencilView );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create depth stencil view" );
-	}
+	SetRasterizerState( RasterizerMode::SOLID_CULL_NONE );
+	SetDepthMode( DepthMode::ENABLED );
+	SetStateIfChanged();
 
-	D3D11_DEPTH_STENCIL_DESC depthStencilDesc = {};
-	depthStencilDesc.DepthEnable = TRUE;
-	depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
-	depthStencilDesc.DepthFunc = D3D11_COMPARISON_ALWAYS;
-	hr = m_device->CreateDepthStencilState( &depthStencilDesc, &m_depthStencilStates[(int)DepthMode::DISABLED] );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create depth stencil state for DepthMode:DISABLED" );
-	}
+	m_fullScreenQuadVBO_PCU = CreateVertexBuffer( sizeof( Vertex_PCU ) * 6 );
 
-	depthStencilDesc = {};
-	depthStencilDesc.DepthEnable = TRUE;
-	depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
-	depthStencilDesc.DepthFunc = D3D11_COMPARISON_LESS_EQUAL;
-	hr = m_device->CreateDepthStencilState( &depthStencilDesc, &m_depthStencilStates[(int)DepthMode::ENABLED] );
-	if (!SUCCEEDED( hr ))
+	IntVec2 dimensions = GetRenderDimensions();
+	float aspect = (float)dimensions.x / (float)dimensions.y;
+#if defined( _WIN32 )
+	if (m_config.m_window)
 	{
-		ERROR_AND_DIE( "Could not create depth stencil state for DepthMode:ENABLED" );
+		aspect = m_config.m_window->GetAspect();
 	}
+#endif
 
-	SetDepthMode( DepthMode::ENABLED );
-	m_deviceContext->OMSetDepthStencilState( m_depthStencilState, 0 );
-
-	m_fullScreenQuadVBO_PCU = CreateVertexBuffer( sizeof( Vertex_PCU ) * 6 );
-
-	m_emissiveRenderTexture = CreateRenderTexture( m_config.m_window->GetClientDimensions(), "EmissiveTexture" );
+	m_emissiveRenderTexture = CreateRenderTexture( dimensions, "EmissiveTexture" );
 	
 	m_emissiveBlurDownTexture.resize( k_blurDownTextureCount, nullptr );
 	m_emissiveBlurUpTexture.resize( k_blurUpTextureCount, nullptr );
 
-	int currentHeight = m_config.m_window->GetClientDimensions().y;
+	int currentHeight = dimensions.y;
 	int currentWidth;
 
 	for (int i = 0; i < k_blurDownTextureCount; i++)
 	{
 		currentHeight = int( float( currentHeight ) * 0.5f );
-		currentWidth = int( float( currentHeight * m_config.m_window->GetAspect() + 0.5f ) );
+		currentWidth = int( float( currentHeight * aspect + 0.5f ) );
 
 		IntVec2 newDimension = IntVec2( int( currentWidth ), int( currentHeight ) );
 		m_emissiveBlurDownTexture[i] = CreateRenderTexture( newDimension, "EmissiveBlurDownTexture" );
 	}
-	currentHeight = m_config.m_window->GetClientDimensions().y;
+	currentHeight = dimensions.y;
 	for (int i = 0; i < k_blurUpTextureCount; i++)
 	{
 		currentHeight = int( float( currentHeight ) * 0.5f );
-		currentWidth = int( float( currentHeight * m_config.m_window->GetAspect() ) + 0.5f );
+		currentWidth = int( float( currentHeight * aspect ) + 0.5f );
 		IntVec2 newDimension = IntVec2( int( currentWidth ), int( currentHeight ) );
 		m_emissiveBlurUpTexture[i] = CreateRenderTexture( newDimension, "EmissiveBlurUpTexture" );
 	}
 }
 
+RendererStats const& Renderer::GetStats() const
+{
+	return m_backend->GetStats();
+}
+
+IntVec2 Renderer::GetRenderDimensions() const
+{
+#if defined( _WIN32 )
+	if (m_config.m_window)
+	{
+		return m_config.m_window->GetClientDimensions();
+	}
+#endif
+	return m_config.m_headlessDimensions;
+}
+
 void Renderer::BeginFrame()
 {
-	// Set Render Target
-	//m_deviceContext->OMSetRenderTargets( 1, &m_renderTargetView, m_depthStencilView );
+	m_backend->ResetStats();
+
+	UploadStreamedTextures( m_config.m_maxTextureUploadsPerFrame );
 
-	ID3D11RenderTargetView* RTVs[]
+	m_hasConstantRingWrites = false;
+	m_constantRingOffset = 0;
+	SetCameraConstants( m_lastProjectionMatrix, m_lastViewMatrix );
+	SetModelConstants( m_lastModelMatrix, m_lastModelColor );
+
+	// Set Render Target
+	Texture* renderTargets[] =
 	{
-		m_renderTargetView,
-		m_emissiveRenderTexture->m_renderTargetView
+		nullptr,
+		m_emissiveRenderTexture
 	};
-	m_deviceContext->OMSetRenderTargets( 2, RTVs, m_depthStencilView );
+	m_backend->SetRenderTargets( renderTargets, 2, true );
 }
 
 void Renderer::EndFrame()
 {
 	// Present
-	HRESULT hr;
-	hr = m_swapChain->Present( 0, 0 );
-	if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET)
-	{
-		ERROR_AND_DIE( "Device has been lost, application will now terminate" );
-	}
+	m_backend->Present();
 } 
 
 void Renderer::Shutdown()
 {
+	// streaming jobs still point at their textures
+	if (g_jobSystem)
+	{
+		g_jobSystem->WaitForCounter( *m_textureStreamingCounter );
+	}
+	for (StreamedTexture& streamedTexture : m_streamedTextures)
+	{
+		delete streamedTexture.m_image;
+		if (streamedTexture.m_texture->m_isPendingDelete)
+		{
+			delete streamedTexture.m_texture;
+		}
+	}
+	m_streamedTextures.clear();
+	m_streamingTextureCount = 0;
+	delete m_textureStreamingCounter;
+	m_textureStreamingCounter = nullptr;
+
 	for (Shader* loadedShader : m_loadedShaders)
 	{
 		delete loadedShader;
 		loadedShader = nullptr;
 	}
+	m_loadedShaders.clear();
+	m_shadersByName.clear();
 
 	for (int i = 0; i < k_blurDownTextureCount; i++)
 	{
@@ -468,6 +254,12 @@ void Renderer::Shutdown()
 	delete m_immediateIBO;
 	m_immediateIBO = nullptr;
 
+	delete m_immediateRingVBO;
+	m_immediateRingVBO = nullptr;
+
+	delete m_immediateRingIBO;
+	m_immediateRingIBO = nullptr;
+
 	delete m_fullScreenQuadVBO_PCU;
 
 	delete m_blurCBO;
@@ -485,126 +277,161 @@ void Renderer::Shutdown()
 	delete m_jointCBO;
 	m_jointCBO = nullptr;
 
-	for (ID3D11BlendState* blendMode : m_blendStates)
-	{
-		DX_SAFE_RELEASE( blendMode );
-	}
-
-	for (ID3D11SamplerState* samplerState : m_samplerStates)
-	{
-		DX_SAFE_RELEASE( samplerState );
-	}
-
-	for (ID3D11RasterizerState* rasterizerState : m_rasterizerStates)
-	{
-		DX_SAFE_RELEASE( rasterizerState );
-	}
+	delete m_constantRingCBO;
+	m_constantRingCBO = nullptr;
 
 	for (Texture* loadedTexture : m_loadedTextures)
 	{
 		delete loadedTexture;
 		loadedTexture = nullptr;
 	}
+	m_loadedTextures.clear();
+	m_texturesByPath.clear();
 
-	for (ID3D11DepthStencilState* depthStencilState : m_depthStencilStates)
-	{
-		DX_SAFE_RELEASE( depthStencilState );
-	}
-
-	DX_SAFE_RELEASE( m_depthStencilView );
-	DX_SAFE_RELEASE( m_depthStencilTexture );
-
-	DX_SAFE_RELEASE( m_renderTargetView );
-	DX_SAFE_RELEASE( m_swapChain );
-	DX_SAFE_RELEASE( m_deviceContext );
-	DX_SAFE_RELEASE( m_device );
-
-	// Report error leaks and release debug module
-#if defined(ENGINE_DEBUG_RENDER)
-	((IDXGIDebug*)m_dxgiDebug)->ReportLiveObjects(
-		DXGI_DEBUG_ALL,
-		(DXGI_DEBUG_RLO_FLAGS)(DXGI_DEBUG_RLO_DETAIL | DXGI_DEBUG_RLO_IGNORE_INTERNAL)
-	);
-
-	((IDXGIDebug*)m_dxgiDebug)->Release();
-	m_dxgiDebug = nullptr;
+	delete m_shaderCache;
+	m_shaderCache = nullptr;
 
-	::FreeLibrary( (HMODULE)m_dxgiDebugModule );
-	m_dxgiDebugModule = nullptr;
-#endif
+	m_backend->Shutdown();
+	delete m_backend;
+	m_backend = nullptr;
 } 
 
 void Renderer::DrawVertexArray( int numVertexes, Vertex_PCU const* vertexArray )
 {
-	CopyCPUToGPU( vertexArray, numVertexes, m_immediateVBO );
-	DrawVertexBuffer( m_immediateVBO, numVertexes, 0 );
+	DrawImmediateRing( numVertexes, vertexArray, VertexType::VERTEX_PCU, 0, nullptr );
+}
+
+void Renderer::DrawVertexArray( int numVertexes, Vertex_PCU const* vertexArray, int numIndexes, unsigned int const* indexArray )
+{
+	DrawImmediateRing( numVertexes, vertexArray, VertexType::VERTEX_PCU, numIndexes, indexArray );
+}
+
+void Renderer::DrawVertexArray( int numVertexes, Vertex_PCUTBN const* vertexArray, int numIndexes, unsigned int const* indexArray )
+{
+	DrawImmediateRing( numVertexes, vertexArray, VertexType::VERTEX_PCUTBN, numIndexes, indexArray );
 }
 
-void Renderer::DrawVertexArray( std::vector<Vertex_PCU> const vertexArray )
+void Renderer::DrawVertexArray( std::vector<Vertex_PCU> const& vertexArray )
 {
-	CopyCPUToGPU( vertexArray.data(), vertexArray.size(), m_immediateVBO );
-	DrawVertexBuffer( m_immediateVBO, (int)(vertexArray.size()), (int)VertexType::VERTEX_PCU );
+	DrawVertexArray( (int)vertexArray.size(), vertexArray.data() );
 }
 
-void Renderer::DrawVertexArray( std::vector<Vertex_PCU> const vertexArray, std::vector<unsigned int> const IndexArray )
+void Renderer::DrawVertexArray( std::vector<Vertex_PCU> const& vertexArray, std::vector<unsigned int> const& indexArray )
 {
-	CopyCPUToGPU( vertexArray.data(), vertexArray.size(), m_immediateVBO );
-	CopyCPUToGPU( IndexArray.data(), IndexArray.size(), m_immediateIBO );
-	DrawVertexAndIndexBuffer( m_immediateVBO, m_immediateIBO, (int)IndexArray.size(), VertexType::VERTEX_PCU );
+	DrawVertexArray( (int)vertexArray.size(), vertexArray.data(), (int)indexArray.size(), indexArray.data() );
 }
 
-void Renderer::DrawVertexArray( VertexBuffer* vertexBuffer, IndexBuffer* indexBuffer, std::vector<Vertex_PCU> const vertexArray, std::vector<unsigned int> const indexArray )
+void Renderer::DrawVertexArray( VertexBuffer* vertexBuffer, IndexBuffer* indexBuffer, std::vector<Vertex_PCU> const& vertexArray, std::vector<unsigned int> const& indexArray )
 {
 	CopyCPUToGPU( vertexArray.data(), vertexArray.size(), vertexBuffer );
 	CopyCPUToGPU( indexArray.data(), indexArray.size(), indexBuffer );
 	DrawVertexAndIndexBuffer( vertexBuffer, indexBuffer, (int)(indexArray.size()), VertexType::VERTEX_PCU );
 }
 
-void Renderer::DrawVertexArray( std::vector<Vertex_PCUTBN> const vertexArray, std::vector<unsigned int> const indexArray )
+void Renderer::DrawVertexArray( std::vector<Vertex_PCUTBN> const& vertexArray, std::vector<unsigned int> const& indexArray )
 {
-	CopyCPUToGPU( vertexArray.data(), vertexArray.size(), m_immediateVBO, indexArray.data(), indexArray.size(), m_immediateIBO );
-	DrawVertexAndIndexBuffer( m_immediateVBO, m_immediateIBO, (int)(indexArray.size()), VertexType::VERTEX_PCUTBN );
+	DrawVertexArray( (int)vertexArray.size(), vertexArray.data(), (int)indexArray.size(), indexArray.data() );
 }
 
-void Renderer::DrawVertexArray( VertexBuffer* vertexBuffer, IndexBuffer* indexBuffer, std::vector<Vertex_PCUTBN> const vertexArray, std::vector<unsigned int> const indexArray )
+void Renderer::DrawVertexArray( VertexBuffer* vertexBuffer, IndexBuffer* indexBuffer, std::vector<Vertex_PCUTBN> const& vertexArray, std::vector<unsigned int> const& indexArray )
 {
 	CopyCPUToGPU( vertexArray.data(), vertexArray.size(), vertexBuffer, indexArray.data(), indexArray.size(), indexBuffer );
 	DrawVertexAndIndexBuffer( vertexBuffer, indexBuffer, (int)(indexArray.size()), VertexType::VERTEX_PCUTBN );
 }
 
+bool Renderer::WriteToImmediateRing( RenderBuffer* ring, size_t ringSize, size_t& ringOffset, void const* data, size_t byteSize, size_t stride, size_t& out_offset )
+{
+	if (byteSize > ringSize)
+		return false;
+
+	// vertex strides are not powers of two, draws address the ring in whole elements
+	size_t offset = ((ringOffset + stride - 1) / stride) * stride;
+	bool discard = false;
+	if (offset + byteSize > ringSize)
+	{
+		offset = 0;
+		discard = true;
+	}
+
+	m_backend->WriteToBuffer( ring, offset, data, byteSize, discard );
+	ringOffset = offset + byteSize;
+	out_offset = offset;
+	return true;
+}
+
+void Renderer::DrawImmediateRing( int numVertexes, void const* vertexArray, VertexType vertexType, int numIndexes, unsigned int const* indexArray )
+{
+	if (numVertexes <= 0)
+		return;
+
+	size_t stride = (vertexType == VertexType::VERTEX_PCU) ? sizeof( Vertex_PCU ) : sizeof( Vertex_PCUTBN );
+	size_t vertexOffset = 0;
+	bool isVertexInRing = WriteToImmediateRing( m_immediateRingVBO->m_buffer, k_immediateRingVertexBytes, m_immediateRingVertexOffset,
+		vertexArray, numVertexes * stride, stride, vertexOffset );
+
+	if (indexArray == nullptr)
+	{
+		if (isVertexInRing)
+		{
+			DrawVertexBuffer( m_immediateRingVBO, numVertexes, (int)(vertexOffset / stride) );
+		}
+		else
+		{
+			CopyCPUToGPU( vertexArray, numVertexes, m_immediateVBO );
+			DrawVertexBuffer( m_immediateVBO, numVertexes, 0 );
+		}
+		return;
+	}
+
+	size_t indexOffset = 0;
+	bool isIndexInRing = isVertexInRing && WriteToImmediateRing( m_immediateRingIBO->m_buffer, k_immediateRingIndexBytes, m_immediateRingIndexOffset,
+		indexArray, numIndexes * sizeof( unsigned int ), sizeof( unsigned int ), indexOffset );
+
+	if (isIndexInRing)
+	{
+		BindVertexBuffer( m_immediateRingVBO, vertexType );
+		BindIndexBuffer( m_immediateRingIBO );
+		SetStateIfChanged();
+		m_backend->DrawIndexed( numIndexes, (int)(indexOffset / sizeof( unsigned int )), (int)(vertexOffset / stride) );
+	}
+	else if (vertexType == VertexType::VERTEX_PCU)
+	{
+		CopyCPUToGPU( vertexArray, numVertexes, m_immediateVBO );
+		CopyCPUToGPU( indexArray, numIndexes, m_immediateIBO );
+		DrawVertexAndIndexBuffer( m_immediateVBO, m_immediateIBO, numIndexes, VertexType::VERTEX_PCU );
+	}
+	else
+	{
+		CopyCPUToGPU( vertexArray, numVertexes, m_immediateVBO, indexArray, numIndexes, m_immediateIBO );
+		DrawVertexAndIndexBuffer( m_immediateVBO, m_immediateIBO, numIndexes, VertexType::VERTEX_PCUTBN );
+	}
+}
+
 void Renderer::ClearScreen( Rgba8 const& defaultColor )
 {
 	// Clear the screen
-	float colorAsFloats[4];
-	defaultColor.GetAsFloats( colorAsFloats );
- 	m_deviceContext->ClearRenderTargetView( m_renderTargetView, colorAsFloats );
-// 	m_deviceContext->ClearDepthStencilView( m_depthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0 );
+	m_backend->ClearRenderTarget( nullptr, defaultColor );
 
-	float blackAsFloats[4] = { 0.f, 0.f, 0.f, 1.f };
-	m_deviceContext->ClearRenderTargetView( m_emissiveRenderTexture->m_renderTargetView, blackAsFloats );
+	Rgba8 black = Rgba8( 0, 0, 0, 255 );
+	m_backend->ClearRenderTarget( m_emissiveRenderTexture, black );
 	for (int i = 0; i < m_emissiveBlurDownTexture.size(); i++)
 	{
-		m_deviceContext->ClearRenderTargetView( m_emissiveBlurDownTexture[i]->m_renderTargetView, blackAsFloats);
+		m_backend->ClearRenderTarget( m_emissiveBlurDownTexture[i], black );
 	}
 	for (int i = 0; i < m_emissiveBlurUpTexture.size(); i++)
 	{
-		m_deviceContext->ClearRenderTargetView( m_emissiveBlurUpTexture[i]->m_renderTargetView, blackAsFloats );
+		m_backend->ClearRenderTarget( m_emissiveBlurUpTexture[i], black );
 	}
-	m_deviceContext->ClearDepthStencilView( m_depthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0 );
+	m_backend->ClearDepth();
 }
 
 void Renderer::BeginCamera( Camera const& camera )
 {
 	// Set Viewport
-	D3D11_VIEWPORT viewport = { 0 };
+	IntVec2 dimensions = GetRenderDimensions();
 	if (camera.GetViewport().m_mins == Vec2::ZERO && camera.GetViewport().m_maxs == Vec2::ZERO)
 	{
-		viewport.TopLeftX = 0.0f;
-		viewport.TopLeftY = 0.0f;
-		viewport.Width = (float)m_config.m_window->GetClientDimensions().x;
-		viewport.Height = (float)m_config.m_window->GetClientDimensions().y;
-		viewport.MinDepth = 0.0f;
-		viewport.MaxDepth = 1.0f;
+		m_backend->SetViewport( 0.f, 0.f, (float)dimensions.x, (float)dimensions.y );
 	}
 	else
 	{
@@ -612,16 +439,9 @@ void Renderer::BeginCamera( Camera const& camera )
 		float WminsY = 1.f - camera.GetViewport().m_maxs.y;
 		float WmaxsX = camera.GetViewport().m_maxs.x;
 		float WmaxsY = 1.f - camera.GetViewport().m_mins.y;
-		viewport.TopLeftX = (float)m_config.m_window->GetClientDimensions().x * WminsX;
-		viewport.TopLeftY = (float)m_config.m_window->GetClientDimensions().y * WminsY;
-		viewport.Width = (float)m_config.m_window->GetClientDimensions().x * (WmaxsX - WminsX);
-		viewport.Height = (float)m_config.m_window->GetClientDimensions().y * (WmaxsY - WminsY);
-		viewport.MinDepth = 0.0f;
-		viewport.MaxDepth = 1.0f;
+		m_backend->SetViewport( (float)dimensions.x * WminsX, (float)dimensions.y * WminsY,
+			(float)dimensions.x * (WmaxsX - WminsX), (float)dimensions.y * (WmaxsY - WminsY) );
 	}
-	
-
-	m_deviceContext->RSSetViewports( 1, &viewport );
 
 	SetCameraConstants( camera.GetProjectionMatrix(), camera.GetViewMatrix() );
 }
@@ -633,165 +453,53 @@ void Renderer::EndCamera( Camera const& camera )
 
 Shader* Renderer::CreateShader( char const* shaderName, VertexType vertexType )
 {
-	std::string hlsl;
-	for (Shader* shader : m_loadedShaders)
+	auto found = m_shadersByName.find( shaderName );
+	if (found != m_shadersByName.end())
 	{
-		if (shader->GetName() == shaderName)
-		{
-			return shader;
-		}
+		return found->second;
 	}
+
+	std::string hlsl;
 	FileReadToString( hlsl, shaderName );
 	return CreateShader( shaderName, hlsl.c_str(), vertexType );
 }
 
- Shader* Renderer::CreateShader( char const* shaderName, char const* shaderSource, VertexType vertexType )
- {
- 	std::string str = shaderSource;
- 	ShaderConfig newShaderConfig;
- 	newShaderConfig.m_name = shaderName;
- 	Shader* newShader = new Shader( newShaderConfig );
- 
- 	// Create vertex shader
- 	std::vector<unsigned char> vertexShaderByteCode;
- 	CompileShaderToByteCode( vertexShaderByteCode, "VertexShader", shaderSource, newShaderConfig.m_vertexEntryPoint.c_str(), "vs_5_0" );
- 	HRESULT hr = m_device->CreateVertexShader(
- 		vertexShaderByteCode.data(),
- 		vertexShaderByteCode.size(),
- 		NULL, &newShader->m_vertexShader
- 	);
- 	if (!SUCCEEDED( hr ))
- 	{
- 		ERROR_AND_DIE( Stringf( "Could not create vertex shader." ) );
- 	}
- 
- 	// Create vertex shader
- 	std::vector<unsigned char> pixelShaderByteCode;
- 	CompileShaderToByteCode( pixelShaderByteCode, "PixelShader", shaderSource, newShaderConfig.m_pixelEntryPoint.c_str(), "ps_5_0" );
- 	hr = m_device->CreatePixelShader(
- 		pixelShaderByteCode.data(),
- 		pixelShaderByteCode.size(),
- 		NULL, &newShader->m_pixelShader
- 	);
- 	if (!SUCCEEDED( hr ))
- 	{
- 		ERROR_AND_DIE( Stringf( "Could not create pixel shader." ) );
- 	}
- 
- 	if (vertexType == VertexType::VERTEX_PCU)
- 	{
- 
- 		D3D11_INPUT_ELEMENT_DESC inputElementDesc[] = {
- 			{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
- 			{"COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
- 			{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0}
- 		};
- 
- 		UINT numElements = ARRAYSIZE( inputElementDesc );
- 		hr = m_device->CreateInputLayout(
- 			inputElementDesc, numElements,
- 			vertexShaderByteCode.data(),
- 			vertexShaderByteCode.size(),
- 			&newShader->m_inputLayoutForVertex
- 		);
- 		if (!SUCCEEDED( hr ))
- 		{
- 			ERROR_AND_DIE( "Could not create vertex layout" );
- 		}
- 	}
- 	else if (vertexType == VertexType::VERTEX_PCUTBN)
- 	{
- 		D3D11_INPUT_ELEMENT_DESC inputElementDesc[] = {
- 			{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
- 			{"COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
- 			{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
- 			{"TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
- 			{"BITANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
- 			{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0}
- 		};
- 
- 		UINT numElements = ARRAYSIZE( inputElementDesc );
- 		hr = m_device->CreateInputLayout(
- 			inputElementDesc, numElements,
- 			vertexShaderByteCode.data(),
- 			vertexShaderByteCode.size(),
- 			&newShader->m_inputLayoutForVertex
- 		);
- 		if (!SUCCEEDED( hr ))
- 		{
- 			ERROR_AND_DIE( "Could not create vertex layout" );
- 		}
- 	}
-	else
-	{
-		D3D11_INPUT_ELEMENT_DESC inputElementDesc[] = {
-			{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
-			{"COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-			{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-			{"TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-			{"BITANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-			{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-			{"JOINTINDEX", 0, DXGI_FORMAT_R32G32B32A32_UINT, 1, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
-			{"JOINTWEIGHT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0}
-		};
-
-		UINT numElements = ARRAYSIZE( inputElementDesc );
-		hr = m_device->CreateInputLayout(
-			inputElementDesc, numElements,
-			vertexShaderByteCode.data(),
-			vertexShaderByteCode.size(),
-			&newShader->m_inputLayoutForVertex
-		);
-		if (!SUCCEEDED( hr ))
-		{
-			ERROR_AND_DIE( "Could not create vertex layout" );
-		}
-	}
-	m_loadedShaders.push_back( newShader );
- 	m_currentShader = newShader;
- 	return newShader;
- }
+Shader* Renderer::CreateShader( char const* shaderName, char const* shaderSource, VertexType vertexType )
+{
+	ShaderConfig newShaderConfig;
+	newShaderConfig.m_name = shaderName;
+	Shader* newShader = new Shader( newShaderConfig );
+
+	std::vector<unsigned char> vertexShaderByteCode;
+	CompileShaderToByteCodeCached( vertexShaderByteCode, shaderName, "VertexShader", shaderSource, newShaderConfig.m_vertexEntryPoint.c_str(), "vs_5_0" );
+	std::vector<unsigned char> pixelShaderByteCode;
+	CompileShaderToByteCodeCached( pixelShaderByteCode, shaderName, "PixelShader", shaderSource, newShaderConfig.m_pixelEntryPoint.c_str(), "ps_5_0" );
+	m_backend->CreateShader( newShader, vertexShaderByteCode, pixelShaderByteCode, vertexType );
+
+	AddLoadedShader( newShader );
+	m_currentShader = newShader;
+	return newShader;
+}
 
 void Renderer::CompileShaderToByteCode( std::vector<unsigned char>& outByteCode, char const* name, char const* source, char const* entryPoint, char const* target )
 {
-	DWORD shaderFlags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+	m_backend->CompileShaderToByteCode( outByteCode, name, source, entryPoint, target );
+}
+
+void Renderer::CompileShaderToByteCodeCached( std::vector<unsigned char>& outByteCode, char const* shaderName, char const* name, char const* source, char const* entryPoint, char const* target )
+{
+	// debug builds compile without optimization, their bytecode must not be shared with release
 #if defined(ENGINE_DEBUG_RENDER)
-	shaderFlags = D3DCOMPILE_DEBUG;
-	shaderFlags |= D3DCOMPILE_SKIP_OPTIMIZATION;
-	shaderFlags |= D3DCOMPILE_WARNINGS_ARE_ERRORS;
+	unsigned int compileFlags = 1;
+#else
+	unsigned int compileFlags = 0;
 #endif
-	ID3DBlob* shaderBlob = NULL;
-	ID3DBlob* errorBlob = NULL;
-
-	HRESULT hr = D3DCompile(
-		source, strlen( source ),
-		name, nullptr, nullptr,
-		entryPoint, target, shaderFlags, 0,
-		&shaderBlob, &errorBlob
-	);
-	if (SUCCEEDED( hr ))
-	{
-		outByteCode.resize( shaderBlob->GetBufferSize() );
-		memcpy(
-			outByteCode.data(),
-			shaderBlob->GetBufferPointer(),
-			shaderBlob->GetBufferSize()
-		);
-	}
-	else
-	{
-		if (errorBlob != NULL)
-		{
-			DebuggerPrintf( (char*)errorBlob->GetBufferPointer() );
-		}
-		ERROR_AND_DIE( Stringf( "Could not compile %s", name ) );
-	}
+	unsigned long long key = ComputeShaderCacheKey( source, entryPoint, target, nullptr, compileFlags );
+	if (m_shaderCache->Load( shaderName, entryPoint, target, key, outByteCode ))
+		return;
 
-	shaderBlob->Release();
-	if (errorBlob != NULL)
-	{
-		errorBlob->Release();
-	}
+	CompileShaderToByteCode( outByteCode, name, source, entryPoint, target );
+	m_shaderCache->Save( shaderName, entryPoint, target, key, outByteCode );
 }
 
 void Renderer::BindShader( Shader* shader )
@@ -802,41 +510,20 @@ void Renderer::BindShader( Shader* shader )
 		return;
 	}
 
-	bool flag = false;
-	for (Shader* loadedShader : m_loadedShaders)
-	{
-		if (loadedShader == shader)
-		{
-			flag = true;
-			break;
-		}
-	}
-	if (!flag)
+	// shaders created outside the renderer are adopted on first bind so Shutdown deletes them
+	if (!shader->m_isOwnedByRenderer)
 	{
-		m_loadedShaders.push_back( shader );
+		AddLoadedShader( shader );
 	}
 	m_currentShader = shader;
-	m_deviceContext->IASetInputLayout( m_currentShader->m_inputLayoutForVertex );
-	m_deviceContext->VSSetShader( m_currentShader->m_vertexShader, nullptr, 0 );
-	m_deviceContext->PSSetShader( m_currentShader->m_pixelShader, nullptr, 0 );
+	m_backend->BindShader( m_currentShader );
 }
 
 VertexBuffer* Renderer::CreateVertexBuffer( size_t const size )
 {
 	// Create vertex buffer
 	VertexBuffer* newVertexBuffer = new VertexBuffer( size );
-	D3D11_BUFFER_DESC bufferDesc = { 0 };
-	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	bufferDesc.ByteWidth = (UINT)size;
-	bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-
-	HRESULT hr = m_device->CreateBuffer( &bufferDesc, nullptr, &newVertexBuffer->m_buffer );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create vertex buffer" );
-	}
-
+	m_backend->CreateBuffer( newVertexBuffer->m_buffer, size, RenderBufferType::VERTEX );
 	return newVertexBuffer;
 }
 
@@ -844,18 +531,7 @@ IndexBuffer* Renderer::CreateIndexBuffer( size_t const size )
 {
 	// Create index buffer
 	IndexBuffer* newIndexBuffer = new IndexBuffer( size );
-	D3D11_BUFFER_DESC bufferDesc = { 0 };
-	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	bufferDesc.ByteWidth = (UINT)size;
-	bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-
-	HRESULT hr = m_device->CreateBuffer( &bufferDesc, nullptr, &newIndexBuffer->m_buffer );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create index buffer" );
-	}
-
+	m_backend->CreateBuffer( newIndexBuffer->m_buffer, size, RenderBufferType::INDEX );
 	return newIndexBuffer;
 }
 
@@ -870,10 +546,7 @@ void Renderer::CopyCPUToGPU( void const* data, size_t const size, VertexBuffer*&
 		vbo = CreateVertexBuffer( sizeByte );
 	}
 
-	D3D11_MAPPED_SUBRESOURCE resource;
-	m_deviceContext->Map( vbo->m_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource );
-	memcpy( resource.pData, data, sizeByte );
-	m_deviceContext->Unmap( vbo->m_buffer, 0 );
+	m_backend->CopyToBuffer( vbo->m_buffer, data, sizeByte );
 }
 
 void Renderer::CopyCPUToGPU( void const* data, size_t const size, IndexBuffer*& ibo )
@@ -886,10 +559,7 @@ void Renderer::CopyCPUToGPU( void const* data, size_t const size, IndexBuffer*&
 		ibo = CreateIndexBuffer( sizeByte );
 	}
 
-	D3D11_MAPPED_SUBRESOURCE resource;
-	m_deviceContext->Map( ibo->m_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource );
-	memcpy( resource.pData, data, sizeByte );
-	m_deviceContext->Unmap( ibo->m_buffer, 0 );
+	m_backend->CopyToBuffer( ibo->m_buffer, data, sizeByte );
 }
 
 void Renderer::CopyCPUToGPU( void const* dataV, size_t const sizeV, VertexBuffer*& vbo, void const* dataI, size_t const sizeI, IndexBuffer*& ibo )
@@ -902,10 +572,7 @@ void Renderer::CopyCPUToGPU( void const* dataV, size_t const sizeV, VertexBuffer
 		vbo = CreateVertexBuffer( sizeByteV );
 	}
 
-	D3D11_MAPPED_SUBRESOURCE resource;
-	m_deviceContext->Map( vbo->m_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource );
-	memcpy( resource.pData, dataV, sizeByteV );
-	m_deviceContext->Unmap( vbo->m_buffer, 0 );
+	m_backend->CopyToBuffer( vbo->m_buffer, dataV, sizeByteV );
 	
 	size_t sizeByteI = sizeI * sizeof( unsigned int );
 	if (sizeByteI > ibo->m_size)
@@ -914,10 +581,7 @@ void Renderer::CopyCPUToGPU( void const* dataV, size_t const sizeV, VertexBuffer
 		ibo = CreateIndexBuffer( sizeByteI );
 	}
 
-	//D3D11_MAPPED_SUBRESOURCE resource;
-	m_deviceContext->Map( ibo->m_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource );
-	memcpy( resource.pData, dataI, sizeByteI );
-	m_deviceContext->Unmap( ibo->m_buffer, 0 );
+	m_backend->CopyToBuffer( ibo->m_buffer, dataI, sizeByteI );
 }
 
 void Renderer::CopyCPUToGPU( void const* dataV, size_t const sizeV, VertexBuffer*& vbo,
@@ -932,10 +596,7 @@ void Renderer::CopyCPUToGPU( void const* dataV, size_t const sizeV, VertexBuffer
 		vbo = CreateVertexBuffer( sizeByteV );
 	}
 
-	D3D11_MAPPED_SUBRESOURCE resource;
-	m_deviceContext->Map( vbo->m_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource );
-	memcpy( resource.pData, dataV, sizeByteV );
-	m_deviceContext->Unmap( vbo->m_buffer, 0 );
+	m_backend->CopyToBuffer( vbo->m_buffer, dataV, sizeByteV );
 
 	// Copy second vertex buffer (joint influences)
 	size_t sizeByteV2 = sizeV2 * sizeof( Vertex_Anim );
@@ -945,9 +606,7 @@ void Renderer::CopyCPUToGPU( void const* dataV, size_t const sizeV, VertexBuffer
 		vbo2 = CreateVertexBuffer( sizeByteV2 );
 	}
 
-	m_deviceContext->Map( vbo2->m_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource );
-	memcpy( resource.pData, dataV2, sizeByteV2 );
-	m_deviceContext->Unmap( vbo2->m_buffer, 0 );
+	m_backend->CopyToBuffer( vbo2->m_buffer, dataV2, sizeByteV2 );
 
 	size_t sizeByteI = sizeI * sizeof( unsigned int );
 	if (sizeByteI > ibo->m_size)
@@ -956,15 +615,12 @@ void Renderer::CopyCPUToGPU( void const* dataV, size_t const sizeV, VertexBuffer
 		ibo = CreateIndexBuffer( sizeByteI );
 	}
 
-	//D3D11_MAPPED_SUBRESOURCE resource;
-	m_deviceContext->Map( ibo->m_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource );
-	memcpy( resource.pData, dataI, sizeByteI );
-	m_deviceContext->Unmap( ibo->m_buffer, 0 );
+	m_backend->CopyToBuffer( ibo->m_buffer, dataI, sizeByteI );
 }
 
 void Renderer::BindVertexBuffer( VertexBuffer* vbo, VertexType vertexType )
 {
-	UINT stride;
+	unsigned int stride;
 	if (vertexType == VertexType::VERTEX_PCU)
 	{
 		stride = sizeof( Vertex_PCU );
@@ -973,77 +629,46 @@ void Renderer::BindVertexBuffer( VertexBuffer* vbo, VertexType vertexType )
 	{
 		stride = sizeof( Vertex_PCUTBN );
 	}
-	UINT startOffset = 0;
-	m_deviceContext->IASetVertexBuffers( 0, 1, &vbo->m_buffer, &stride, &startOffset );
-	if (vbo->m_isLinePrimitive)
-	{
-		m_deviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_LINELIST );
-	}
-	else
-	{
-		m_deviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
-	}
+	m_backend->BindVertexBuffer( 0, vbo->m_buffer, stride, 0 );
+	m_backend->SetPrimitiveTopology( vbo->m_isLinePrimitive );
 }
 
 void Renderer::BindVertexBuffer( VertexBuffer* vbo, VertexBuffer* vbo2 )
 {
-//	ID3D11Buffer* buffers[2] = { vbo->m_buffer, vbo2->m_buffer };
-// 
- 	UINT strides[2] = { sizeof( Vertex_PCUTBN ), sizeof( Vertex_Anim ) };
-// 
- 	UINT startOffsets[2] = { 0, 0 };
-// 
-// 	m_deviceContext->IASetVertexBuffers( 0, 2, buffers, strides, startOffsets );
-
-	m_deviceContext->IASetVertexBuffers( 0, 1, &vbo->m_buffer, &strides[0], &startOffsets[0] );
-	m_deviceContext->IASetVertexBuffers( 1, 1, &vbo2->m_buffer, &strides[1], &startOffsets[1] );
+	m_backend->BindVertexBuffer( 0, vbo->m_buffer, sizeof( Vertex_PCUTBN ), 0 );
+	m_backend->BindVertexBuffer( 1, vbo2->m_buffer, sizeof( Vertex_Anim ), 0 );
 }
 
 void Renderer::BindIndexBuffer( IndexBuffer* ibo )
 {
-	m_deviceContext->IASetIndexBuffer( ibo->m_buffer, DXGI_FORMAT_R32_UINT, 0 );
-	m_deviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+	m_backend->BindIndexBuffer( ibo->m_buffer );
+	m_backend->SetPrimitiveTopology( false );
 }
 
 ConstantBuffer* Renderer::CreateConstantBuffer( size_t const size )
 {
-	// Create vertex buffer
-	ConstantBuffer* newVertexBuffer = new ConstantBuffer( size );
-	D3D11_BUFFER_DESC bufferDesc = {};
-	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	bufferDesc.ByteWidth = (UINT)size;
-	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-
-	HRESULT hr = m_device->CreateBuffer( &bufferDesc, nullptr, &newVertexBuffer->m_buffer );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create constant buffer" );
-	}
-
-	return newVertexBuffer;
+	// Create constant buffer
+	ConstantBuffer* newConstantBuffer = new ConstantBuffer( size );
+	m_backend->CreateBuffer( newConstantBuffer->m_buffer, size, RenderBufferType::CONSTANT );
+	return newConstantBuffer;
 }
 
 void Renderer::CopyCPUToGPU( void const* data, size_t const size, ConstantBuffer*& cbo )
 {
 	// Copy vertices
-	D3D11_MAPPED_SUBRESOURCE resource;
-	m_deviceContext->Map( cbo->m_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource );
-	memcpy( resource.pData, data, size );
-	m_deviceContext->Unmap( cbo->m_buffer, 0 );
+	m_backend->CopyToBuffer( cbo->m_buffer, data, size );
 }
 
 void Renderer::BindConstantBuffer( int slot, ConstantBuffer* cbo )
 {
-	m_deviceContext->VSSetConstantBuffers( slot, 1, &cbo->m_buffer );
-	m_deviceContext->PSSetConstantBuffers( slot, 1, &cbo->m_buffer );
+	m_backend->BindConstantBuffer( slot, cbo->m_buffer );
 }
 
 void Renderer::DrawVertexBuffer( VertexBuffer* vbo, int vertexCount, int vertexOffset )
 {
 	BindVertexBuffer( vbo );
 	SetStateIfChanged();
-	m_deviceContext->Draw( vertexCount, vertexOffset );
+	m_backend->Draw( vertexCount, vertexOffset );
 }
 
 void Renderer::DrawVertexAndIndexBuffer( VertexBuffer* vbo, IndexBuffer* ibo, int indexCount, VertexType vertexType )
@@ -1051,7 +676,7 @@ void Renderer::DrawVertexAndIndexBuffer( VertexBuffer* vbo, IndexBuffer* ibo, in
 	BindVertexBuffer( vbo, vertexType );
 	BindIndexBuffer( ibo );
 	SetStateIfChanged();
-	m_deviceContext->DrawIndexed( indexCount, 0, 0 );	
+	m_backend->DrawIndexed( indexCount );
 }
 
 void Renderer::DrawVertexAndIndexBuffer( VertexBuffer* vbo, VertexBuffer* vbo2, IndexBuffer* ibo, int indexCount )
@@ -1059,34 +684,32 @@ void Renderer::DrawVertexAndIndexBuffer( VertexBuffer* vbo, VertexBuffer* vbo2,
 	BindVertexBuffer( vbo, vbo2 );
 	BindIndexBuffer( ibo );
 	SetStateIfChanged();
-	m_deviceContext->DrawIndexed( indexCount, 0, 0 );
+	m_backend->DrawIndexed( indexCount );
 }
 
 void Renderer::SetStateIfChanged()
 {
-	if (m_blendState != m_blendStates[(int)(m_desiredBlendMode)])
+	if (m_blendMode != m_desiredBlendMode)
 	{
-		m_blendState = m_blendStates[(int)(m_desiredBlendMode)];
-		float blendFactor[4] = { 0.f, 0.f, 0.f, 0.f };
-		UINT SampleMask = 0xffffffff;
-		m_deviceContext->OMSetBlendState( m_blendState, blendFactor, SampleMask );
+		m_blendMode = m_desiredBlendMode;
+		m_backend->SetBlendMode( m_blendMode );
 	}
 
-	if (m_rasterizerState != m_rasterizerStates[(int)(m_desiredRasterizerMode)])
+	if (m_rasterizerMode != m_desiredRasterizerMode)
 	{
-		m_rasterizerState = m_rasterizerStates[(int)(m_desiredRasterizerMode)];
-		m_deviceContext->RSSetState( m_rasterizerStates[(int)m_desiredRasterizerMode] );
+		m_rasterizerMode = m_desiredRasterizerMode;
+		m_backend->SetRasterizerMode( m_rasterizerMode );
 	}
 	
-	if (m_samplerState != m_samplerStates[(int)(m_desiredSamplerMode)] )
+	if (m_samplerMode != m_desiredSamplerMode)
 	{
-		m_samplerState = m_samplerStates[(int)(m_desiredSamplerMode)];
-		m_deviceContext->PSSetSamplers( 0, 1, &m_samplerState );
+		m_samplerMode = m_desiredSamplerMode;
+		m_backend->SetSamplerMode( m_samplerMode, 0 );
 	}
-	if (m_depthStencilState != m_depthStencilStates[(int)(m_desiredDepthMode)])
+	if (m_depthMode != m_desiredDepthMode)
 	{
-		m_depthStencilState = m_depthStencilStates[(int)(m_desiredDepthMode)];
-		m_deviceContext->OMSetDepthStencilState( m_depthStencilState, 0 );
+		m_depthMode = m_desiredDepthMode;
+		m_backend->SetDepthMode( m_depthMode );
 	}
 }
 
@@ -1105,10 +728,8 @@ void Renderer::RenderEmissive()
 	std::vector<Vertex_PCU> vertsScreenQuad;
 	AddVertsForAABB2D( vertsScreenQuad, AABB2( Vec2( -1.f, 1.f ), Vec2( 1.f, -1.f ) ), Rgba8::WHITE );
 
-	ID3D11RenderTargetView* nullRTVs[] = { nullptr, nullptr };
-	ID3D11ShaderResourceView* nullSRVs[] = { nullptr, nullptr };
-	m_deviceContext->PSSetShaderResources( 0, 2, nullSRVs );
-	m_deviceContext->OMSetRenderTargets( 2, nullRTVs, nullptr );
+	m_backend->UnbindTextures( 0, 2 );
+	m_backend->UnbindRenderTargets();
 	
 	SetModelConstants();
 	SetDepthMode( DepthMode::DISABLED );
@@ -1117,8 +738,9 @@ void Renderer::RenderEmissive()
 	SetRasterizerState( RasterizerMode::SOLID_CULL_FRONT );
 
 	BlurConstants blurConstants;
-	blurConstants.TexelSize.x = 1.f / (float)m_config.m_window->GetClientDimensions().x;
-	blurConstants.TexelSize.y = 1.f / (float)m_config.m_window->GetClientDimensions().y;
+	IntVec2 dimensions = GetRenderDimensions();
+	blurConstants.TexelSize.x = 1.f / (float)dimensions.x;
+	blurConstants.TexelSize.y = 1.f / (float)dimensions.y;
 	blurConstants.LerpT = 1;
 	blurConstants.NumSamples = 13;
 	blurConstants.Samples[0].Offset = Vec2( -2.f, -2.f );
@@ -1151,37 +773,23 @@ void Renderer::RenderEmissive()
 	CopyCPUToGPU( &blurConstants, sizeof( BlurConstants ), m_blurCBO );
 	BindConstantBuffer( k_blurConstantsSlot, m_blurCBO );
 
-	D3D11_VIEWPORT viewport = { 0 };
-	viewport.TopLeftX = 0.0f;
-	viewport.TopLeftY = 0.0f;
-	viewport.Width = (float)m_emissiveBlurDownTexture[0]->GetDimensions().x;
-	viewport.Height = (float)m_emissiveBlurDownTexture[0]->GetDimensions().y;
-	viewport.MinDepth = 0.0f;
-	viewport.MaxDepth = 1.0f;
-	m_deviceContext->RSSetViewports( 1, &viewport );
+	m_backend->SetViewport( 0.f, 0.f, (float)m_emissiveBlurDownTexture[0]->GetDimensions().x, (float)m_emissiveBlurDownTexture[0]->GetDimensions().y );
 
 	BindShader( CreateShader( "Data/Shaders/BlurDown.hlsl", VertexType::VERTEX_PCU ) );
-	m_deviceContext->PSSetShaderResources( 0, 2, nullSRVs );
-	m_deviceContext->OMSetRenderTargets( 1, &m_emissiveBlurDownTexture[0]->m_renderTargetView, nullptr );
+	m_backend->UnbindTextures( 0, 2 );
+	m_backend->SetRenderTargets( &m_emissiveBlurDownTexture[0], 1, false );
 	BindTexture( m_emissiveRenderTexture );
 	DrawVertexArray( vertsScreenQuad );
 
 	for (int i = 1; i < k_blurDownTextureCount; i++)
 	{
- 		viewport = { 0 };
- 		viewport.TopLeftX = 0.0f;
- 		viewport.TopLeftY = 0.0f;
-		viewport.Width = (float)m_emissiveBlurDownTexture[i]->GetDimensions().x;
-		viewport.Height = (float)m_emissiveBlurDownTexture[i]->GetDimensions().y;
- 		viewport.MinDepth = 0.0f;
- 		viewport.MaxDepth = 1.0f;
- 		m_deviceContext->RSSetViewports( 1, &viewport );
+		m_backend->SetViewport( 0.f, 0.f, (float)m_emissiveBlurDownTexture[i]->GetDimensions().x, (float)m_emissiveBlurDownTexture[i]->GetDimensions().y );
 		blurConstants.TexelSize.x = 1.f / (float)m_emissiveBlurDownTexture[i - 1]->GetDimensions().x;
 		blurConstants.TexelSize.y = 1.f / (float)m_emissiveBlurDownTexture[i - 1]->GetDimensions().y;
 		CopyCPUToGPU( &blurConstants, sizeof( BlurConstants ), m_blurCBO );
 		BindConstantBuffer( k_blurConstantsSlot, m_blurCBO );
-		m_deviceContext->PSSetShaderResources( 0, 2, nullSRVs );
-		m_deviceContext->OMSetRenderTargets( 1, &m_emissiveBlurDownTexture[i]->m_renderTargetView, nullptr );
+		m_backend->UnbindTextures( 0, 2 );
+		m_backend->SetRenderTargets( &m_emissiveBlurDownTexture[i], 1, false );
 		BindTexture( m_emissiveBlurDownTexture[i - 1] );
 		DrawVertexArray( vertsScreenQuad );	
 	}
@@ -1221,65 +829,45 @@ void Renderer::RenderEmissive()
 
 	for (int i = k_blurUpTextureCount - 1; i >= 0; i--)
 	{
-		viewport = { 0 };
-		viewport.TopLeftX = 0.0f;
-		viewport.TopLeftY = 0.0f;
-		viewport.Width = (float)m_emissiveBlurUpTexture[i]->GetDimensions().x;
-		viewport.Height = (float)m_emissiveBlurUpTexture[i]->GetDimensions().y;
-		viewport.MinDepth = 0.0f;
-		viewport.MaxDepth = 1.0f;
-		m_deviceContext->RSSetViewports( 1, &viewport );
+		m_backend->SetViewport( 0.f, 0.f, (float)m_emissiveBlurUpTexture[i]->GetDimensions().x, (float)m_emissiveBlurUpTexture[i]->GetDimensions().y );
 		blurConstants.TexelSize.x = 1.f / (float)((i == k_blurUpTextureCount - 1) ? m_emissiveBlurDownTexture[i + 1] : m_emissiveBlurUpTexture[i + 1])->GetDimensions().x;
 		blurConstants.TexelSize.y = 1.f / (float)((i == k_blurUpTextureCount - 1) ? m_emissiveBlurDownTexture[i + 1] : m_emissiveBlurUpTexture[i + 1])->GetDimensions().y;
 		CopyCPUToGPU( &blurConstants, sizeof( BlurConstants ), m_blurCBO );
 		BindConstantBuffer( k_blurConstantsSlot, m_blurCBO );
-		m_deviceContext->PSSetShaderResources( 0, 2, nullSRVs );
-		m_deviceContext->OMSetRenderTargets( 1, &m_emissiveBlurUpTexture[i]->m_renderTargetView, nullptr );
+		m_backend->UnbindTextures( 0, 2 );
+		m_backend->SetRenderTargets( &m_emissiveBlurUpTexture[i], 1, false );
 		BindTexture( m_emissiveBlurDownTexture[i], 0 );
 		BindTexture( (i == k_blurUpTextureCount - 1) ? m_emissiveBlurDownTexture[i + 1] : m_emissiveBlurUpTexture[i + 1], 1 );
 		DrawVertexArray( vertsScreenQuad );
 	}
 
-	viewport = { 0 };
-	viewport.TopLeftX = 0.0f;
-	viewport.TopLeftY = 0.0f;
-	viewport.Width = (float)m_emissiveBlurUpTexture[0]->GetDimensions().x;
-	viewport.Height = (float)m_emissiveBlurUpTexture[0]->GetDimensions().y;
-	viewport.MinDepth = 0.0f;
-	viewport.MaxDepth = 1.0f;
-	m_deviceContext->RSSetViewports( 1, &viewport );
+	m_backend->SetViewport( 0.f, 0.f, (float)m_emissiveBlurUpTexture[0]->GetDimensions().x, (float)m_emissiveBlurUpTexture[0]->GetDimensions().y );
 	blurConstants.TexelSize.x = 1.f / m_emissiveBlurDownTexture[k_blurUpTextureCount - 1]->GetDimensions().x;
 	blurConstants.TexelSize.y = 1.f / m_emissiveBlurDownTexture[k_blurUpTextureCount - 1]->GetDimensions().y;
 	CopyCPUToGPU( &blurConstants, sizeof( BlurConstants ), m_blurCBO );
 	BindConstantBuffer( k_blurConstantsSlot, m_blurCBO );
-	m_deviceContext->PSSetShaderResources( 0, 2, nullSRVs );
-	m_deviceContext->OMSetRenderTargets( 1, &m_emissiveBlurDownTexture[0]->m_renderTargetView, nullptr );
+	m_backend->UnbindTextures( 0, 2 );
+	m_backend->SetRenderTargets( &m_emissiveBlurDownTexture[0], 1, false );
 	BindTexture( m_emissiveRenderTexture, 0 );
 	BindTexture( m_emissiveBlurUpTexture[0], 1 );
 	DrawVertexArray( vertsScreenQuad );
 
 	BindShader( CreateShader( "Data/Shaders/Composite.hlsl", VertexType::VERTEX_PCU ) );
 
- 	viewport = { 0 };
- 	viewport.TopLeftX = 0.0f;
- 	viewport.TopLeftY = 0.0f;
- 	viewport.Width = (float)m_config.m_window->GetClientDimensions().x;
- 	viewport.Height = (float)m_config.m_window->GetClientDimensions().y;
- 	viewport.MinDepth = 0.0f;
- 	viewport.MaxDepth = 1.0f;
- 	m_deviceContext->RSSetViewports( 1, &viewport );
-	m_deviceContext->PSSetShaderResources( 0, 2, nullSRVs );
-	m_deviceContext->OMSetRenderTargets( 1, &m_renderTargetView, m_depthStencilView );
+	m_backend->SetViewport( 0.f, 0.f, (float)dimensions.x, (float)dimensions.y );
+	m_backend->UnbindTextures( 0, 2 );
+	Texture* backBuffer = nullptr;
+	m_backend->SetRenderTargets( &backBuffer, 1, true );
 	BindTexture( m_emissiveBlurUpTexture[0]);
 	SetBlendMode( BlendMode::ADDITIVE );
 	DrawVertexArray( vertsScreenQuad );
 
-	ID3D11RenderTargetView* RTVs[] =
+	Texture* renderTargets[] =
 	{
-		m_renderTargetView,
-		m_emissiveRenderTexture->m_renderTargetView,
+		nullptr,
+		m_emissiveRenderTexture,
 	};
-	m_deviceContext->OMSetRenderTargets( 2, RTVs, m_depthStencilView );
+	m_backend->SetRenderTargets( renderTargets, 2, true );
 
 	SetModelConstants();
 	SetDepthMode( DepthMode::ENABLED );
@@ -1333,49 +921,12 @@ Texture* Renderer::CreateTextureFromImage( Image const& image, char const* name
 }
 */
 
-Texture* Renderer::CreateTextureFromImage( Image const& image, char const* name )
+Texture* Renderer::CreateTextureFromImage( Image const& image, char const* name, bool generateMips )
 {
 	Texture* newTexture = new Texture;
 	newTexture->m_dimensions = image.GetDimensions();
 	newTexture->m_name = name;
-
-	D3D11_TEXTURE2D_DESC textureDesc = {};
-	textureDesc.Width = image.GetDimensions().x;
-	textureDesc.Height = image.GetDimensions().y;
-	textureDesc.MipLevels = 0;
-	textureDesc.ArraySize = 1;
-	textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-	textureDesc.SampleDesc.Count = 1;
-	textureDesc.Usage = D3D11_USAGE_DEFAULT;
-	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
-	textureDesc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
-
-	HRESULT hr = m_device->CreateTexture2D( &textureDesc, nullptr, &newTexture->m_texture );
-	if (FAILED( hr ))
-	{
-		ERROR_AND_DIE( Stringf( "Could not create texture from image for file \"%s\".", image.GetImageFilePath().c_str() ) );
-	}
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-	srvDesc.Format = textureDesc.Format;
-	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Texture2D.MostDetailedMip = 0;
-	srvDesc.Texture2D.MipLevels = (UINT)-1;
-
-	hr = m_device->CreateShaderResourceView( newTexture->m_texture, &srvDesc, &newTexture->m_shaderResourceView );
-	if (FAILED( hr ))
-	{
-		ERROR_AND_DIE( Stringf( "Could not create shader resource view from image for file \"%s\".", image.GetImageFilePath().c_str() ) );
-	}
-
-	deviceContextMutex.lock();
-
-	m_deviceContext->UpdateSubresource( newTexture->m_texture, 0, nullptr, image.GetRawData(), 4 * image.GetDimensions().x, 0 );
-
-	m_deviceContext->GenerateMips( newTexture->m_shaderResourceView );
-
-	deviceContextMutex.unlock();
-
+	m_backend->CreateTexture( newTexture, image, generateMips );
 	return newTexture;
 }
 
@@ -1391,45 +942,183 @@ Texture* Renderer::CreateTextureFromData( char const* name, IntVec2 dimensions,
 	newTexture->m_name = name;
 	newTexture->m_dimensions = dimensions;
 
-	m_loadedTextures.push_back( newTexture );
+	AddLoadedTexture( newTexture );
 	return newTexture;
 }
 
+void Renderer::PrepareImageForUpload( Image& image, TextureUsage usage, bool compress ) const
+{
+	if (!m_config.m_generateMipsOnCPU || image.IsCompressed() || usage == TextureUsage::NO_MIPS)
+		return;
+
+	image.GenerateMipChain( usage == TextureUsage::COLOR );
+
+	if (!compress)
+		return;
+
+	if (usage == TextureUsage::NORMAL_MAP)
+	{
+		if (m_config.m_compressNormalMapsToBC5)
+		{
+			image.Compress( BlockCompressionFormat::BC5 );
+		}
+		return;
+	}
+	image.Compress( image.HasTranslucentTexels() ? BlockCompressionFormat::BC3 : BlockCompressionFormat::BC1 );
+}
+
+// Size and write time of the source plus the settings that change its blocks, touching either misses the cache
+static unsigned long long ComputeTextureSourceKey( char const* imageFilePath, TextureUsage usage, RenderConfig const& config )
+{
+	std::error_code error;
+	unsigned long long fileSize = (unsigned long long)std::filesystem::file_size( imageFilePath, error );
+	if (error)
+		return 0;
+	std::filesystem::file_time_type writeTime = std::filesystem::last_write_time( imageFilePath, error );
+	if (error)
+		return 0;
+
+	unsigned long long const values[] =
+	{
+		fileSize,
+		(unsigned long long)writeTime.time_since_epoch().count(),
+		config.m_compressNormalMapsToBC5 ? 1ull : 0ull,
+		(unsigned long long)usage,
+	};
+	unsigned long long hash = 14695981039346656037ull;
+	for (unsigned long long value : values)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			hash ^= (value >> (i * 8)) & 0xff;
+			hash *= 1099511628211ull;
+		}
+	}
+	// 0 is reserved for files loaded without a key
+	return hash != 0 ? hash : 1;
+}
+
+std::string Renderer::GetCompressedTexturePath( char const* imageFilePath, TextureUsage usage ) const
+{
+	// the cache only holds what PrepareImageForUpload compresses, and compressed files are read as they are
+	if (m_config.m_compressedTextureDirectory.empty() || !m_config.m_generateMipsOnCPU || !m_config.m_compressTextures
+		|| usage == TextureUsage::NO_MIPS || IsCompressedImageFilePath( imageFilePath ))
+		return "";
+
+	std::string fileName = imageFilePath;
+	for (char& character : fileName)
+	{
+		if (character == '/' || character == '\\' || character == ':' || character == '.')
+		{
+			character = '_';
+		}
+	}
+	std::string path = m_config.m_compressedTextureDirectory;
+	if (path.back() != '/' && path.back() != '\\')
+	{
+		path += '/';
+	}
+	return path + fileName + k_compressedImageExtension;
+}
+
+void Renderer::LoadImageForUpload( Image& image, char const* imageFilePath, TextureUsage usage, bool compress ) const
+{
+	std::string compressedPath = compress ? GetCompressedTexturePath( imageFilePath, usage ) : "";
+	unsigned long long sourceKey = compressedPath.empty() ? 0 : ComputeTextureSourceKey( imageFilePath, usage, m_config );
+	if (sourceKey != 0 && image.LoadCompressedFile( compressedPath.c_str(), sourceKey ))
+	{
+		image.m_imageFilePath = imageFilePath;
+		return;
+	}
+
+	image.LoadFromFile( imageFilePath );
+	PrepareImageForUpload( image, usage, compress );
+	if (sourceKey != 0 && image.IsCompressed())
+	{
+		std::error_code error;
+		std::filesystem::create_directories( m_config.m_compressedTextureDirectory, error );
+		if (!error)
+		{
+			image.SaveCompressedFile( compressedPath.c_str(), sourceKey );
+		}
+	}
+}
+
+void Renderer::AddLoadedShader( Shader* shader )
+{
+	shader->m_isOwnedByRenderer = true;
+	m_loadedShaders.push_back( shader );
+	m_shadersByName.emplace( shader->GetName(), shader );
+}
+
+void Renderer::AddLoadedTexture( Texture* texture )
+{
+	m_loadedTextures.push_back( texture );
+	m_texturesByPath.emplace( texture->GetImageFilePath(), texture );
+}
+
 bool Renderer::RemoveLoadedTexture( Texture* texture )
 {
 	for (int i = 0; i < m_loadedTextures.size(); i++)
 	{
 		if (m_loadedTextures[i] == texture)
 		{
-			delete texture;
+			auto found = m_texturesByPath.find( texture->GetImageFilePath() );
+			if (found != m_texturesByPath.end() && found->second == texture)
+			{
+				m_texturesByPath.erase( found );
+			}
 			m_loadedTextures[i] = nullptr;
+
+			if (!texture->IsResident())
+			{
+				// only this texture's own job matters, a decoded image is dropped and a running job hands the texture back later
+				std::lock_guard<std::mutex> lock( m_streamedTexturesMutex );
+				for (size_t streamedIndex = 0; streamedIndex < m_streamedTextures.size(); streamedIndex++)
+				{
+					if (m_streamedTextures[streamedIndex].m_texture == texture)
+					{
+						delete m_streamedTextures[streamedIndex].m_image;
+						m_streamedTextures.erase( m_streamedTextures.begin() + streamedIndex );
+						m_streamingTextureCount--;
+						break;
+					}
+				}
+				if (texture->m_isStreaming)
+				{
+					texture->m_isPendingDelete = true;
+					return true;
+				}
+			}
+			delete texture;
 			return true;
 		}
 	}
 	return false;
 }
 
-Texture* Renderer::CreateTextureFromFile( char const* imageFilePath )
+Texture* Renderer::CreateTextureFromFile( char const* imageFilePath, TextureUsage usage )
 {
 	if (!std::filesystem::exists( imageFilePath ))
 		return nullptr;
 
-	Image newImage = Image( imageFilePath );
-	Texture* newTexture = CreateTextureFromImage( newImage, imageFilePath );
-	m_loadedTextures.push_back( newTexture );
+	Image newImage;
+	LoadImageForUpload( newImage, imageFilePath, usage, false );
+	Texture* newTexture = CreateTextureFromImage( newImage, imageFilePath, usage != TextureUsage::NO_MIPS );
+	AddLoadedTexture( newTexture );
 	return newTexture;
 }
 
 void Renderer::BindTexture( Texture* textureMap, unsigned int slot )
 {
-	if (textureMap == nullptr)
+	if (textureMap == nullptr || !textureMap->IsResident())
 	{
-		BindTexture( m_defaultTexture );
+		BindTexture( m_defaultTexture, slot );
 		return;
 	}
 
 	m_currentTexture = textureMap;
-	m_deviceContext->PSSetShaderResources( slot, 1, &m_currentTexture->m_shaderResourceView );
+	m_backend->BindTexture( m_currentTexture, slot );
 }
 
 void Renderer::SetSamplerMode( SamplerMode samplerMode, unsigned int slot )
@@ -1440,7 +1129,7 @@ void Renderer::SetSamplerMode( SamplerMode samplerMode, unsigned int slot )
 	}
 	else
 	{
-		m_deviceContext->PSSetSamplers( slot, 1, &m_samplerStates[(int)(samplerMode)] );
+		m_backend->SetSamplerMode( samplerMode, slot );
 	}
 }
 
@@ -1482,81 +1171,138 @@ void Renderer::SetLightingConstants( LightingConstants const& lightingConstants
 
 void Renderer::SetModelConstants( Mat44 const& modelMatrix, Rgba8 const& modelColor )
 {
+	m_lastModelMatrix = modelMatrix;
+	m_lastModelColor = modelColor;
+
 	ModelConstants modelConst;
 	modelConst.modelMatrix = modelMatrix;
 	modelColor.GetAsFloats( modelConst.modelColor );
-	CopyCPUToGPU( &modelConst, sizeof( ModelConstants ), m_modelCBO );
-	BindConstantBuffer( k_modelConstantSlot, m_modelCBO );
+	SetConstants( k_modelConstantSlot, &modelConst, sizeof( ModelConstants ), m_modelCBO );
 }
 
-void Renderer::SetJointConstants( std::vector<Mat44> const& globleTransforms, std::vector<Joint> const& joints )
+static void FillJointConstants( JointConstants& jointConst, std::vector<Mat44> const& globleTransforms, std::vector<Joint> const& joints )
 {
-	JointConstants* jointConst = new JointConstants;
+	// entries past the skeleton are left as they were, the shader never indexes them
 	int maxSize = MIN( 200, (int)joints.size() - 1 );
 	for (int i = 0; i < maxSize; i++)
 	{
-		jointConst->globalBineposeInverse[i] = joints[i].m_globalBindposeInverse;
-		jointConst->currentGlobalTransform[i] = globleTransforms[i];
+		jointConst.globalBineposeInverse[i] = joints[i].m_globalBindposeInverse;
+		jointConst.currentGlobalTransform[i] = globleTransforms[i];
 	}
-	CopyCPUToGPU( jointConst, sizeof( JointConstants ), m_jointCBO );
-	BindConstantBuffer( k_jointConstantSlot, m_jointCBO );
-	delete jointConst;
 }
 
-Texture* Renderer::CreateRenderTexture( IntVec2 const& dimensions, const char* name )
+void Renderer::SetJointConstants( std::vector<Mat44> const& globleTransforms, std::vector<Joint> const& joints )
 {
-	Texture* newTexture = new Texture;
-	newTexture->m_dimensions = dimensions;
-	newTexture->m_name = name;
-	D3D11_TEXTURE2D_DESC renderTextureDesc = {};
-	renderTextureDesc.Width = dimensions.x;
-	renderTextureDesc.Height = dimensions.y;
-	renderTextureDesc.MipLevels = 1;
-	renderTextureDesc.ArraySize = 1;
-	renderTextureDesc.Usage = D3D11_USAGE_DEFAULT;
-	renderTextureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-	renderTextureDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
-	renderTextureDesc.SampleDesc.Count = 1;
-	HRESULT hr = m_device->CreateTexture2D( &renderTextureDesc, nullptr, &newTexture->m_texture );
-	if (!SUCCEEDED( hr ))
-	{
-		ERROR_AND_DIE( "Could not create render texture" );
+	m_jointPaletteStaging.resize( sizeof( JointConstants ) );
+	JointConstants* jointConst = (JointConstants*)m_jointPaletteStaging.data();
+	FillJointConstants( *jointConst, globleTransforms, joints );
+	SetConstants( k_jointConstantSlot, jointConst, sizeof( JointConstants ), m_jointCBO );
+}
+
+void Renderer::UploadJointPalettes( std::vector<JointPalette>& palettes )
+{
+	for (JointPalette& palette : palettes)
+	{
+		palette.m_isUploaded = false;
 	}
-	hr = m_device->CreateShaderResourceView( newTexture->m_texture, NULL, &newTexture->m_shaderResourceView );
-	if (!SUCCEEDED( hr ))
+	if (palettes.empty() || !m_constantRingCBO)
+		return;
+
+	static_assert(sizeof( JointConstants ) % k_constantSliceAlignment == 0, "joint palettes must pack into aligned slices");
+	m_jointPaletteStaging.resize( palettes.size() * sizeof( JointConstants ) );
+	JointConstants* jointConsts = (JointConstants*)m_jointPaletteStaging.data();
+	for (size_t i = 0; i < palettes.size(); i++)
 	{
-		ERROR_AND_DIE( Stringf( "Could not create shader resource view" ) );
+		FillJointConstants( jointConsts[i], *palettes[i].m_globalTransforms, *palettes[i].m_joints );
 	}
- 	hr = m_device->CreateRenderTargetView( newTexture->m_texture, NULL, &newTexture->m_renderTargetView );
-	if (!SUCCEEDED( hr ))
+
+	size_t offset = 0;
+	if (!WriteToConstantRing( jointConsts, m_jointPaletteStaging.size(), offset ))
+		return;
+
+	for (size_t i = 0; i < palettes.size(); i++)
+	{
+		palettes[i].m_ringOffset = offset + i * sizeof( JointConstants );
+		palettes[i].m_isUploaded = true;
+	}
+}
+
+void Renderer::BindJointPalette( JointPalette const& palette )
+{
+	if (palette.m_isUploaded)
+	{
+		m_backend->BindConstantBufferRange( k_jointConstantSlot, m_constantRingCBO->m_buffer, palette.m_ringOffset, sizeof( JointConstants ) );
+	}
+	else
 	{
-		ERROR_AND_DIE( Stringf( "Could not create render target view" ) );
+		SetJointConstants( *palette.m_globalTransforms, *palette.m_joints );
 	}
+}
+
+bool Renderer::WriteToConstantRing( void const* data, size_t byteSize, size_t& out_offset )
+{
+	if (!m_constantRingCBO)
+		return false;
+
+	// discarding only at the start of a frame keeps every slice handed out this frame intact
+	bool discard = !m_hasConstantRingWrites;
+	size_t offset = discard ? 0 : ((m_constantRingOffset + k_constantSliceAlignment - 1) / k_constantSliceAlignment) * k_constantSliceAlignment;
+	if (offset + byteSize > k_constantRingBytes)
+		return false;
+
+	m_backend->WriteToBuffer( m_constantRingCBO->m_buffer, offset, data, byteSize, discard );
+	m_hasConstantRingWrites = true;
+	m_constantRingOffset = offset + byteSize;
+	out_offset = offset;
+	return true;
+}
+
+void Renderer::SetConstants( int slot, void const* data, size_t byteSize, ConstantBuffer*& fallbackCBO )
+{
+	size_t offset = 0;
+	if (WriteToConstantRing( data, byteSize, offset ))
+	{
+		m_backend->BindConstantBufferRange( slot, m_constantRingCBO->m_buffer, offset, byteSize );
+	}
+	else
+	{
+		CopyCPUToGPU( data, byteSize, fallbackCBO );
+		BindConstantBuffer( slot, fallbackCBO );
+	}
+}
+
+Texture* Renderer::CreateRenderTexture( IntVec2 const& dimensions, const char* name )
+{
+	Texture* newTexture = new Texture;
+	newTexture->m_dimensions = dimensions;
+	newTexture->m_name = name;
+	m_backend->CreateRenderTexture( newTexture );
 	return newTexture;
 }
 
 void Renderer::SetCameraConstants( Mat44 const& projectionMatrix, Mat44 const& viewMatrix )
 {
+	m_lastProjectionMatrix = projectionMatrix;
+	m_lastViewMatrix = viewMatrix;
+
 	CameraConstants cameraConst;
 	cameraConst.projectionMatrix = projectionMatrix;
 	cameraConst.viewMatrix = viewMatrix;
-
-	CopyCPUToGPU( &cameraConst, sizeof( CameraConstants ), m_cameraCBO );
-	BindConstantBuffer( k_cameraConstantSlot, m_cameraCBO );
+	SetConstants( k_cameraConstantSlot, &cameraConst, sizeof( CameraConstants ), m_cameraCBO );
 }
 
  //------------------------------------------------------------------------------------------------
  BitmapFont* Renderer::CreateBitmapFontFromFile( char const* fontFilePathNameWithNoExtension )
  {
  	std::string imageFilePath = std::string(fontFilePathNameWithNoExtension);
- 	Texture& diffuseMap = *CreateOrGetTextureFromFile( imageFilePath.c_str() );
+ 	Texture& diffuseMap = *CreateOrGetTextureFromFile( imageFilePath.c_str(), TextureUsage::NO_MIPS );
  	return new BitmapFont( imageFilePath.c_str(), diffuseMap );
  }
  BitmapFont* Renderer::CreateCustomBitmapFontFromXml( char const* xmlPath, char const* imagePath )
  {
-	 Texture* newBitMapFontTex = CreateTextureFromFile( imagePath );
+	 Texture* newBitMapFontTex = CreateTextureFromFile( imagePath, TextureUsage::NO_MIPS );
 	 BitmapFont* bitMapFont = new BitmapFont( xmlPath, imagePath, *newBitMapFontTex );
-	 m_loadedFonts.push_back( bitMapFont );
+	 AddLoadedFont( bitMapFont );
 	 return bitMapFont;
  }
 // 
@@ -1587,30 +1333,24 @@ void Renderer::SetCameraConstants( Mat44 const& projectionMatrix, Mat44 const& v
 // 
  Texture* Renderer::GetTextureForFileName( char const* filePath )
  {
-	 for (int i = 0; i < static_cast<int>(m_loadedTextures.size()); ++i)
-	 {
-		 if (!strcmp( m_loadedTextures[i]->GetImageFilePath().c_str(), filePath ))
-		 {
-			 return m_loadedTextures[i];
-		 }
-	 }
-	 return nullptr;
+	 auto found = m_texturesByPath.find( filePath );
+	 return found != m_texturesByPath.end() ? found->second : nullptr;
  }
 
  BitmapFont* Renderer::GetBitmapForFileName( char const* filePath )
  {
-	 for (int i = 0; i < static_cast<int>(m_loadedFonts.size()); ++i)
-	 {
-		 if (strcmp( m_loadedFonts[i]->GetImageFilePath().c_str(), filePath) == 0)
-		 {
-			 return m_loadedFonts[i];
-		 }
-	 }
-	 return nullptr;
+	 auto found = m_fontsByPath.find( filePath );
+	 return found != m_fontsByPath.end() ? found->second : nullptr;
+ }
+
+ void Renderer::AddLoadedFont( BitmapFont* font )
+ {
+	 m_loadedFonts.push_back( font );
+	 m_fontsByPath.emplace( font->GetImageFilePath(), font );
  }
  
  //------------------------------------------------------------------------------------------------
- Texture* Renderer::CreateOrGetTextureFromFile( char const* imageFilePath )
+ Texture* Renderer::CreateOrGetTextureFromFile( char const* imageFilePath, TextureUsage usage )
  {
  	// See if we already have this texture previously loaded
  	Texture* existingTexture = nullptr;
@@ -1621,10 +1361,91 @@ void Renderer::SetCameraConstants( Mat44 const& projectionMatrix, Mat44 const& v
  	}
  
  	// Never seen this texture before!  Let's load it.
- 	Texture* newTexture = CreateTextureFromFile( imageFilePath );
+ 	Texture* newTexture = CreateTextureFromFile( imageFilePath, usage );
  	return newTexture;
  }
  
+ Texture* Renderer::CreateOrGetTextureFromFileAsync( char const* imageFilePath, TextureUsage usage )
+ {
+	 Texture* existingTexture = GetTextureForFileName( imageFilePath );
+	 if (existingTexture)
+	 {
+		 return existingTexture;
+	 }
+
+	 if (!std::filesystem::exists( imageFilePath ))
+		 return nullptr;
+
+	 Texture* newTexture = new Texture;
+	 newTexture->m_name = imageFilePath;
+	 newTexture->m_dimensions = IntVec2::ZERO;
+	 newTexture->m_isResident = false;
+	 newTexture->m_isStreaming = true;
+	 AddLoadedTexture( newTexture );
+	 m_streamingTextureCount++;
+
+	 std::string path = imageFilePath;
+	 auto decode = [this, newTexture, path, usage]()
+		 {
+			 Image* image = new Image;
+			 LoadImageForUpload( *image, path.c_str(), usage, m_config.m_compressTextures );
+			 std::lock_guard<std::mutex> lock( m_streamedTexturesMutex );
+			 StreamedTexture streamedTexture;
+			 streamedTexture.m_texture = newTexture;
+			 streamedTexture.m_image = image;
+			 streamedTexture.m_usage = usage;
+			 m_streamedTextures.push_back( streamedTexture );
+			 newTexture->m_isStreaming = false;
+		 };
+
+	 if (g_jobSystem && g_jobSystem->GetWorkerCount() > 0)
+	 {
+		 g_jobSystem->QueueLambdaJob( decode, m_textureStreamingCounter, JobPriority::BACKGROUND );
+	 }
+	 else
+	 {
+		 decode();
+	 }
+	 return newTexture;
+ }
+
+ void Renderer::UploadStreamedTextures( int maxUploads )
+ {
+	 std::vector<StreamedTexture> readyTextures;
+	 {
+		 std::lock_guard<std::mutex> lock( m_streamedTexturesMutex );
+		 if (m_streamedTextures.empty())
+			 return;
+
+		 size_t count = m_streamedTextures.size();
+		 if (maxUploads >= 0 && (size_t)maxUploads < count)
+		 {
+			 count = (size_t)maxUploads;
+		 }
+		 readyTextures.assign( m_streamedTextures.begin(), m_streamedTextures.begin() + count );
+		 m_streamedTextures.erase( m_streamedTextures.begin(), m_streamedTextures.begin() + count );
+	 }
+
+	 for (StreamedTexture& streamedTexture : readyTextures)
+	 {
+		 Texture* texture = streamedTexture.m_texture;
+		 Image* image = streamedTexture.m_image;
+		 if (texture->m_isPendingDelete)
+		 {
+			 delete texture;
+		 }
+		 // a failed decode stays on the default texture
+		 else if (image->GetDimensions().x > 0 && image->GetDimensions().y > 0)
+		 {
+			 texture->m_dimensions = image->GetDimensions();
+			 m_backend->CreateTexture( texture, *image, streamedTexture.m_usage != TextureUsage::NO_MIPS );
+			 texture->m_isResident = true;
+		 }
+		 delete image;
+		 m_streamingTextureCount--;
+	 }
+ }
+
  BitmapFont* Renderer::CreateOrGetBitmapFont( const char* imageFilePath )
  {
 	 BitmapFont* existingFont = nullptr;
@@ -1634,6 +1455,6 @@ void Renderer::SetCameraConstants( Mat44 const& projectionMatrix, Mat44 const& v
 		 return existingFont;
 	 }
 	 BitmapFont* newFont = CreateBitmapFontFromFile( imageFilePath );
-	 m_loadedFonts.push_back( newFont );
+	 AddLoadedFont( newFont );
 	 return newFont;
  }
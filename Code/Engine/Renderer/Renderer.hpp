@@ -1,6 +1,8 @@
 #pragma once
 
 #include <vector>
+#include <unordered_map>
+#include <mutex>
 
 #include "Engine/Core/Vertex_PCU.hpp"
 #include "Engine/Core/Vertex_PCUTBN.hpp"
@@ -10,38 +12,14 @@
 #include "Engine/Core/Rgba8.hpp"
 #include "Engine/Renderer/Texture.hpp"
 #include "Engine/Renderer/BitmapFont.hpp"
+#include "Engine/Renderer/ShaderCache.hpp"
+#include "Engine/Core/HashedCaseInsensitiveString.hpp"
 #include "Game/EngineBuildPreferences.hpp"
 
-
-#if defined(ENGINE_DEBUG_RENDER)
-#include <dxgidebug.h>
-#pragma comment(lib, "dxguid.lib")
-#endif
-
-#define DX_SAFE_RELEASE(dxObject)		\
-{										\
-	if ((dxObject) != nullptr)			\
-	{									\
-		(dxObject)->Release();			\
-		(dxObject) = nullptr;			\
-	}									\
-}	
-
 #if defined(OPAQUE)
 #undef OPAQUE
 #endif
 
-struct ID3D11Device;
-struct ID3D11DeviceContext;
-struct IDXGISwapChain;
-struct ID3D11RenderTargetView;
-struct ID3D11RasterizerState;
-struct ID3D11BlendState;
-struct ID3D11SamplerState;
-struct ID3D11DepthStencilView;
-struct ID3D11Texture2D;
-struct ID3D11DepthStencilState;
-
 class Window;
 class Shader;
 class VertexBuffer;
@@ -49,6 +27,10 @@ class IndexBuffer;
 class ConstantBuffer;
 class Image;
 struct Joint;
+class RendererBackend;
+class RenderBuffer;
+class JobCounter;
+struct RendererStats;
 
 constexpr int k_blurDownTextureCount = 4;
 const int k_blurUpTextureCount = k_blurDownTextureCount - 1;
@@ -118,10 +100,44 @@ enum class VertexType
 	COUNT
 };
 
+// One skinned palette, filled in by Renderer::UploadJointPalettes
+struct JointPalette
+{
+	std::vector<Mat44> const* m_globalTransforms = nullptr;
+	std::vector<Joint> const* m_joints = nullptr;
+	size_t m_ringOffset = 0;
+	bool m_isUploaded = false;
+};
+
+// How a file texture is sampled, which decides its mip chain and block format
+// A path is loaded once, later requests for it get the texture with its first usage
+enum class TextureUsage
+{
+	COLOR,		// sRGB colour, mips are averaged with the sRGB curve
+	LINEAR,		// data such as spec, gloss and emissive masks, mips are averaged without the sRGB curve
+	NORMAL_MAP,	// linear like the above, and BC5 instead of BC1/BC3 when m_compressNormalMapsToBC5 is set
+	NO_MIPS,	// font atlases and UI drawn at their own size, a single uncompressed level
+};
+
 struct RenderConfig
 {
 	Window* m_window = nullptr;
 	bool m_emissiveEnabled = false;
+	// runs on the null backend without a window or device, for CPU benchmarks, always the case off Windows
+	bool m_headless = false;
+	IntVec2 m_headlessDimensions = IntVec2( 1600, 800 );
+	ShaderCacheConfig m_shaderCacheConfig;
+	// textures decoded by jobs are created on the render thread in BeginFrame, -1 is no limit
+	int m_maxTextureUploadsPerFrame = 8;
+	// file textures get a gamma correct mip chain built on the CPU instead of GenerateMips on the GPU
+	bool m_generateMipsOnCPU = true;
+	// streamed textures with a CPU mip chain are block compressed, BC1 when opaque and BC3 with alpha
+	// the encoder is lossy and slow, so CreateTextureFromFile never runs it
+	bool m_compressTextures = false;
+	// normal maps become BC5, which drops z and suits only shaders that rebuild it, otherwise they stay uncompressed
+	bool m_compressNormalMapsToBC5 = false;
+	// compressed textures are written here and read instead of their source while it is unchanged, empty disables
+	std::string m_compressedTextureDirectory;
 };
 
 class Renderer
@@ -136,12 +152,15 @@ public:
 	void EndFrame();
 	void Shutdown();
 
+	// Immediate draws without a buffer of their own are sub-allocated from the immediate rings
 	void DrawVertexArray( int numVertexes, Vertex_PCU const* vertexArray );
-	void DrawVertexArray( std::vector<Vertex_PCU> const vertexArray );
-	void DrawVertexArray( std::vector<Vertex_PCU> const vertexArray, std::vector<unsigned int> const IndexArray );
-	void DrawVertexArray( VertexBuffer* vertexBuffer, IndexBuffer* indexBuffer, std::vector<Vertex_PCU> const vertexArray, std::vector<unsigned int> const indexArray );
-	void DrawVertexArray( std::vector<Vertex_PCUTBN> const vertexArray, std::vector<unsigned int> const indexArray );
-	void DrawVertexArray( VertexBuffer* vertexBuffer, IndexBuffer* indexBuffer, std::vector<Vertex_PCUTBN> const vertexArray, std::vector<unsigned int> const indexArray );
+	void DrawVertexArray( int numVertexes, Vertex_PCU const* vertexArray, int numIndexes, unsigned int const* indexArray );
+	void DrawVertexArray( int numVertexes, Vertex_PCUTBN const* vertexArray, int numIndexes, unsigned int const* indexArray );
+	void DrawVertexArray( std::vector<Vertex_PCU> const& vertexArray );
+	void DrawVertexArray( std::vector<Vertex_PCU> const& vertexArray, std::vector<unsigned int> const& indexArray );
+	void DrawVertexArray( VertexBuffer* vertexBuffer, IndexBuffer* indexBuffer, std::vector<Vertex_PCU> const& vertexArray, std::vector<unsigned int> const& indexArray );
+	void DrawVertexArray( std::vector<Vertex_PCUTBN> const& vertexArray, std::vector<unsigned int> const& indexArray );
+	void DrawVertexArray( VertexBuffer* vertexBuffer, IndexBuffer* indexBuffer, std::vector<Vertex_PCUTBN> const& vertexArray, std::vector<unsigned int> const& indexArray );
 	void ClearScreen( Rgba8 const& defaultColor );
 	void BeginCamera( Camera const& camera );
 	void EndCamera( Camera const& camera );
@@ -177,8 +196,8 @@ public:
 
 	void RenderEmissive();
 
-	Texture* CreateTextureFromImage( Image const& image, char const* name );
-	Texture* CreateTextureFromFile( char const* filePath );
+	Texture* CreateTextureFromImage( Image const& image, char const* name, bool generateMips = true );
+	Texture* CreateTextureFromFile( char const* filePath, TextureUsage usage = TextureUsage::COLOR );
  	Texture* CreateTextureFromData( char const* name, IntVec2 dimensions, int bytesPerTexel, uint8_t* texelData );
 	bool RemoveLoadedTexture( Texture* texture );
 	void BindTexture( Texture* textureMap, unsigned int slot = 0 );
@@ -193,6 +212,9 @@ public:
 	void SetModelConstants( Mat44 const& modelMatrix = Mat44(), Rgba8 const& modelColor = Rgba8::WHITE );
 	void SetJointConstants( std::vector<Joint> const& joints );
 	void SetJointConstants( std::vector<Mat44> const& globleTransforms, std::vector<Joint> const& joints );
+	// Writes every palette into the constant ring with a single map, palettes that do not fit are left not uploaded
+	void UploadJointPalettes( std::vector<JointPalette>& palettes );
+	void BindJointPalette( JointPalette const& palette );
 
 	Texture* CreateRenderTexture( IntVec2 const& dimensions, const char* name );
 
@@ -200,64 +222,119 @@ public:
 
  	BitmapFont* GetBitmapForFileName( char const* fileName );
 // 
- 	Texture* CreateOrGetTextureFromFile( char const* imageFilePath );
+ 	Texture* CreateOrGetTextureFromFile( char const* imageFilePath, TextureUsage usage = TextureUsage::COLOR );
+	// Returns at once, the image is decoded on a background job and uploaded by a later BeginFrame
+	// Until then the handle binds as the default texture and reports zero dimensions
+	Texture* CreateOrGetTextureFromFileAsync( char const* imageFilePath, TextureUsage usage = TextureUsage::COLOR );
+	void UploadStreamedTextures( int maxUploads = -1 );
+	int GetStreamingTextureCount() const { return m_streamingTextureCount; }
 
 	BitmapFont* CreateOrGetBitmapFont( const char* imageFilePath );
  	BitmapFont* CreateBitmapFontFromFile( char const* imageFilePath );
 	BitmapFont* CreateCustomBitmapFontFromXml( char const* xmlPath, char const* imagePath );
 
 public:
-	ID3D11Device* GetD3D11Device() { return m_device; }
-	ID3D11DeviceContext* GetD3D11DeviceContext() { return m_deviceContext; }
-	ID3D11RenderTargetView* GetD3D11RenderTargetView() { return m_renderTargetView; }
+	// D3D11 only systems reach the device through D3D11RendererBackend
+	RendererBackend* GetBackend() const { return m_backend; }
+	// counted since the last BeginFrame
+	RendererStats const& GetStats() const;
+
+	IntVec2 GetRenderDimensions() const;
 
 private:
 // 	Texture* CreateTextureFromFile( char const* imageFilePath );
+	void AddLoadedTexture( Texture* texture );
+	void AddLoadedShader( Shader* shader );
+	void PrepareImageForUpload( Image& image, TextureUsage usage, bool compress ) const;
+	// Reads the compressed cache entry while its source is unchanged, otherwise decodes, prepares and refreshes it
+	// Only reads m_config, so streaming jobs call it as well, compress is false on the synchronous path
+	void LoadImageForUpload( Image& image, char const* imageFilePath, TextureUsage usage, bool compress ) const;
+	std::string GetCompressedTexturePath( char const* imageFilePath, TextureUsage usage ) const;
+	// Reuses bytecode from the shader cache when the key still matches, compiles and refreshes the entry otherwise
+	void CompileShaderToByteCodeCached( std::vector<unsigned char>& outByteCode, char const* shaderName, char const* name, char const* source, char const* entryPoint, char const* target );
+	void AddLoadedFont( BitmapFont* font );
+	// out_offset is a multiple of stride, false when the data does not fit in the ring at all
+	bool WriteToImmediateRing( RenderBuffer* ring, size_t ringSize, size_t& ringOffset, void const* data, size_t byteSize, size_t stride, size_t& out_offset );
+	void DrawImmediateRing( int numVertexes, void const* vertexArray, VertexType vertexType, int numIndexes, unsigned int const* indexArray );
+	// Slices stay valid for the rest of the frame, false once the ring is full or the backend cannot bind offsets
+	bool WriteToConstantRing( void const* data, size_t byteSize, size_t& out_offset );
+	void SetConstants( int slot, void const* data, size_t byteSize, ConstantBuffer*& fallbackCBO );
 
 	RenderConfig m_config;
 	void* m_displayDeviceContext = nullptr;
 
 	std::vector<Texture*> m_loadedTextures;
 	std::vector<BitmapFont*> m_loadedFonts;
+	// lookups by path, the vectors above keep ownership and load order
+	std::unordered_map<HashedCaseInsensitiveString, Texture*> m_texturesByPath;
+	std::unordered_map<HashedCaseInsensitiveString, BitmapFont*> m_fontsByPath;
+
+	// decoded images waiting for the render thread, filled by streaming jobs
+	struct StreamedTexture
+	{
+		Texture* m_texture = nullptr;
+		Image* m_image = nullptr;
+		TextureUsage m_usage = TextureUsage::COLOR;
+	};
+	std::vector<StreamedTexture> m_streamedTextures;
+	std::mutex m_streamedTexturesMutex;
+	JobCounter* m_textureStreamingCounter = nullptr;
+	int m_streamingTextureCount = 0;
 
 protected:
-	void* m_dxgiDebugModule = nullptr;
-	void* m_dxgiDebug = nullptr;
-	ID3D11Device* m_device = nullptr;
-	ID3D11DeviceContext* m_deviceContext = nullptr;
-	IDXGISwapChain* m_swapChain = nullptr;
-	ID3D11RenderTargetView* m_renderTargetView = nullptr;
+	RendererBackend* m_backend = nullptr;
+	ShaderCache* m_shaderCache = nullptr;
+	// Only used by immediate draws too large for the rings
 	VertexBuffer* m_immediateVBO = nullptr;
 	IndexBuffer* m_immediateIBO = nullptr;
+
+	// Written front to back with no-overwrite maps, discarded and restarted when full
+	// The offsets start at the end so the first write discards
+	static constexpr size_t k_immediateRingVertexBytes = 4 * 1024 * 1024;
+	static constexpr size_t k_immediateRingIndexBytes = 1024 * 1024;
+	VertexBuffer* m_immediateRingVBO = nullptr;
+	IndexBuffer* m_immediateRingIBO = nullptr;
+	size_t m_immediateRingVertexOffset = k_immediateRingVertexBytes;
+	size_t m_immediateRingIndexOffset = k_immediateRingIndexBytes;
+
+	// Camera, model and joint constants are sliced out of this ring, it is discarded by the first write of each frame
+	// Null when the backend cannot bind constant buffer ranges
+	static constexpr size_t k_constantRingBytes = 8 * 1024 * 1024;
+	static constexpr size_t k_constantSliceAlignment = 256;
+	ConstantBuffer* m_constantRingCBO = nullptr;
+	size_t m_constantRingOffset = 0;
+	bool m_hasConstantRingWrites = false;
+	std::vector<unsigned char> m_jointPaletteStaging;
+
+	// restored at the start of each frame since the slices they were bound from are gone
+	Mat44 m_lastProjectionMatrix;
+	Mat44 m_lastViewMatrix;
+	Mat44 m_lastModelMatrix;
+	Rgba8 m_lastModelColor = Rgba8::WHITE;
 	ConstantBuffer* m_cameraCBO = nullptr;
 	ConstantBuffer* m_modelCBO = nullptr;
 	ConstantBuffer* m_lightingCBO = nullptr;
 	ConstantBuffer* m_blurCBO = nullptr;
 	ConstantBuffer* m_jointCBO = nullptr;
 
-	ID3D11BlendState* m_blendState = nullptr;
+	// COUNT is not applied yet, the first draw always sets the state
+	BlendMode m_blendMode = BlendMode::COUNT;
 	BlendMode m_desiredBlendMode = BlendMode::ALPHA;
-	ID3D11BlendState* m_blendStates[(int)(BlendMode::COUNT)] = {};
 
-	ID3D11SamplerState* m_samplerState = nullptr;
+	SamplerMode m_samplerMode = SamplerMode::COUNT;
 	SamplerMode m_desiredSamplerMode = SamplerMode::POINT_CLAMP;
-	ID3D11SamplerState* m_samplerStates[(int)(SamplerMode::COUNT)] = {};
 
-	ID3D11RasterizerState* m_rasterizerState = nullptr;
+	RasterizerMode m_rasterizerMode = RasterizerMode::COUNT;
 	RasterizerMode m_desiredRasterizerMode = RasterizerMode::SOLID_CULL_NONE;
-	ID3D11RasterizerState* m_rasterizerStates[(int)(RasterizerMode::COUNT)] = {};
-
-	ID3D11DepthStencilView* m_depthStencilView = nullptr;
-	ID3D11Texture2D* m_depthStencilTexture = nullptr;
 
-	ID3D11DepthStencilState* m_depthStencilState = nullptr;
+	DepthMode m_depthMode = DepthMode::COUNT;
 	DepthMode m_desiredDepthMode = DepthMode::ENABLED;
-	ID3D11DepthStencilState* m_depthStencilStates[(int)(DepthMode::COUNT)] = {};
 
 	VertexBuffer* m_fullScreenQuadVBO_PCU = nullptr;
 
 protected:
 	std::vector<Shader*> m_loadedShaders;
+	std::unordered_map<HashedCaseInsensitiveString, Shader*> m_shadersByName;
 	Shader* m_currentShader = nullptr;
 	Shader* m_defaultShader = nullptr;
 	Texture* m_defaultTexture = nullptr;
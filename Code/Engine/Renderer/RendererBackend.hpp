@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vector>
+
+#include "Engine/Renderer/Renderer.hpp"
+
+enum class RenderBufferType
+{
+	VERTEX,
+	INDEX,
+	CONSTANT,
+	COUNT
+};
+
+// GPU buffer created by a backend, VertexBuffer, IndexBuffer and ConstantBuffer own one and delete it with themselves
+// Every backend derives its own, backends without a device hand out none
+class RenderBuffer
+{
+public:
+	virtual ~RenderBuffer() = default;
+};
+
+// Counted by every backend, reset by Renderer::BeginFrame
+struct RendererStats
+{
+	size_t m_bytesUploaded = 0;
+	int m_bufferUploads = 0;
+	int m_buffersCreated = 0;
+	int m_texturesCreated = 0;
+	int m_shadersCreated = 0;
+	int m_drawCount = 0;
+	int m_elementsDrawn = 0;
+	int m_shaderBinds = 0;
+	int m_textureBinds = 0;
+	int m_bufferBinds = 0;
+	int m_stateChanges = 0;
+	int m_renderTargetChanges = 0;
+};
+
+// Everything the Renderer asks of the graphics API, the Renderer itself only deals with engine types
+// Buffer and texture handles live on the engine objects and stay null on backends without a device
+class RendererBackend
+{
+public:
+	virtual ~RendererBackend() = default;
+
+	virtual void Startup( RenderConfig const& config, IntVec2 const& dimensions ) = 0;
+	virtual void Shutdown() = 0;
+	virtual void Present() = 0;
+
+	virtual void CompileShaderToByteCode( std::vector<unsigned char>& outByteCode, char const* name, char const* source, char const* entryPoint, char const* target ) = 0;
+	virtual void CreateShader( Shader* shader, std::vector<unsigned char> const& vertexByteCode, std::vector<unsigned char> const& pixelByteCode, VertexType vertexType ) = 0;
+	virtual void BindShader( Shader* shader ) = 0;
+
+	virtual void CreateBuffer( RenderBuffer*& out_buffer, size_t size, RenderBufferType type ) = 0;
+	// Replaces the whole buffer contents, earlier draws keep reading the old contents
+	virtual void CopyToBuffer( RenderBuffer* buffer, void const* data, size_t size ) = 0;
+	// Writes at offset without touching the rest, the caller guarantees no queued draw still reads that range
+	// unless discard is set, which orphans the whole buffer first
+	virtual void WriteToBuffer( RenderBuffer* buffer, size_t offset, void const* data, size_t size, bool discard ) = 0;
+	virtual void BindVertexBuffer( int slot, RenderBuffer* buffer, unsigned int stride, unsigned int offset ) = 0;
+	virtual void BindIndexBuffer( RenderBuffer* buffer ) = 0;
+	virtual void BindConstantBuffer( int slot, RenderBuffer* buffer ) = 0;
+	// offset is a multiple of 256, the bound range is size rounded up to 256
+	virtual void BindConstantBufferRange( int slot, RenderBuffer* buffer, size_t offset, size_t size ) = 0;
+	// Whether constant buffers can be written with no-overwrite and bound by range
+	virtual bool SupportsConstantBufferOffsets() const = 0;
+	virtual void SetPrimitiveTopology( bool isLineList ) = 0;
+	virtual void Draw( int vertexCount, int vertexOffset ) = 0;
+	virtual void DrawIndexed( int indexCount, int startIndex = 0, int baseVertex = 0 ) = 0;
+
+	virtual void SetBlendMode( BlendMode blendMode ) = 0;
+	virtual void SetRasterizerMode( RasterizerMode rasterizerMode ) = 0;
+	virtual void SetSamplerMode( SamplerMode samplerMode, unsigned int slot ) = 0;
+	virtual void SetDepthMode( DepthMode depthMode ) = 0;
+
+	// Images carrying mips or blocks are uploaded level by level, others go to mip 0 and the rest of the chain is generated
+	// unless generateMips is false, which leaves them a single level
+	virtual void CreateTexture( Texture* texture, Image const& image, bool generateMips ) = 0;
+	virtual void CreateRenderTexture( Texture* texture ) = 0;
+	virtual void BindTexture( Texture* texture, unsigned int slot ) = 0;
+	virtual void UnbindTextures( unsigned int firstSlot, int count ) = 0;
+
+	// A null entry in targets is the back buffer
+	virtual void SetRenderTargets( Texture* const* targets, int targetCount, bool bindDepth ) = 0;
+	virtual void UnbindRenderTargets() = 0;
+	virtual void ClearRenderTarget( Texture* target, Rgba8 const& color ) = 0;
+	virtual void ClearDepth() = 0;
+	virtual void SetViewport( float topLeftX, float topLeftY, float width, float height ) = 0;
+
+	RendererStats const& GetStats() const { return m_stats; }
+	void ResetStats() { m_stats = RendererStats(); }
+
+protected:
+	RendererStats m_stats;
+};
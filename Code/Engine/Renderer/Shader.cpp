@@ -1,3 +1,4 @@
+#if defined( _WIN32 )
 #include <d3d11.h>
 #include <d3dcompiler.h>
 #include <dxgi.h>
@@ -5,9 +6,13 @@
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "dxgi.lib")
 #pragma comment(lib, "d3dcompiler.lib")
+#endif
 
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/Shader.hpp"
+#if defined( _WIN32 )
+#include "Engine/Renderer/D3D11RendererBackend.hpp"
+#endif
 
 Shader::Shader( ShaderConfig const& config )
 	:m_config( config )
@@ -24,9 +29,11 @@ Shader::Shader( Shader const& copy )
 
 Shader::~Shader()
 {
+#if defined( _WIN32 )
 	DX_SAFE_RELEASE( m_inputLayoutForVertex );
 	DX_SAFE_RELEASE( m_pixelShader );
 	DX_SAFE_RELEASE( m_vertexShader );
+#endif
 }
 
 std::string const& Shader::GetName() const
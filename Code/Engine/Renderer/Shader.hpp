@@ -29,4 +29,8 @@ public:
 	ID3D11VertexShader* m_vertexShader = nullptr;
 	ID3D11PixelShader* m_pixelShader = nullptr;
 	ID3D11InputLayout* m_inputLayoutForVertex = nullptr;
+
+private:
+	// set when the renderer takes ownership, copies start unowned
+	bool m_isOwnedByRenderer = false;
 };
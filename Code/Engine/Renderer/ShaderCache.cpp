@@ -0,0 +1,124 @@
+#include <filesystem>
+
+#include "Engine/Renderer/ShaderCache.hpp"
+#include "Engine/Binary/BinaryUtil.hpp"
+#include "Engine/Core/FileUtil.hpp"
+
+constexpr unsigned int k_shaderCacheMagic = 0x48534345; // "ECSH"
+constexpr unsigned int k_shaderCacheVersion = 1;
+constexpr size_t k_shaderCacheHeaderSize = 4 + 4 + 8 + 4;
+
+static unsigned long long HashShaderCacheString( unsigned long long hash, char const* text )
+{
+	// FNV-1a, the terminator is hashed too so "ab"+"c" and "a"+"bc" differ
+	if (text)
+	{
+		for (; *text != '\0'; text++)
+		{
+			hash ^= (unsigned char)(*text);
+			hash *= 1099511628211ull;
+		}
+	}
+	hash ^= 0xff;
+	hash *= 1099511628211ull;
+	return hash;
+}
+
+unsigned long long ComputeShaderCacheKey( char const* source, char const* entryPoint, char const* target, char const* defines, unsigned int compileFlags )
+{
+	unsigned long long hash = 14695981039346656037ull;
+	hash = HashShaderCacheString( hash, source );
+	hash = HashShaderCacheString( hash, entryPoint );
+	hash = HashShaderCacheString( hash, target );
+	hash = HashShaderCacheString( hash, defines );
+	for (int i = 0; i < 4; i++)
+	{
+		hash ^= (compileFlags >> (i * 8)) & 0xff;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+void SerializeShaderCacheEntry( std::vector<unsigned char>& outBuffer, unsigned long long key, std::vector<unsigned char> const& byteCode )
+{
+	BufferWriter writer;
+	writer.SetEndianMode( Endianness::LITTLE );
+	writer.m_buffer.reserve( k_shaderCacheHeaderSize + byteCode.size() );
+	writer.AppendUInt( k_shaderCacheMagic );
+	writer.AppendUInt( k_shaderCacheVersion );
+	writer.AppendUInt64( key );
+	writer.AppendUInt( (unsigned int)byteCode.size() );
+	writer.m_buffer.insert( writer.m_buffer.end(), byteCode.begin(), byteCode.end() );
+	outBuffer.swap( writer.m_buffer );
+}
+
+bool DeserializeShaderCacheEntry( std::vector<unsigned char>& buffer, unsigned long long expectedKey, std::vector<unsigned char>& outByteCode )
+{
+	if (buffer.size() < k_shaderCacheHeaderSize)
+		return false;
+
+	BufferParser parser( buffer );
+	parser.SetEndianMode( Endianness::LITTLE );
+	if (parser.ParseUInt() != k_shaderCacheMagic || parser.ParseUInt() != k_shaderCacheVersion)
+		return false;
+	if (parser.ParseUInt64() != expectedKey)
+		return false;
+
+	size_t byteCodeSize = parser.ParseUInt();
+	if (byteCodeSize == 0 || buffer.size() != k_shaderCacheHeaderSize + byteCodeSize)
+		return false;
+
+	outByteCode.assign( buffer.begin() + k_shaderCacheHeaderSize, buffer.end() );
+	return true;
+}
+
+ShaderCache::ShaderCache( ShaderCacheConfig const& config )
+	: m_config( config )
+{
+}
+
+bool ShaderCache::Load( char const* shaderName, char const* entryPoint, char const* target, unsigned long long key, std::vector<unsigned char>& outByteCode ) const
+{
+	if (!IsEnabled())
+		return false;
+
+	std::vector<unsigned char> buffer;
+	if (!FileReadToBuffer( buffer, GetEntryPath( shaderName, entryPoint, target ) ))
+		return false;
+
+	return DeserializeShaderCacheEntry( buffer, key, outByteCode );
+}
+
+bool ShaderCache::Save( char const* shaderName, char const* entryPoint, char const* target, unsigned long long key, std::vector<unsigned char> const& byteCode ) const
+{
+	if (!IsEnabled() || byteCode.empty())
+		return false;
+
+	std::error_code error;
+	std::filesystem::create_directories( m_config.m_directory, error );
+	if (error)
+		return false;
+
+	std::vector<unsigned char> buffer;
+	SerializeShaderCacheEntry( buffer, key, byteCode );
+	return FileWriteToBuffer_S( buffer, GetEntryPath( shaderName, entryPoint, target ) );
+}
+
+std::string ShaderCache::GetEntryPath( char const* shaderName, char const* entryPoint, char const* target ) const
+{
+	// shader names are usually paths, flatten them into one file name
+	std::string fileName = shaderName;
+	for (char& character : fileName)
+	{
+		if (character == '/' || character == '\\' || character == ':' || character == '.')
+		{
+			character = '_';
+		}
+	}
+	std::string path = m_config.m_directory;
+	if (path.back() != '/' && path.back() != '\\')
+	{
+		path += '/';
+	}
+	return path + fileName + "." + entryPoint + "." + target + ".cso";
+}
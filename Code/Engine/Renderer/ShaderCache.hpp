@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct ShaderCacheConfig
+{
+	// empty disables the cache, every shader is compiled
+	std::string m_directory = "Data/ShaderCache/";
+};
+
+// Hash of everything that changes the compiled output, a changed source gives a new key
+unsigned long long ComputeShaderCacheKey( char const* source, char const* entryPoint, char const* target, char const* defines, unsigned int compileFlags );
+
+// Entry layout: magic, version, key, bytecode size, bytecode
+void SerializeShaderCacheEntry( std::vector<unsigned char>& outBuffer, unsigned long long key, std::vector<unsigned char> const& byteCode );
+// False when the buffer is not an entry or was written for a different key
+bool DeserializeShaderCacheEntry( std::vector<unsigned char>& buffer, unsigned long long expectedKey, std::vector<unsigned char>& outByteCode );
+
+// One file per shader, entry point and target, overwritten whenever its key goes stale
+class ShaderCache
+{
+public:
+	ShaderCache( ShaderCacheConfig const& config );
+	~ShaderCache() = default;
+
+	bool IsEnabled() const { return !m_config.m_directory.empty(); }
+	bool Load( char const* shaderName, char const* entryPoint, char const* target, unsigned long long key, std::vector<unsigned char>& outByteCode ) const;
+	bool Save( char const* shaderName, char const* entryPoint, char const* target, unsigned long long key, std::vector<unsigned char> const& byteCode ) const;
+
+	std::string GetEntryPath( char const* shaderName, char const* entryPoint, char const* target ) const;
+
+private:
+	ShaderCacheConfig m_config;
+};
@@ -1,11 +1,16 @@
+#if defined( _WIN32 )
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #include <d3d11.h>
 #include <d3dcompiler.h>
 #include <dxgi.h>
+#endif
 
 #include "Engine/Renderer/Texture.hpp"
 #include "Engine/Renderer/Renderer.hpp"
+#if defined( _WIN32 )
+#include "Engine/Renderer/D3D11RendererBackend.hpp"
+#endif
 
 Texture::Texture()
 {
@@ -13,7 +18,9 @@ Texture::Texture()
 
 Texture::~Texture()
 {
+#if defined( _WIN32 )
 	DX_SAFE_RELEASE( m_texture );
 	DX_SAFE_RELEASE( m_renderTargetView );
 	DX_SAFE_RELEASE( m_shaderResourceView );
+#endif
 }
@@ -11,6 +11,7 @@ struct ID3D11RenderTargetView;
 class Texture
 {
 	friend class Renderer; // Only the Renderer can create new Texture objects!
+	friend class D3D11RendererBackend;
 
 private:
 	Texture(); // can't instantiate directly; must ask Renderer to do it for you
@@ -20,10 +21,17 @@ private:
 public:
 	IntVec2				GetDimensions() const { return m_dimensions; }
 	std::string const& GetImageFilePath() const { return m_name; }
+	// false while the image is still streaming in or when it failed to decode, binding it binds the default texture
+	bool IsResident() const { return m_isResident; }
 
 protected:
 	std::string			m_name;
 	IntVec2				m_dimensions;
+	bool				m_isResident = true;
+	// true while its streaming job has not queued an image yet, only touched under the renderer's streaming mutex
+	bool				m_isStreaming = false;
+	// removed while still streaming, deleted along with its image when that arrives
+	bool				m_isPendingDelete = false;
 
 	ID3D11Texture2D* m_texture = nullptr;
 	ID3D11RenderTargetView* m_renderTargetView = nullptr;
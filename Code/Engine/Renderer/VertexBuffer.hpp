@@ -1,6 +1,8 @@
 #pragma once
 
-struct ID3D11Buffer;
+#include <cstddef>
+
+class RenderBuffer;
 
 class VertexBuffer
 {
@@ -11,8 +13,8 @@ public:
 	VertexBuffer( VertexBuffer const& copy ) = delete;
 	virtual ~VertexBuffer();
 
-	ID3D11Buffer* m_buffer = nullptr;
+	RenderBuffer* m_buffer = nullptr;
 	size_t m_size = 0;
-	UINT m_stride = 0;
+	unsigned int m_stride = 0;
 	bool m_isLinePrimitive = false;
 };
@@ -1,3 +1,5 @@
+#if defined( _WIN32 )
+
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #include <commdlg.h>
@@ -364,3 +366,5 @@ bool InputSystemKeyUp( unsigned int param )
  	Window::GetMainWindowInstance()->GetConfig().m_inputSystem->HandleKeyReleased( param );
 	return true;
 }
+
+#endif